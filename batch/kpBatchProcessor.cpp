@@ -0,0 +1,658 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_BATCH_PROCESSOR 0
+
+#include "batch/kpBatchProcessor.h"
+
+#include <QAtomicInt>
+#include <QColor>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QImageReader>
+#include <QList>
+#include <QMimeDatabase>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+#include <QThreadPool>
+
+#include "kpLogCategories.h"
+#include <KLocalizedString>
+
+#include "document/kpDocument.h"
+#include "document/kpDocumentSaveOptions.h"
+#include "imagelib/effects/kpEffectBalance.h"
+#include "imagelib/effects/kpEffectBlurSharpen.h"
+#include "imagelib/effects/kpEffectEmboss.h"
+#include "imagelib/effects/kpEffectFlatten.h"
+#include "imagelib/effects/kpEffectGrayscale.h"
+#include "imagelib/effects/kpEffectHSV.h"
+#include "imagelib/effects/kpEffectInvert.h"
+#include "imagelib/effects/kpEffectReduceColors.h"
+#include "imagelib/effects/kpEffectToneEnhance.h"
+#include "imagelib/kpColor.h"
+#include "imagelib/kpDocumentMetaInfo.h"
+#include "imagelib/transforms/kpTransformAutoCrop.h"
+#include "pixmapfx/kpPixmapFX.h"
+
+#include <cstdio>
+
+//---------------------------------------------------------------------
+
+struct kpBatchOperation {
+    enum Type {
+        AutoCrop,
+        Balance,
+        Blur,
+        Emboss,
+        Flatten,
+        Flip,
+        Grayscale,
+        HSV,
+        Invert,
+        ReduceColors,
+        Rotate,
+        Scale,
+        Sharpen,
+        Skew,
+        ToneEnhance
+    };
+
+    Type type{};
+
+    // Numeric arguments, in the order they appear on the command line.
+    double args[3]{};
+
+    // Scale: if both are > 0, the target size; else args[0] is a percentage.
+    int width{}, height{};
+
+    // Flip
+    bool horiz{}, vert{};
+
+    // Scale: smooth; ReduceColors: dither
+    bool option{};
+
+    // Flatten
+    QColor color1, color2;
+};
+
+struct kpBatchProcessorPrivate {
+    QList<kpBatchOperation> operations;
+
+    QString outputDirectory;
+    QString outputMimeType;
+    int quality{-1};
+    kpColor backgroundColor{kpColor::White};
+    int maxThreadCount{0};
+};
+
+//---------------------------------------------------------------------
+
+// Serializes lines written by the worker threads.
+static QMutex OutputMutex;
+
+static void PrintLine(FILE *stream, const QString &line)
+{
+    QMutexLocker lock(&OutputMutex);
+    fprintf(stream, "%s\n", qPrintable(line));
+    fflush(stream);
+}
+
+//---------------------------------------------------------------------
+
+kpBatchProcessor::kpBatchProcessor()
+    : d(new kpBatchProcessorPrivate())
+{
+}
+
+//---------------------------------------------------------------------
+
+kpBatchProcessor::~kpBatchProcessor()
+{
+    delete d;
+}
+
+//---------------------------------------------------------------------
+
+// Parses <arg> as a number between <min> and <max> inclusive.
+static bool ParseNumber(const QString &arg, double min, double max, double *number)
+{
+    bool ok = false;
+    *number = arg.toDouble(&ok);
+    return ok && *number >= min && *number <= max;
+}
+
+//---------------------------------------------------------------------
+
+// Parses the <args> of <op>, which already has its type set.
+static bool ParseArguments(kpBatchOperation *op, const QString &name, const QStringList &args, QString *errorMessage)
+{
+    // (sync: pipelineHelp())
+    struct NumberRange {
+        double min, max;
+    };
+    auto parseNumbers = [&](int minCount, const QList<NumberRange> &ranges) {
+        if (args.count() < minCount || args.count() > ranges.count()) {
+            *errorMessage = i18n("Wrong number of arguments for operation \"%1\".", name);
+            return false;
+        }
+
+        for (int i = 0; i < args.count(); i++) {
+            if (!::ParseNumber(args[i], ranges[i].min, ranges[i].max, &op->args[i])) {
+                *errorMessage = i18n("Argument \"%1\" of operation \"%2\" must be a number from %3 to %4.", args[i], name, ranges[i].min, ranges[i].max);
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    switch (op->type) {
+    case kpBatchOperation::AutoCrop:
+        // Color similarity in percent
+        return parseNumbers(0, {{0, 100}});
+
+    case kpBatchOperation::Balance:
+        op->args[0] = op->args[1] = op->args[2] = 0;
+        return parseNumbers(1, {{-50, 50}, {-50, 50}, {-50, 50}});
+
+    case kpBatchOperation::Blur:
+    case kpBatchOperation::Sharpen:
+        op->args[0] = kpEffectBlurSharpen::MaxStrength / 2;
+        return parseNumbers(0, {{kpEffectBlurSharpen::MinStrength, kpEffectBlurSharpen::MaxStrength}});
+
+    case kpBatchOperation::Emboss:
+        op->args[0] = kpEffectEmboss::MaxStrength;
+        return parseNumbers(0, {{kpEffectEmboss::MinStrength, kpEffectEmboss::MaxStrength}});
+
+    case kpBatchOperation::Flatten:
+        if (args.count() != 2) {
+            *errorMessage = i18n("Operation \"%1\" takes 2 colors e.g. \"#000000\" or \"white\".", name);
+            return false;
+        }
+
+        op->color1 = QColor::fromString(args[0]);
+        op->color2 = QColor::fromString(args[1]);
+        if (!op->color1.isValid() || !op->color2.isValid()) {
+            *errorMessage = i18n("Operation \"%1\" takes 2 colors e.g. \"#000000\" or \"white\".", name);
+            return false;
+        }
+        return true;
+
+    case kpBatchOperation::Flip:
+        if (args.count() != 1 || args[0].isEmpty()) {
+            *errorMessage = i18n("Operation \"%1\" takes \"h\", \"v\" or \"hv\".", name);
+            return false;
+        }
+
+        for (const QChar c : args[0]) {
+            if (c == QLatin1Char('h')) {
+                op->horiz = true;
+            } else if (c == QLatin1Char('v')) {
+                op->vert = true;
+            } else {
+                *errorMessage = i18n("Operation \"%1\" takes \"h\", \"v\" or \"hv\".", name);
+                return false;
+            }
+        }
+        return true;
+
+    case kpBatchOperation::Grayscale:
+    case kpBatchOperation::Invert:
+        return parseNumbers(0, {});
+
+    case kpBatchOperation::HSV:
+        op->args[0] = op->args[1] = op->args[2] = 0;
+        return parseNumbers(1, {{-180, 180}, {-1, 1}, {-1, 1}});
+
+    case kpBatchOperation::ReduceColors:
+        if (args.isEmpty() || args.count() > 2 || (args[0] != QLatin1String("1") && args[0] != QLatin1String("8"))
+            || (args.count() == 2 && args[1] != QLatin1String("dither"))) {
+            *errorMessage = i18n("Operation \"%1\" takes a depth of 1 or 8, optionally followed by \"dither\".", name);
+            return false;
+        }
+
+        op->args[0] = args[0].toInt();
+        op->option = (args.count() == 2);
+        return true;
+
+    case kpBatchOperation::Rotate:
+        return parseNumbers(1, {{-360, 360}});
+
+    case kpBatchOperation::Scale: {
+        if (args.isEmpty() || args.count() > 2 || (args.count() == 2 && args[1] != QLatin1String("smooth"))) {
+            *errorMessage = i18n("Operation \"%1\" takes a size (e.g. \"640x480\" or \"50%\"), optionally followed by \"smooth\".", name);
+            return false;
+        }
+
+        op->option = (args.count() == 2);
+
+        if (args[0].endsWith(QLatin1Char('%'))) {
+            if (!::ParseNumber(args[0].chopped(1), 0.01, 10000, &op->args[0])) {
+                *errorMessage = i18n("Argument \"%1\" of operation \"%2\" is not a valid percentage.", args[0], name);
+                return false;
+            }
+            return true;
+        }
+
+        const QStringList dimensions = args[0].split(QLatin1Char('x'));
+        bool widthOK = false, heightOK = false;
+        if (dimensions.count() == 2) {
+            op->width = dimensions[0].toInt(&widthOK);
+            op->height = dimensions[1].toInt(&heightOK);
+        }
+        if (!widthOK || !heightOK || op->width <= 0 || op->height <= 0) {
+            *errorMessage = i18n("Argument \"%1\" of operation \"%2\" is not a valid size.", args[0], name);
+            return false;
+        }
+        return true;
+    }
+
+    case kpBatchOperation::Skew:
+        op->args[1] = 0;
+        return parseNumbers(1, {{-89, 89}, {-89, 89}});
+
+    case kpBatchOperation::ToneEnhance:
+        op->args[0] = op->args[1] = 0.5;
+        return parseNumbers(0, {{0, 1}, {0, 1}});
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpBatchProcessor::setPipeline(const QString &pipeline, QString *errorMessage)
+{
+    // (sync: pipelineHelp())
+    static const struct {
+        const char *name;
+        kpBatchOperation::Type type;
+    } names[] = {{"autocrop", kpBatchOperation::AutoCrop},
+                 {"balance", kpBatchOperation::Balance},
+                 {"blur", kpBatchOperation::Blur},
+                 {"emboss", kpBatchOperation::Emboss},
+                 {"flatten", kpBatchOperation::Flatten},
+                 {"flip", kpBatchOperation::Flip},
+                 {"grayscale", kpBatchOperation::Grayscale},
+                 {"hsv", kpBatchOperation::HSV},
+                 {"invert", kpBatchOperation::Invert},
+                 {"reduce-colors", kpBatchOperation::ReduceColors},
+                 {"rotate", kpBatchOperation::Rotate},
+                 {"scale", kpBatchOperation::Scale},
+                 {"sharpen", kpBatchOperation::Sharpen},
+                 {"skew", kpBatchOperation::Skew},
+                 {"tone-enhance", kpBatchOperation::ToneEnhance}};
+
+    d->operations.clear();
+
+    const QStringList steps = pipeline.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &step : steps) {
+        QStringList args = step.trimmed().split(QLatin1Char(':'));
+        const QString name = args.takeFirst().toLower();
+
+        kpBatchOperation op;
+        bool known = false;
+        for (const auto &n : names) {
+            if (name == QLatin1String(n.name)) {
+                op.type = n.type;
+                known = true;
+                break;
+            }
+        }
+
+        if (!known) {
+            *errorMessage = i18n("Unknown operation \"%1\".", name);
+            return false;
+        }
+
+        if (!::ParseArguments(&op, name, args, errorMessage)) {
+            return false;
+        }
+
+        d->operations.append(op);
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpBatchProcessor::setOutputDirectory(const QString &dir)
+{
+    d->outputDirectory = dir;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpBatchProcessor::setOutputFormat(const QString &format)
+{
+    if (format.isEmpty()) {
+        d->outputMimeType.clear();
+        return true;
+    }
+
+    QMimeDatabase db;
+    QMimeType mimeType = db.mimeTypeForName(format);
+    if (!mimeType.isValid()) {
+        mimeType = db.mimeTypeForFile(QLatin1String("image.") + format, QMimeDatabase::MatchExtension);
+    }
+
+    if (!mimeType.isValid() || mimeType.isDefault() || mimeType.preferredSuffix().isEmpty()) {
+        return false;
+    }
+
+    d->outputMimeType = mimeType.name();
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpBatchProcessor::setQuality(int quality)
+{
+    d->quality = quality;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpBatchProcessor::setBackgroundColor(const kpColor &color)
+{
+    d->backgroundColor = color;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpBatchProcessor::setMaxThreadCount(int count)
+{
+    d->maxThreadCount = count;
+}
+
+//---------------------------------------------------------------------
+
+static void ApplyOperation(kpImage *image, const kpBatchOperation &op, const kpColor &backgroundColor)
+{
+    switch (op.type) {
+    case kpBatchOperation::AutoCrop:
+        // (not finding a border is not an error)
+        kpTransformAutoCropImage(image, kpColor::processSimilarity(op.args[0] / 100.0));
+        break;
+
+    case kpBatchOperation::Balance:
+        *image = kpEffectBalance::applyEffect(*image, kpEffectBalance::RGB, qRound(op.args[0]), qRound(op.args[1]), qRound(op.args[2]));
+        break;
+
+    case kpBatchOperation::Blur:
+        *image = kpEffectBlurSharpen::applyEffect(*image, kpEffectBlurSharpen::Blur, qRound(op.args[0]));
+        break;
+
+    case kpBatchOperation::Emboss:
+        *image = kpEffectEmboss::applyEffect(*image, qRound(op.args[0]));
+        break;
+
+    case kpBatchOperation::Flatten:
+        kpEffectFlatten::applyEffect(image, op.color1, op.color2);
+        break;
+
+    case kpBatchOperation::Flip:
+#if QT_VERSION >= QT_VERSION_CHECK(6, 9, 0)
+    {
+        Qt::Orientations orientation;
+        if (op.horiz)
+            orientation |= Qt::Horizontal;
+        if (op.vert)
+            orientation |= Qt::Vertical;
+        image->flip(orientation);
+    }
+#else
+        image->mirror(op.horiz, op.vert);
+#endif
+        break;
+
+    case kpBatchOperation::Grayscale:
+        *image = kpEffectGrayscale::applyEffect(*image);
+        break;
+
+    case kpBatchOperation::HSV:
+        *image = kpEffectHSV::applyEffect(*image, op.args[0], op.args[1], op.args[2]);
+        break;
+
+    case kpBatchOperation::Invert:
+        kpEffectInvert::applyEffect(image);
+        break;
+
+    case kpBatchOperation::ReduceColors:
+        kpEffectReduceColors::applyEffect(image, qRound(op.args[0]), op.option);
+        break;
+
+    case kpBatchOperation::Rotate:
+        kpPixmapFX::rotate(image, op.args[0], backgroundColor);
+        break;
+
+    case kpBatchOperation::Scale:
+        if (op.width > 0 && op.height > 0) {
+            kpPixmapFX::scale(image, op.width, op.height, op.option);
+        } else {
+            kpPixmapFX::scale(image,
+                              qMax(1, qRound(image->width() * op.args[0] / 100.0)),
+                              qMax(1, qRound(image->height() * op.args[0] / 100.0)),
+                              op.option);
+        }
+        break;
+
+    case kpBatchOperation::Sharpen:
+        *image = kpEffectBlurSharpen::applyEffect(*image, kpEffectBlurSharpen::Sharpen, qRound(op.args[0]));
+        break;
+
+    case kpBatchOperation::Skew:
+        kpPixmapFX::skew(image, op.args[0], op.args[1], backgroundColor);
+        break;
+
+    case kpBatchOperation::ToneEnhance:
+        *image = kpEffectToneEnhance::applyEffect(*image, op.args[0], op.args[1]);
+        break;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Returns <path> with symlinks, "." and ".." resolved, so that paths can be
+// compared.  <path> need not exist.
+static QString CanonicalPath(const QString &path)
+{
+    const QFileInfo info(path);
+    const QString canonical = info.canonicalFilePath();
+    return canonical.isEmpty() ? QDir::cleanPath(info.absoluteFilePath()) : canonical;
+}
+
+//---------------------------------------------------------------------
+
+// Returns the MIME type that the result for <inputPath> is saved in.
+static QString OutputMimeType(const QString &inputPath, const kpBatchProcessorPrivate *d)
+{
+    return d->outputMimeType.isEmpty() ? QMimeDatabase().mimeTypeForFile(inputPath).name() : d->outputMimeType;
+}
+
+//---------------------------------------------------------------------
+
+// Returns where the result for <inputPath> is written, in <mimeType>.
+// On error, returns an empty string and sets <*errorMessage>.
+static QString OutputPath(const QString &inputPath, const QString &mimeType, const kpBatchProcessorPrivate *d, QString *errorMessage)
+{
+    const QString suffix = QMimeDatabase().mimeTypeForName(mimeType).preferredSuffix();
+    if (suffix.isEmpty()) {
+        *errorMessage = i18n("Unknown output format.");
+        return {};
+    }
+
+    return ::CanonicalPath(QDir(d->outputDirectory).filePath(QFileInfo(inputPath).completeBaseName() + QLatin1Char('.') + suffix));
+}
+
+//---------------------------------------------------------------------
+
+// Reads <inputPath>, runs the pipeline over it and writes the result to
+// <outputPath> in <outputMimeType>.
+// Runs on a worker thread so must not touch any widgets.
+static bool
+ProcessFile(const QString &inputPath, const QString &outputPath, const QString &outputMimeType, const kpBatchProcessorPrivate *d, QString *errorMessage)
+{
+    // (sync: kpDocument::getPixmapFromFile(), which we can't use since
+    //        it pops up message boxes and runs KIO jobs)
+    QImageReader reader(inputPath);
+    reader.setAutoTransform(true);
+    reader.setDecideFormatFromContent(true);
+
+    QImage image;
+    if (!reader.read(&image) || image.isNull()) {
+        *errorMessage = reader.errorString();
+        return false;
+    }
+
+    QMimeDatabase db;
+
+    kpDocumentSaveOptions saveOptions;
+    kpDocumentMetaInfo metaInfo;
+    saveOptions.setMimeType(db.mimeTypeForFile(inputPath).name());
+    kpDocument::getDataFromImage(image, saveOptions, metaInfo);
+
+    // (sync: kpDocument::getPixmapFromFile())
+    if (image.format() != QImage::Format_ARGB32_Premultiplied) {
+        image.convertTo(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    for (const kpBatchOperation &op : d->operations) {
+        ::ApplyOperation(&image, op, d->backgroundColor);
+    }
+
+    saveOptions.setMimeType(outputMimeType);
+    if (d->quality >= 0) {
+        saveOptions.setQuality(d->quality);
+    }
+
+    // sync: All failure exit paths _must_ call QSaveFile::cancelWriting()
+    //       (see kpDocument::savePixmapToFile()).
+    QSaveFile atomicFileWriter(outputPath);
+    if (!atomicFileWriter.open(QIODevice::WriteOnly)) {
+        atomicFileWriter.cancelWriting();
+        *errorMessage = atomicFileWriter.errorString();
+        return false;
+    }
+
+    if (!kpDocument::savePixmapToDevice(image, &atomicFileWriter, saveOptions, metaInfo, false /*no lossy prompt*/, nullptr /*no dialog parent*/)) {
+        atomicFileWriter.cancelWriting();
+        *errorMessage = i18n("Error saving image");
+        return false;
+    }
+
+    if (!atomicFileWriter.commit()) {
+        *errorMessage = atomicFileWriter.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// public
+int kpBatchProcessor::process(const QStringList &files)
+{
+#if DEBUG_KP_BATCH_PROCESSOR
+    qCDebug(kpLogMisc) << "kpBatchProcessor::process() files=" << files.count() << "ops=" << d->operations.count() << "outputDir=" << d->outputDirectory
+                       << "outputMimeType=" << d->outputMimeType;
+#endif
+
+    QThreadPool pool;
+    if (d->maxThreadCount > 0) {
+        pool.setMaxThreadCount(d->maxThreadCount);
+    }
+
+    QAtomicInt numFailures = 0;
+
+    // Work out every output path before writing anything.  Otherwise, 2
+    // inputs with the same base name (e.g. "a.png" and "a.jpg", or from
+    // different directories) would be written to the same file at the same
+    // time, and an input in the output directory could be replaced by the
+    // result of another input (or of itself).
+    QSet<QString> inputPaths;
+    for (const QString &file : files) {
+        inputPaths.insert(::CanonicalPath(file));
+    }
+
+    // output path -> the input file whose result is written there
+    QHash<QString, QString> outputPaths;
+
+    for (const QString &file : files) {
+        const QString outputMimeType = ::OutputMimeType(file, d);
+
+        QString errorMessage;
+        const QString outputPath = ::OutputPath(file, outputMimeType, d, &errorMessage);
+        if (outputPath.isEmpty()) {
+            // (errorMessage set by OutputPath())
+        } else if (inputPaths.contains(outputPath)) {
+            errorMessage = i18n("The result would overwrite the input file \"%1\".", outputPath);
+        } else if (outputPaths.contains(outputPath)) {
+            errorMessage = i18n("The result would overwrite the result of \"%1\".", outputPaths.value(outputPath));
+        }
+
+        if (!errorMessage.isEmpty()) {
+            ::PrintLine(stderr, i18n("Could not process \"%1\": %2", file, errorMessage));
+            numFailures.fetchAndAddRelaxed(1);
+            continue;
+        }
+
+        outputPaths.insert(outputPath, file);
+
+        pool.start([this, file, outputPath, outputMimeType, &numFailures]() {
+            QString errorMessage;
+            if (::ProcessFile(file, outputPath, outputMimeType, d, &errorMessage)) {
+                ::PrintLine(stdout, i18n("%1 -> %2", file, outputPath));
+            } else {
+                ::PrintLine(stderr, i18n("Could not process \"%1\": %2", file, errorMessage));
+                numFailures.fetchAndAddRelaxed(1);
+            }
+        });
+    }
+
+    pool.waitForDone();
+
+    return numFailures.loadRelaxed();
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QString kpBatchProcessor::pipelineHelp()
+{
+    // (sync: setPipeline())
+    return i18n(
+        "Comma-separated operations, each optionally followed by colon-separated arguments:\n"
+        "  autocrop[:similarity%]\n"
+        "  balance:brightness[:contrast[:gamma]]    (-50 to 50)\n"
+        "  blur[:strength], sharpen[:strength]      (0 to 10)\n"
+        "  emboss[:strength]                        (0 to 10)\n"
+        "  flatten:color1:color2\n"
+        "  flip:h|v|hv\n"
+        "  grayscale\n"
+        "  hsv:hue[:saturation[:value]]             (-180 to 180, -1 to 1, -1 to 1)\n"
+        "  invert\n"
+        "  reduce-colors:1|8[:dither]\n"
+        "  rotate:angle                             (clockwise degrees)\n"
+        "  scale:WIDTHxHEIGHT|PERCENT%[:smooth]\n"
+        "  skew:hangle[:vangle]                     (-89 to 89)\n"
+        "  tone-enhance[:granularity[:amount]]      (0 to 1)");
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,79 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef KP_BATCH_PROCESSOR_H
+#define KP_BATCH_PROCESSOR_H
+
+#include <QString>
+#include <QStringList>
+
+class kpColor;
+
+//
+// Headless batch processing.
+//
+// Runs a pipeline of KolourPaint's effects and transforms over a list of
+// image files, without creating a kpMainWindow or kpDocument.  Files are
+// processed in parallel, one file per thread, using the same imagelib and
+// kpPixmapFX code as the interactive commands.  Results are written out
+// through kpDocument::savePixmapToDevice().
+//
+// A pipeline is a comma-separated list of operations, each of which is
+// a name optionally followed by colon-separated arguments e.g.
+//
+//     "autocrop,rotate:90,scale:50%:smooth,reduce-colors:8:dither"
+//
+// See pipelineHelp() for the list of operations.
+//
+class kpBatchProcessor
+{
+public:
+    kpBatchProcessor();
+    ~kpBatchProcessor();
+
+    kpBatchProcessor(const kpBatchProcessor &) = delete;
+    kpBatchProcessor &operator=(const kpBatchProcessor &) = delete;
+
+    // Parses <pipeline>.  On error, returns false and sets <*errorMessage>
+    // to a user-visible explanation.
+    bool setPipeline(const QString &pipeline, QString *errorMessage);
+
+    // Directory to write results to (must exist).  Output files have the
+    // same base name as their input files.  Files whose result would
+    // overwrite an input file, or the result of an earlier file, fail.
+    void setOutputDirectory(const QString &dir);
+
+    // Output format as a file name suffix (e.g. "png") or a MIME type
+    // (e.g. "image/png").  If empty, each file is saved in the format it
+    // was read in.
+    //
+    // (returns false if <format> is not known)
+    bool setOutputFormat(const QString &format);
+
+    // 0 to 100, or -1 for the writer's default.
+    void setQuality(int quality);
+
+    // Color used to fill new areas created by rotate and skew.
+    // Defaults to kpColor::White.
+    void setBackgroundColor(const kpColor &color);
+
+    // <= 0 means one thread per core.
+    void setMaxThreadCount(int count);
+
+    // Processes all <files> and blocks until done.  Per-file progress and
+    // errors are printed to stdout and stderr respectively.
+    //
+    // Returns the number of files that failed.
+    int process(const QStringList &files);
+
+    // Returns a user-visible description of the pipeline syntax.
+    static QString pipelineHelp();
+
+private:
+    struct kpBatchProcessorPrivate *d;
+};
+
+#endif // KP_BATCH_PROCESSOR_H
@@ -0,0 +1,553 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+//
+// Micro-benchmarks for the imagelib and pixmapfx hot paths.
+//
+// Every benchmark runs over synthetic images from 1 to 100 megapixels and,
+// in addition to QBENCHMARK's own output, prints its throughput in
+// megapixels per second so that results can be compared across releases.
+//
+// Set KOLOURPAINT_BENCH_MAX_MEGAPIXELS to skip the bigger images e.g.
+//
+//     KOLOURPAINT_BENCH_MAX_MEGAPIXELS=10 kolourpaint_bench
+//
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "document/kpDocument.h"
+#include "imagelib/effects/kpEffectBalance.h"
+#include "imagelib/effects/kpEffectBlurSharpen.h"
+#include "imagelib/effects/kpEffectEmboss.h"
+#include "imagelib/effects/kpEffectFlatten.h"
+#include "imagelib/effects/kpEffectGrayscale.h"
+#include "imagelib/effects/kpEffectHSV.h"
+#include "imagelib/effects/kpEffectInvert.h"
+#include "imagelib/effects/kpEffectReduceColors.h"
+#include "imagelib/effects/kpEffectToneEnhance.h"
+#include "imagelib/kpColor.h"
+#include "imagelib/kpFloodFill.h"
+#include "imagelib/kpFloodFillIndex.h"
+#include "imagelib/kpPainter.h"
+#include "imagelib/transforms/kpTransformAutoCrop.h"
+#include "layers/selections/image/kpImageSelectionTransparency.h"
+#include "layers/selections/image/kpRectangularImageSelection.h"
+#include "mainWindow/kpMainWindow.h"
+#include "pixmapfx/kpPixmapFX.h"
+#include "views/kpZoomedView.h"
+
+//---------------------------------------------------------------------
+
+// Prints the megapixels per second achieved by the enclosing QBENCHMARK.
+//
+// Only the QBENCHMARK body is timed (see Iteration), not QBENCHMARK's own
+// setup and bookkeeping, nor anything else in the benchmark function.
+class kpThroughput
+{
+public:
+    explicit kpThroughput(qint64 pixelsPerIteration)
+        : m_pixelsPerIteration(pixelsPerIteration)
+    {
+    }
+
+    ~kpThroughput()
+    {
+        if (m_iterations == 0 || m_nsecs <= 0) {
+            return;
+        }
+
+        const double megapixels = double(m_pixelsPerIteration) * m_iterations / 1e6;
+        qInfo("%s(%s): %.1f MP/s", QTest::currentTestFunction(), QTest::currentDataTag(), megapixels / (m_nsecs / 1e9));
+    }
+
+    // Declare one at the start of the QBENCHMARK body to time it.
+    class Iteration
+    {
+    public:
+        explicit Iteration(kpThroughput *throughput)
+            : m_throughput(throughput)
+        {
+            m_timer.start();
+        }
+
+        ~Iteration()
+        {
+            m_throughput->m_nsecs += m_timer.nsecsElapsed();
+            m_throughput->m_iterations++;
+        }
+
+    private:
+        kpThroughput *m_throughput;
+        QElapsedTimer m_timer;
+    };
+
+private:
+    qint64 m_pixelsPerIteration;
+    qint64 m_nsecs{0};
+    int m_iterations{0};
+};
+
+//---------------------------------------------------------------------
+
+// Returns an opaque image with gradients, noise and a grid of black
+// lines so that fills, autocrop and color reduction have realistic work.
+static QImage SyntheticImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+
+    QRandomGenerator random(1); // (deterministic)
+    for (int y = 0; y < image.height(); y++) {
+        auto *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); x++) {
+            const int noise = random.bounded(16);
+            line[x] = qRgb((x * 255 / image.width() + noise) & 0xFF, (y * 255 / image.height() + noise) & 0xFF, (x + y + noise) & 0xFF);
+        }
+    }
+
+    QPainter painter(&image);
+    painter.setPen(Qt::black);
+    for (int x = 0; x < image.width(); x += 97) {
+        painter.drawLine(x, 0, x, image.height() - 1);
+    }
+    for (int y = 0; y < image.height(); y += 89) {
+        painter.drawLine(0, y, image.width() - 1, y);
+    }
+    painter.end();
+
+    return image;
+}
+
+//---------------------------------------------------------------------
+
+// Returns a white image with a black grid and a solid border, for flood
+// fill and autocrop.
+static QImage LineArtImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.setPen(Qt::black);
+    for (int x = 64; x < image.width(); x += 256) {
+        painter.drawLine(x, 64, x, image.height() - 65);
+    }
+    for (int y = 64; y < image.height(); y += 256) {
+        painter.drawLine(64, y, image.width() - 65, y);
+    }
+    painter.end();
+
+    return image;
+}
+
+//---------------------------------------------------------------------
+
+class kpBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    static void addSizes();
+    static void addSizes(const QStringList &names);
+
+private Q_SLOTS:
+    void floodFill_data();
+    void floodFill();
+
+    void floodFillIndexed_data();
+    void floodFillIndexed();
+
+    void washLine_data();
+    void washLine();
+
+    void washRect_data();
+    void washRect();
+
+    void interpolatePoints_data();
+    void interpolatePoints();
+
+    void effect_data();
+    void effect();
+
+    void rotate_data();
+    void rotate();
+
+    void skew_data();
+    void skew();
+
+    void scale_data();
+    void scale();
+
+    void autoCrop_data();
+    void autoCrop();
+
+    void transparencyMask_data();
+    void transparencyMask();
+
+    void viewRepaint_data();
+    void viewRepaint();
+};
+
+//---------------------------------------------------------------------
+
+// private static
+void kpBenchmark::addSizes(const QStringList &names)
+{
+    static const struct {
+        const char *tag;
+        int width, height;
+    } sizes[] = {{"1MP", 1000, 1000}, {"10MP", 4000, 2500}, {"100MP", 10000, 10000}};
+
+    const double maxMegapixels = qEnvironmentVariableIsSet("KOLOURPAINT_BENCH_MAX_MEGAPIXELS")
+        ? QString::fromLocal8Bit(qgetenv("KOLOURPAINT_BENCH_MAX_MEGAPIXELS")).toDouble()
+        : 100;
+
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QSize>("size");
+
+    for (const QString &name : names) {
+        for (const auto &s : sizes) {
+            if (double(s.width) * s.height / 1e6 > maxMegapixels) {
+                continue;
+            }
+
+            const QString tag = name.isEmpty() ? QLatin1String(s.tag) : name + QLatin1Char(' ') + QLatin1String(s.tag);
+            QTest::newRow(qPrintable(tag)) << name << QSize(s.width, s.height);
+        }
+    }
+}
+
+// private static
+void kpBenchmark::addSizes()
+{
+    addSizes(QStringList{QString()});
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::floodFill_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::floodFill()
+{
+    QFETCH(QSize, size);
+    QImage image = ::LineArtImage(size);
+
+    // Alternate colors so that every iteration fills the same region.
+    bool red = true;
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        kpFloodFill fill(&image, 0, 0, red ? kpColor::Red : kpColor::Blue, kpColor::Exact);
+        fill.fill();
+        red = !red;
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::floodFillIndexed_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::floodFillIndexed()
+{
+    QFETCH(QSize, size);
+    QImage image = ::LineArtImage(size);
+
+    // Repeated fills of the same region, keeping the index up to date like
+    // kpDocument does.  After the first 2 iterations, each fill only has to
+    // rescan the rows it changed.
+    kpFloodFillIndex index;
+    bool red = true;
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        kpFloodFill fill(&image, 0, 0, red ? kpColor::Red : kpColor::Blue, kpColor::Exact);
+        fill.setIndex(&index);
+        fill.fill();
+        index.imageChanged(image, fill.boundingRect());
+        red = !red;
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::washLine_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::washLine()
+{
+    QFETCH(QSize, size);
+    QImage image = ::SyntheticImage(size);
+
+    const int penSize = 16;
+    kpThroughput throughput(qint64(qMax(size.width(), size.height())) * penSize);
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        kpPainter::washLine(&image, 0, 0, size.width() - 1, size.height() - 1, kpColor::White, penSize, penSize, kpColor::Black, kpColor::processSimilarity(0.3));
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::washRect_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::washRect()
+{
+    QFETCH(QSize, size);
+    QImage image = ::SyntheticImage(size);
+
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        kpPainter::washRect(&image, 0, 0, size.width(), size.height(), kpColor::White, kpColor::Black, kpColor::processSimilarity(0.3));
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::interpolatePoints_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::interpolatePoints()
+{
+    QFETCH(QSize, size);
+
+    // The "pixels" here are the points along the diagonal.
+    kpThroughput throughput(qMax(size.width(), size.height()));
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        const QList<QPoint> points = kpPainter::interpolatePoints(QPoint(0, 0), QPoint(size.width() - 1, size.height() - 1), true /*cardinal adjacency*/);
+        Q_UNUSED(points);
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::effect_data()
+{
+    addSizes({QStringLiteral("balance"),
+              QStringLiteral("blur"),
+              QStringLiteral("sharpen"),
+              QStringLiteral("emboss"),
+              QStringLiteral("flatten"),
+              QStringLiteral("grayscale"),
+              QStringLiteral("hsv"),
+              QStringLiteral("invert"),
+              QStringLiteral("reduce-colors-1"),
+              QStringLiteral("reduce-colors-8"),
+              QStringLiteral("tone-enhance")});
+}
+
+void kpBenchmark::effect()
+{
+    QFETCH(QString, name);
+    QFETCH(QSize, size);
+    const QImage image = ::SyntheticImage(size);
+
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        QImage result;
+        if (name == QLatin1String("balance")) {
+            result = kpEffectBalance::applyEffect(image, kpEffectBalance::RGB, 20, 20, 20);
+        } else if (name == QLatin1String("blur")) {
+            result = kpEffectBlurSharpen::applyEffect(image, kpEffectBlurSharpen::Blur, 5);
+        } else if (name == QLatin1String("sharpen")) {
+            result = kpEffectBlurSharpen::applyEffect(image, kpEffectBlurSharpen::Sharpen, 5);
+        } else if (name == QLatin1String("emboss")) {
+            result = kpEffectEmboss::applyEffect(image, kpEffectEmboss::MaxStrength);
+        } else if (name == QLatin1String("flatten")) {
+            result = kpEffectFlatten::applyEffect(image, Qt::darkBlue, Qt::yellow);
+        } else if (name == QLatin1String("grayscale")) {
+            result = kpEffectGrayscale::applyEffect(image);
+        } else if (name == QLatin1String("hsv")) {
+            result = kpEffectHSV::applyEffect(image, 45, 0.2, 0.2);
+        } else if (name == QLatin1String("invert")) {
+            result = kpEffectInvert::applyEffect(image);
+        } else if (name == QLatin1String("reduce-colors-1")) {
+            result = kpEffectReduceColors::applyEffect(image, 1, true /*dither*/);
+        } else if (name == QLatin1String("reduce-colors-8")) {
+            result = kpEffectReduceColors::applyEffect(image, 8, true /*dither*/);
+        } else if (name == QLatin1String("tone-enhance")) {
+            result = kpEffectToneEnhance::applyEffect(image, 0.5, 0.5);
+        }
+        Q_ASSERT(!result.isNull());
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::rotate_data()
+{
+    addSizes({QStringLiteral("90"), QStringLiteral("180"), QStringLiteral("270"), QStringLiteral("30"), QStringLiteral("30-smooth")});
+}
+
+void kpBenchmark::rotate()
+{
+    QFETCH(QString, name);
+    QFETCH(QSize, size);
+    const QImage image = ::SyntheticImage(size);
+    const double angle = name.section(QLatin1Char('-'), 0, 0).toDouble();
+    const bool smooth = name.endsWith(QLatin1String("-smooth"));
+
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        const QImage result = kpPixmapFX::rotate(image, angle, kpColor::White, -1, -1, smooth);
+        Q_UNUSED(result);
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::skew_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::skew()
+{
+    QFETCH(QSize, size);
+    const QImage image = ::SyntheticImage(size);
+
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        const QImage result = kpPixmapFX::skew(image, 20, 10, kpColor::White);
+        Q_UNUSED(result);
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::scale_data()
+{
+    addSizes({QStringLiteral("half"), QStringLiteral("half-smooth"), QStringLiteral("double"), QStringLiteral("double-smooth")});
+}
+
+void kpBenchmark::scale()
+{
+    QFETCH(QString, name);
+    QFETCH(QSize, size);
+    const QImage image = ::SyntheticImage(size);
+
+    const bool smooth = name.endsWith(QLatin1String("-smooth"));
+    const QSize newSize = name.startsWith(QLatin1String("half")) ? size / 2 : size * 2;
+
+    // (measured in source pixels)
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        const QImage result = kpPixmapFX::scale(image, newSize.width(), newSize.height(), smooth);
+        Q_UNUSED(result);
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::autoCrop_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::autoCrop()
+{
+    QFETCH(QSize, size);
+    const QImage image = ::LineArtImage(size);
+
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        QImage result = image;
+        const bool cropped = kpTransformAutoCropImage(&result, kpColor::Exact);
+        Q_UNUSED(cropped);
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::transparencyMask_data()
+{
+    addSizes();
+}
+
+void kpBenchmark::transparencyMask()
+{
+    QFETCH(QSize, size);
+    const QImage image = ::SyntheticImage(size);
+
+    kpRectangularImageSelection sel(QRect(QPoint(0, 0), size), kpImageSelectionTransparency(kpColor::Black, 0.3));
+
+    kpThroughput throughput(qint64(size.width()) * size.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        // (rebuilds the transparency mask)
+        sel.setBaseImage(image);
+    }
+}
+
+//---------------------------------------------------------------------
+
+void kpBenchmark::viewRepaint_data()
+{
+    addSizes({QStringLiteral("100%"), QStringLiteral("400%")});
+}
+
+void kpBenchmark::viewRepaint()
+{
+    QFETCH(QString, name);
+    QFETCH(QSize, size);
+
+    auto *doc = new kpDocument(size.width(), size.height(), nullptr);
+    doc->setImage(::SyntheticImage(size));
+
+    // (takes ownership of <doc>)
+    auto *mainWindow = new kpMainWindow(doc);
+
+    // Lay out the views as a maximized window on a Full HD screen would.
+    mainWindow->resize(1920, 1080);
+    mainWindow->show();
+    QVERIFY(QTest::qWaitForWindowExposed(mainWindow));
+
+    auto *view = mainWindow->findChild<kpZoomedView *>(QStringLiteral("mainView"));
+    QVERIFY(view);
+
+    const int zoom = name.chopped(1).toInt();
+    view->setZoomLevel(zoom, zoom);
+
+    // Repaint one Full HD screenful.
+    const QRect screenRect = QRect(0, 0, 1920, 1080) & view->rect();
+
+    kpThroughput throughput(qint64(screenRect.width()) * screenRect.height());
+    QBENCHMARK {
+        const kpThroughput::Iteration iteration(&throughput);
+        const QPixmap pixmap = view->grab(screenRect);
+        Q_UNUSED(pixmap);
+    }
+
+    delete mainWindow;
+}
+
+//---------------------------------------------------------------------
+
+QTEST_MAIN(kpBenchmark)
+
+#include "kpBenchmark.moc"
@@ -18,6 +18,11 @@ public:
     kpEffectBalanceCommand(int channels, int brightness, int contrast, int gamma, bool actOnSelection, kpCommandEnvironment *environ);
     ~kpEffectBalanceCommand() override;
 
+    int tileMargin() const override
+    {
+        return 0;
+    }
+
 protected:
     kpImage applyEffect(const kpImage &image) override;
 
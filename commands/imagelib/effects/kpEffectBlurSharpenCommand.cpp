@@ -35,6 +35,14 @@ QString kpEffectBlurSharpenCommand::nameForType(kpEffectBlurSharpen::Type type)
 
 //--------------------------------------------------------------------------------
 
+// public virtual [base kpEffectCommandBase]
+int kpEffectBlurSharpenCommand::tileMargin() const
+{
+    return kpEffectBlurSharpen::neighborhoodRadius(m_type, m_strength);
+}
+
+//--------------------------------------------------------------------------------
+
 // protected virtual [base kpEffectCommandBase]
 kpImage kpEffectBlurSharpenCommand::applyEffect(const kpImage &image)
 {
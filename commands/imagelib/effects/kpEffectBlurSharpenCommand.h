@@ -19,6 +19,8 @@ public:
 
     static QString nameForType(kpEffectBlurSharpen::Type type);
 
+    int tileMargin() const override;
+
 protected:
     kpImage applyEffect(const kpImage &image) override;
 
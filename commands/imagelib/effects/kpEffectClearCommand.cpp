@@ -19,14 +19,10 @@ kpEffectClearCommand::kpEffectClearCommand(bool actOnSelection, const kpColor &n
     : kpCommand(environ)
     , m_actOnSelection(actOnSelection)
     , m_newColor(newColor)
-    , m_oldImagePtr(nullptr)
 {
 }
 
-kpEffectClearCommand::~kpEffectClearCommand()
-{
-    delete m_oldImagePtr;
-}
+kpEffectClearCommand::~kpEffectClearCommand() = default;
 
 // public virtual [base kpCommand]
 QString kpEffectClearCommand::name() const
@@ -39,7 +35,7 @@ QString kpEffectClearCommand::name() const
 // public virtual [base kpCommand]
 kpCommandSize::SizeType kpEffectClearCommand::size() const
 {
-    return ImageSize(m_oldImagePtr);
+    return ImageSize(m_oldImage);
 }
 
 // public virtual [base kpCommand]
@@ -48,8 +44,7 @@ void kpEffectClearCommand::execute()
     kpDocument *doc = document();
     Q_ASSERT(doc);
 
-    m_oldImagePtr = new kpImage();
-    *m_oldImagePtr = doc->image(m_actOnSelection);
+    m_oldImage = doc->image(m_actOnSelection);
 
     // REFACTOR: Would like to derive entire class from kpEffectCommandBase but
     //           this code makes it difficult since it's not just acting on pixels
@@ -70,8 +65,25 @@ void kpEffectClearCommand::unexecute()
     kpDocument *doc = document();
     Q_ASSERT(doc);
 
-    doc->setImage(m_actOnSelection, *m_oldImagePtr);
+    doc->setImage(m_actOnSelection, m_oldImage.image());
+
+    m_oldImage = kpCompressedImage();
+}
+
+// public virtual [base kpCommand]
+void kpEffectClearCommand::compress()
+{
+    m_oldImage.compressLater();
+}
+
+// public virtual [base kpCommand]
+void kpEffectClearCommand::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    m_oldImage.spillTo(file);
+}
 
-    delete m_oldImagePtr;
-    m_oldImagePtr = nullptr;
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpEffectClearCommand::spilledSize() const
+{
+    return m_oldImage.spilledSize();
 }
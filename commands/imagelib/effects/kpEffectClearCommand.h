@@ -11,7 +11,7 @@
 #include "commands/kpCommand.h"
 
 #include "imagelib/kpColor.h"
-#include "imagelib/kpImage.h"
+#include "imagelib/kpCompressedImage.h"
 
 class kpEffectClearCommand : public kpCommand
 {
@@ -26,11 +26,15 @@ public:
     void execute() override;
     void unexecute() override;
 
+    void compress() override;
+    void spill(const std::shared_ptr<kpSpillFile> &file) override;
+    SizeType spilledSize() const override;
+
 private:
     bool m_actOnSelection;
 
     kpColor m_newColor;
-    kpImage *m_oldImagePtr;
+    kpCompressedImage m_oldImage;
 };
 
 #endif // kpEffectClearCommand_H
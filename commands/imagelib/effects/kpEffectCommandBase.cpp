@@ -8,12 +8,45 @@
 #include "kpEffectCommandBase.h"
 
 #include "document/kpDocument.h"
+#include "generic/kpParallel.h"
+#include "generic/kpProfiler.h"
 #include "generic/kpSetOverrideCursorSaver.h"
+#include "imagelib/kpCompressedImage.h"
 #include "kpDefs.h"
+#include "views/manager/kpViewManager.h"
 
 #include <KLocalizedString>
 
 #include <QCursor>
+#include <QPainter>
+#include <QRegion>
+
+//--------------------------------------------------------------------------------
+
+// Smaller images are quick enough to apply effects to in one go.
+static const qint64 ProgressiveMinPixels = 1024 * 1024;
+
+// Rows per part of the image that effects are applied to concurrently.
+static const int BandHeight = 256;
+
+// Pixels of context given around each part regardless of tileMargin(),
+// since some effects leave images that are too small alone.
+static const int MinMargin = 8;
+
+//--------------------------------------------------------------------------------
+
+static QList<QRect> SplitIntoBands(const QRegion &region)
+{
+    QList<QRect> bands;
+
+    for (const QRect &rect : region) {
+        for (int y = rect.top(); y <= rect.bottom(); y += BandHeight) {
+            bands.append(QRect(rect.x(), y, rect.width(), qMin(BandHeight, rect.bottom() + 1 - y)));
+        }
+    }
+
+    return bands;
+}
 
 //--------------------------------------------------------------------------------
 
@@ -21,7 +54,7 @@ struct kpEffectCommandBasePrivate {
     QString name;
     bool actOnSelection{false};
 
-    kpImage oldImage;
+    kpCompressedImage oldImage;
 };
 
 kpEffectCommandBase::kpEffectCommandBase(const QString &name, bool actOnSelection, kpCommandEnvironment *environ)
@@ -63,7 +96,25 @@ void kpEffectCommandBase::execute()
         d->oldImage = oldImage;
     }
 
-    kpImage newImage = /*pure virtual*/ applyEffect(oldImage);
+    QRect visibleRect;
+    if (!d->actOnSelection && tileMargin() >= 0 && viewManager() && qint64(oldImage.width()) * oldImage.height() >= ProgressiveMinPixels) {
+        visibleRect = viewManager()->visibleDocumentRect();
+    }
+
+    kpImage newImage;
+    {
+        kpProfilerScope profilerScope(kpProfiler::Effect, "kpEffectCommandBase::applyEffect");
+        if (profilerScope.isActive()) {
+            profilerScope.setDetail(d->name);
+            profilerScope.addPixels(qint64(oldImage.width()) * oldImage.height());
+        }
+
+        if (visibleRect.isEmpty() || visibleRect.contains(oldImage.rect())) {
+            newImage = /*pure virtual*/ applyEffect(oldImage);
+        } else {
+            newImage = applyEffectProgressively(oldImage, visibleRect);
+        }
+    }
 
     doc->setImage(d->actOnSelection, newImage);
 }
@@ -79,12 +130,103 @@ void kpEffectCommandBase::unexecute()
     kpImage newImage;
 
     if (!isInvertible()) {
-        newImage = d->oldImage;
+        newImage = d->oldImage.image();
     } else {
-        newImage = /*pure virtual*/ applyEffect(doc->image(d->actOnSelection));
+        const kpImage oldImage = doc->image(d->actOnSelection);
+
+        kpProfilerScope profilerScope(kpProfiler::Effect, "kpEffectCommandBase::applyEffect");
+        if (profilerScope.isActive()) {
+            profilerScope.setDetail(d->name);
+            profilerScope.addPixels(qint64(oldImage.width()) * oldImage.height());
+        }
+
+        newImage = /*pure virtual*/ applyEffect(oldImage);
     }
 
     doc->setImage(d->actOnSelection, newImage);
 
-    d->oldImage = kpImage();
+    d->oldImage = kpCompressedImage();
+}
+
+// private
+std::vector<kpImage> kpEffectCommandBase::applyEffectAt(const kpImage &image, const QList<QRect> &rects)
+{
+    Q_ASSERT(tileMargin() >= 0);
+    const int margin = qMax(tileMargin(), MinMargin);
+
+    std::vector<kpImage> results(rects.size());
+
+    kpParallelFor(int(rects.size()), 1, [this, &image, &rects, &results, margin](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const QRect &rect = rects[i];
+            const QRect sourceRect = rect.adjusted(-margin, -margin, margin, margin) & image.rect();
+
+            const kpImage result = /*pure virtual*/ applyEffect(image.copy(sourceRect));
+            results[i] = result.copy(rect.translated(-sourceRect.topLeft()));
+        }
+    });
+
+    return results;
+}
+
+// private
+kpImage kpEffectCommandBase::applyEffectProgressively(const kpImage &image, const QRect &visibleRect)
+{
+    kpDocument *doc = document();
+    Q_ASSERT(doc);
+
+    // Show what can be seen first, repainting the views right away (there
+    // is no event loop to do so until the command is complete)...
+    const QList<QRect> visibleBands = ::SplitIntoBands(QRegion(visibleRect));
+    const std::vector<kpImage> visibleResults = applyEffectAt(image, visibleBands);
+
+    for (size_t i = 0; i < visibleResults.size(); i++) {
+        doc->setImageAt(visibleResults[i], visibleBands[i].topLeft());
+    }
+    // (the command history has queued view updates until the command is
+    //  complete)
+    viewManager()->repaintViewsNow(visibleRect);
+
+    // ...then the rest.  This blocks, rather than running an event loop
+    // until it is done, since events (e.g. closing the window) could
+    // otherwise change or delete the document, or this command, while the
+    // effect is only partly applied.
+    const QList<QRect> otherBands = ::SplitIntoBands(QRegion(image.rect()).subtracted(visibleRect));
+    const std::vector<kpImage> otherResults = applyEffectAt(image, otherBands);
+
+    // (in the format that applyEffect() returns)
+    kpImage newImage(image.size(), visibleResults.front().format());
+    newImage.setDotsPerMeterX(image.dotsPerMeterX());
+    newImage.setDotsPerMeterY(image.dotsPerMeterY());
+    newImage.setOffset(image.offset());
+
+    QPainter painter(&newImage);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (size_t i = 0; i < visibleResults.size(); i++) {
+        painter.drawImage(visibleBands[i].topLeft(), visibleResults[i]);
+    }
+    for (size_t i = 0; i < otherResults.size(); i++) {
+        painter.drawImage(otherBands[i].topLeft(), otherResults[i]);
+    }
+    painter.end();
+
+    return newImage;
+}
+
+// public virtual [base kpCommand]
+void kpEffectCommandBase::compress()
+{
+    d->oldImage.compressLater();
+}
+
+// public virtual [base kpCommand]
+void kpEffectCommandBase::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    d->oldImage.spillTo(file);
+}
+
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpEffectCommandBase::spilledSize() const
+{
+    return d->oldImage.spilledSize();
 }
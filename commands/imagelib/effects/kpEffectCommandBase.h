@@ -11,6 +11,11 @@
 #include "commands/kpCommand.h"
 #include "imagelib/kpImage.h"
 
+#include <QList>
+#include <QRect>
+
+#include <vector>
+
 class kpEffectCommandBase : public kpCommand
 {
 public:
@@ -24,6 +29,10 @@ public:
     void execute() override;
     void unexecute() override;
 
+    void compress() override;
+    void spill(const std::shared_ptr<kpSpillFile> &file) override;
+    SizeType spilledSize() const override;
+
 public:
     // Return true if applyEffect(applyEffect(image)) == image
     // to avoid storing the old image, saving memory.
@@ -32,10 +41,37 @@ public:
         return false;
     }
 
+    // Return how many pixels around each pixel applyEffect() reads to
+    // compute it, if applyEffect() can be applied to parts of an image
+    // separately (and concurrently), clamping at the edges of the image;
+    // else -1.
+    //
+    // If not -1, execute() first applies the effect to what can be seen in
+    // the views and shows it, then finishes the rest of the image in the
+    // background.
+    virtual int tileMargin() const
+    {
+        return -1;
+    }
+
+    // Returns <image> with the effect applied, without changing the
+    // document (e.g. for adjustments).  Safe to call concurrently if
+    // tileMargin() is not -1.
+    kpImage applyTo(const kpImage &image)
+    {
+        return applyEffect(image);
+    }
+
 protected:
     virtual kpImage applyEffect(const kpImage &image) = 0;
 
 private:
+    // Applies the effect to each of <rects> of <image>, concurrently, using
+    // tileMargin().  The results are in the same order as <rects>.
+    std::vector<kpImage> applyEffectAt(const kpImage &image, const QList<QRect> &rects);
+
+    kpImage applyEffectProgressively(const kpImage &image, const QRect &visibleRect);
+
     struct kpEffectCommandBasePrivate *d;
 };
 
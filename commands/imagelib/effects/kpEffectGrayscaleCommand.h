@@ -27,6 +27,11 @@ public:
         return false;
     }
 
+    int tileMargin() const override
+    {
+        return 0;
+    }
+
 protected:
     kpImage applyEffect(const kpImage &image) override;
 };
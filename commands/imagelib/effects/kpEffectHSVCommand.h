@@ -15,6 +15,11 @@ class kpEffectHSVCommand : public kpEffectCommandBase
 public:
     kpEffectHSVCommand(double hue, double saturation, double value, bool actOnSelection, kpCommandEnvironment *environ);
 
+    int tileMargin() const override
+    {
+        return 0;
+    }
+
 protected:
     kpImage applyEffect(const kpImage &image) override;
 
@@ -28,6 +28,11 @@ public:
         return true;
     }
 
+    int tileMargin() const override
+    {
+        return 0;
+    }
+
 protected:
     kpImage applyEffect(const kpImage &image) override;
 
@@ -0,0 +1,57 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "kpAdjustmentsCommand.h"
+
+#include "document/kpDocument.h"
+
+struct kpAdjustmentsCommandPrivate {
+    kpAdjustmentList adjustments, oldAdjustments;
+};
+
+kpAdjustmentsCommand::kpAdjustmentsCommand(const QString &name,
+                                           const kpAdjustmentList &adjustments,
+                                           const kpAdjustmentList &oldAdjustments,
+                                           kpCommandEnvironment *environ)
+
+    : kpNamedCommand(name, environ)
+    , d(new kpAdjustmentsCommandPrivate())
+{
+    d->adjustments = adjustments;
+    d->oldAdjustments = oldAdjustments;
+}
+
+kpAdjustmentsCommand::~kpAdjustmentsCommand()
+{
+    delete d;
+}
+
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpAdjustmentsCommand::size() const
+{
+    // Only settings are stored: the evaluated tiles belong to the document.
+    return kpCommandSize::SizeType(d->adjustments.size() + d->oldAdjustments.size()) * sizeof(kpAdjustment);
+}
+
+// public virtual [base kpCommand]
+void kpAdjustmentsCommand::execute()
+{
+    kpDocument *doc = document();
+    Q_ASSERT(doc);
+
+    doc->setAdjustments(d->adjustments);
+    doc->setModified();
+}
+
+// public virtual [base kpCommand]
+void kpAdjustmentsCommand::unexecute()
+{
+    kpDocument *doc = document();
+    Q_ASSERT(doc);
+
+    doc->setAdjustments(d->oldAdjustments);
+    doc->setModified();
+}
@@ -0,0 +1,30 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpAdjustmentsCommand_H
+#define kpAdjustmentsCommand_H
+
+#include "commands/kpNamedCommand.h"
+#include "imagelib/kpAdjustmentStack.h"
+
+// Changes the document's adjustments (see kpDocument::setAdjustments()).
+class kpAdjustmentsCommand : public kpNamedCommand
+{
+public:
+    kpAdjustmentsCommand(const QString &name, const kpAdjustmentList &adjustments, const kpAdjustmentList &oldAdjustments, kpCommandEnvironment *environ);
+    ~kpAdjustmentsCommand() override;
+
+    SizeType size() const override;
+
+public:
+    void execute() override;
+    void unexecute() override;
+
+private:
+    struct kpAdjustmentsCommandPrivate *const d;
+};
+
+#endif // kpAdjustmentsCommand_H
@@ -317,11 +317,11 @@ void kpTransformResizeScaleCommand::unexecute()
             kpPixmapFX::setPixmapAt(&newImage, QPoint(0, 0), doc->image());
 
             if (m_newWidth < m_oldWidth) {
-                kpPixmapFX::setPixmapAt(&newImage, QPoint(m_newWidth, 0), m_oldRightImage);
+                kpPixmapFX::setPixmapAt(&newImage, QPoint(m_newWidth, 0), m_oldRightImage.image());
             }
 
             if (m_newHeight < m_oldHeight) {
-                kpPixmapFX::setPixmapAt(&newImage, QPoint(0, m_newHeight), m_oldBottomImage);
+                kpPixmapFX::setPixmapAt(&newImage, QPoint(0, m_newHeight), m_oldBottomImage.image());
             }
 
             doc->setImage(newImage);
@@ -336,7 +336,7 @@ void kpTransformResizeScaleCommand::unexecute()
         kpImage oldImage;
 
         if (!m_isLosslessScale) {
-            oldImage = m_oldImage;
+            oldImage = m_oldImage.image();
         } else {
             oldImage = kpPixmapFX::scale(doc->image(m_actOnSelection), m_oldWidth, m_oldHeight);
         }
@@ -368,3 +368,25 @@ void kpTransformResizeScaleCommand::unexecute()
         QApplication::restoreOverrideCursor();
     }
 }
+
+// public virtual [base kpCommand]
+void kpTransformResizeScaleCommand::compress()
+{
+    m_oldImage.compressLater();
+    m_oldRightImage.compressLater();
+    m_oldBottomImage.compressLater();
+}
+
+// public virtual [base kpCommand]
+void kpTransformResizeScaleCommand::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    m_oldImage.spillTo(file);
+    m_oldRightImage.spillTo(file);
+    m_oldBottomImage.spillTo(file);
+}
+
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpTransformResizeScaleCommand::spilledSize() const
+{
+    return m_oldImage.spilledSize() + m_oldRightImage.spilledSize() + m_oldBottomImage.spilledSize();
+}
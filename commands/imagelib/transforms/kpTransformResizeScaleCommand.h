@@ -10,7 +10,7 @@
 
 #include "commands/kpCommand.h"
 #include "imagelib/kpColor.h"
-#include "imagelib/kpImage.h"
+#include "imagelib/kpCompressedImage.h"
 
 class QSize;
 
@@ -54,6 +54,10 @@ public:
     void execute() override;
     void unexecute() override;
 
+    void compress() override;
+    void spill(const std::shared_ptr<kpSpillFile> &file) override;
+    SizeType spilledSize() const override;
+
 protected:
     bool m_actOnSelection;
     int m_newWidth, m_newHeight;
@@ -64,7 +68,7 @@ protected:
 
     int m_oldWidth, m_oldHeight;
     bool m_actOnTextSelection;
-    kpImage m_oldImage, m_oldRightImage, m_oldBottomImage;
+    kpCompressedImage m_oldImage, m_oldRightImage, m_oldBottomImage;
     kpAbstractSelection *m_oldSelectionPtr;
 };
 
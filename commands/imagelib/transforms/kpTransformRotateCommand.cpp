@@ -138,8 +138,8 @@ void kpTransformRotateCommand::unexecute()
     kpImage oldImage;
 
     if (!m_losslessRotation) {
-        oldImage = m_oldImage;
-        m_oldImage = kpImage();
+        oldImage = m_oldImage.image();
+        m_oldImage = kpCompressedImage();
     } else {
         oldImage = kpPixmapFX::rotate(doc->image(m_actOnSelection), 360 - m_angle, m_backgroundColor);
     }
@@ -157,3 +157,21 @@ void kpTransformRotateCommand::unexecute()
 
     QApplication::restoreOverrideCursor();
 }
+
+// public virtual [base kpCommand]
+void kpTransformRotateCommand::compress()
+{
+    m_oldImage.compressLater();
+}
+
+// public virtual [base kpCommand]
+void kpTransformRotateCommand::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    m_oldImage.spillTo(file);
+}
+
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpTransformRotateCommand::spilledSize() const
+{
+    return m_oldImage.spilledSize();
+}
@@ -10,7 +10,7 @@
 
 #include "commands/kpCommand.h"
 #include "imagelib/kpColor.h"
-#include "imagelib/kpImage.h"
+#include "imagelib/kpCompressedImage.h"
 
 class kpAbstractImageSelection;
 
@@ -29,6 +29,10 @@ public:
     void execute() override;
     void unexecute() override;
 
+    void compress() override;
+    void spill(const std::shared_ptr<kpSpillFile> &file) override;
+    SizeType spilledSize() const override;
+
 private:
     bool m_actOnSelection;
     double m_angle;
@@ -36,7 +40,7 @@ private:
     kpColor m_backgroundColor;
 
     bool m_losslessRotation;
-    kpImage m_oldImage;
+    kpCompressedImage m_oldImage;
     kpAbstractImageSelection *m_oldSelectionPtr;
 };
 
@@ -125,8 +125,8 @@ void kpTransformSkewCommand::unexecute()
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
     if (!m_actOnSelection) {
-        doc->setImage(m_oldImage);
-        m_oldImage = kpImage();
+        doc->setImage(m_oldImage.image());
+        m_oldImage = kpCompressedImage();
     } else {
         doc->setSelection(*m_oldSelectionPtr);
         delete m_oldSelectionPtr;
@@ -137,3 +137,21 @@ void kpTransformSkewCommand::unexecute()
 
     QApplication::restoreOverrideCursor();
 }
+
+// public virtual [base kpCommand]
+void kpTransformSkewCommand::compress()
+{
+    m_oldImage.compressLater();
+}
+
+// public virtual [base kpCommand]
+void kpTransformSkewCommand::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    m_oldImage.spillTo(file);
+}
+
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpTransformSkewCommand::spilledSize() const
+{
+    return m_oldImage.spilledSize();
+}
@@ -10,7 +10,7 @@
 
 #include "commands/kpCommand.h"
 #include "imagelib/kpColor.h"
-#include "imagelib/kpImage.h"
+#include "imagelib/kpCompressedImage.h"
 
 class kpTransformSkewCommand : public kpCommand
 {
@@ -25,12 +25,16 @@ public:
     void execute() override;
     void unexecute() override;
 
+    void compress() override;
+    void spill(const std::shared_ptr<kpSpillFile> &file) override;
+    SizeType spilledSize() const override;
+
 private:
     bool m_actOnSelection;
     int m_hangle, m_vangle;
 
     kpColor m_backgroundColor;
-    kpImage m_oldImage;
+    kpCompressedImage m_oldImage;
     kpAbstractImageSelection *m_oldSelectionPtr;
 };
 
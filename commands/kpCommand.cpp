@@ -19,6 +19,23 @@ kpCommand::kpCommand(kpCommandEnvironment *environ)
 
 kpCommand::~kpCommand() = default;
 
+// public virtual
+void kpCommand::compress()
+{
+}
+
+// public virtual
+void kpCommand::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    Q_UNUSED(file)
+}
+
+// public virtual
+kpCommandSize::SizeType kpCommand::spilledSize() const
+{
+    return 0;
+}
+
 kpCommandEnvironment *kpCommand::environ() const
 {
     return m_environ;
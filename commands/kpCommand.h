@@ -8,6 +8,8 @@
 #ifndef kpCommand_H
 #define kpCommand_H
 
+#include <memory>
+
 #include "kpCommandSize.h"
 #undef environ // macro on win32
 
@@ -17,6 +19,7 @@ class kpAbstractImageSelection;
 class kpAbstractSelection;
 class kpCommandEnvironment;
 class kpDocument;
+class kpSpillFile;
 class kpTextSelection;
 class kpViewManager;
 
@@ -46,6 +49,28 @@ public:
     virtual void execute() = 0;
     virtual void unexecute() = 0;
 
+    // Called by the command history once this command is no longer the
+    // next one to be undone, and so is less likely to be needed soon.
+    // Commands that keep large images for unexecute() should start
+    // compressing them (see kpCompressedImage::compressLater()).
+    //
+    // May be called repeatedly.  The default implementation does nothing.
+    virtual void compress();
+
+    // Called by the command history when keeping this command in memory
+    // would exceed the history's size limit.  Commands that keep large
+    // images for unexecute() should move them into <file> (see
+    // kpCompressedImage::spillTo()), so that size() drops and the command
+    // need not be discarded.  When called again with a different <file>
+    // (to compact the old one), anything already spilled should be moved
+    // there, which kpCompressedImage::spillTo() does.
+    //
+    // May be called repeatedly.  The default implementation does nothing.
+    virtual void spill(const std::shared_ptr<kpSpillFile> &file);
+
+    // Returns the number of bytes spill() moved into the file.
+    virtual SizeType spilledSize() const;
+
 protected:
     kpCommandEnvironment *environ() const;
 
@@ -11,7 +11,9 @@
 
 #include <climits>
 
+#include <QLocale>
 #include <QMenu>
+#include <QTimer>
 
 #include <KActionCollection>
 #include <KConfigGroup>
@@ -23,6 +25,9 @@
 
 #include "document/kpDocument.h"
 #include "environments/commands/kpCommandEnvironment.h"
+#include "generic/kpProfiler.h"
+#include "generic/kpSpillFile.h"
+#include "imagelib/kpCompressedImage.h"
 #include "kpCommand.h"
 #include "kpDefs.h"
 #include "kpLogCategories.h"
@@ -31,6 +36,11 @@
 
 //---------------------------------------------------------------------
 
+// Smaller spill files are not worth compacting.
+static const qint64 MinCompactSpillFileSize = 64 * 1024 * 1024;
+
+//---------------------------------------------------------------------
+
 static void ClearPointerList(QList<kpCommand *> &list)
 {
     qDeleteAll(list);
@@ -64,6 +74,13 @@ kpCommandHistoryBase::kpCommandHistoryBase(bool doReadConfig, KActionCollection
 
     m_documentRestoredPosition = 0;
 
+    // Commands compress() themselves in the background, so when
+    // trimCommandListsUpdateActions() measures them, they are usually still
+    // uncompressed.  Measure them again once they are done, so that how
+    // many are kept does not depend on how quickly that happened.
+    m_retrimQueued = false;
+    connect(kpCompressedImage::Notifier(), &kpCompressedImageNotifier::compressionFinished, this, &kpCommandHistoryBase::slotCompressionFinished);
+
     if (doReadConfig) {
         readConfig();
     }
@@ -209,6 +226,11 @@ void kpCommandHistoryBase::addCommand(kpCommand *command, bool execute)
 
         if (execute)
     {
+        kpProfilerScope profilerScope(kpProfiler::CommandExecute, "kpCommand::execute");
+        if (profilerScope.isActive()) {
+            profilerScope.setDetail(command->name());
+        }
+
         command->execute();
     }
 
@@ -242,6 +264,9 @@ void kpCommandHistoryBase::clear()
     ::ClearPointerList(m_undoCommandList);
     ::ClearPointerList(m_redoCommandList);
 
+    // (deletes the file, now that nothing refers to it)
+    m_spillFile.reset();
+
     m_documentRestoredPosition = 0;
 
     updateActions();
@@ -261,7 +286,14 @@ void kpCommandHistoryBase::undoInternal()
         return;
     }
 
-    undoCommand->unexecute();
+    {
+        kpProfilerScope profilerScope(kpProfiler::CommandUnexecute, "kpCommand::unexecute");
+        if (profilerScope.isActive()) {
+            profilerScope.setDetail(undoCommand->name());
+        }
+
+        undoCommand->unexecute();
+    }
 
     m_undoCommandList.erase(m_undoCommandList.begin());
     m_redoCommandList.push_front(undoCommand);
@@ -293,7 +325,14 @@ void kpCommandHistoryBase::redoInternal()
         return;
     }
 
-    redoCommand->execute();
+    {
+        kpProfilerScope profilerScope(kpProfiler::CommandExecute, "kpCommand::execute");
+        if (profilerScope.isActive()) {
+            profilerScope.setDetail(redoCommand->name());
+        }
+
+        redoCommand->execute();
+    }
 
     m_redoCommandList.erase(m_redoCommandList.begin());
     m_undoCommandList.push_front(redoCommand);
@@ -407,12 +446,103 @@ void kpCommandHistoryBase::trimCommandListsUpdateActions()
     qCDebug(kpLogCommands) << "kpCommandHistoryBase::trimCommandListsUpdateActions()";
 #endif
 
+    compressCommands();
     trimCommandLists();
     updateActions();
 }
 
 //--------------------------------------------------------------------------------
 
+// protected
+void kpCommandHistoryBase::compressCommands()
+{
+    // (commands that have already compressed themselves return immediately)
+    for (int i = 1; i < m_undoCommandList.size(); i++) {
+        m_undoCommandList[i]->compress();
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+// private slot
+void kpCommandHistoryBase::slotCompressionFinished()
+{
+    // Several images (e.g. the tiles of one command) often finish at about
+    // the same time: trim once for them all.
+    if (m_retrimQueued) {
+        return;
+    }
+    m_retrimQueued = true;
+
+    QTimer::singleShot(0, this, [this] {
+        m_retrimQueued = false;
+
+#if DEBUG_KP_COMMAND_HISTORY
+        qCDebug(kpLogCommands) << "kpCommandHistoryBase::slotCompressionFinished() - trimming again";
+#endif
+        trimCommandLists();
+        updateActions();
+    });
+}
+
+//--------------------------------------------------------------------------------
+
+// protected
+std::shared_ptr<kpSpillFile> kpCommandHistoryBase::spillFile()
+{
+    if (!m_spillFile) {
+        m_spillFile = std::make_shared<kpSpillFile>();
+    }
+
+    return m_spillFile;
+}
+
+//--------------------------------------------------------------------------------
+
+// protected
+void kpCommandHistoryBase::compactSpillFile()
+{
+    if (!m_spillFile || m_spillFile->size() < MinCompactSpillFileSize) {
+        return;
+    }
+
+    // The file is append-only, so what was spilled by discarded commands,
+    // or read back by commands that have since been undone or redone, is
+    // dead space.
+    kpCommandSize::SizeType liveSize = 0;
+    for (const kpCommand *command : std::as_const(m_undoCommandList)) {
+        liveSize += command->spilledSize();
+    }
+    for (const kpCommand *command : std::as_const(m_redoCommandList)) {
+        liveSize += command->spilledSize();
+    }
+
+    if (liveSize * 2 > m_spillFile->size()) {
+        return;
+    }
+
+#if DEBUG_KP_COMMAND_HISTORY
+    qCDebug(kpLogCommands) << "kpCommandHistoryBase::compactSpillFile() size=" << m_spillFile->size() << "live=" << liveSize;
+#endif
+
+    auto newFile = std::make_shared<kpSpillFile>();
+    const auto moveSpilled = [&newFile](const QList<kpCommand *> &commandList) {
+        for (kpCommand *command : commandList) {
+            if (command->spilledSize() > 0) {
+                command->spill(newFile);
+            }
+        }
+    };
+    moveSpilled(m_undoCommandList);
+    moveSpilled(m_redoCommandList);
+
+    // (the old file is deleted once nothing refers to it - anything that
+    //  could not be moved keeps it alive)
+    m_spillFile = newFile;
+}
+
+//--------------------------------------------------------------------------------
+
 // protected
 void kpCommandHistoryBase::trimCommandList(QList<kpCommand *> &commandList)
 {
@@ -444,7 +574,17 @@ void kpCommandHistoryBase::trimCommandList(QList<kpCommand *> &commandList)
         bool advanceIt = true;
 
         if (sizeSoFar <= m_undoMaxLimitSizeLimit) {
-            sizeSoFar += (*it)->size();
+            kpCommandSize::SizeType commandSize = (*it)->size();
+
+            // Over the limit?  Move what we can to disk, rather than
+            // discarding the command below (but keep the next command to
+            // undo/redo in memory).
+            if (upto > 0 && sizeSoFar + commandSize > m_undoMaxLimitSizeLimit) {
+                (*it)->spill(spillFile());
+                commandSize = (*it)->size();
+            }
+
+            sizeSoFar += commandSize;
         }
 
 #if DEBUG_KP_COMMAND_HISTORY && 0
@@ -486,6 +626,14 @@ void kpCommandHistoryBase::trimCommandLists()
     trimCommandList(m_undoCommandList);
     trimCommandList(m_redoCommandList);
 
+    // Nothing spilled is left (e.g. all spilled commands were discarded)?
+    // Delete the file, as it is append-only.
+    if (m_spillFile && m_spillFile.use_count() == 1) {
+        m_spillFile.reset();
+    } else {
+        compactSpillFile();
+    }
+
 #if DEBUG_KP_COMMAND_HISTORY
     qCDebug(kpLogCommands) << "\tdocumentRestoredPosition="
                            << m_documentRestoredPosition
@@ -511,6 +659,12 @@ static void populatePopupMenu(QMenu *popupMenu, const QString &undoOrRedo, const
         return;
     }
 
+    kpCommandSize::SizeType memorySize = 0, diskSize = 0;
+    for (const kpCommand *command : commandList) {
+        memorySize += command->size();
+        diskSize += command->spilledSize();
+    }
+
     popupMenu->clear();
 
     QList<kpCommand *>::const_iterator it = commandList.begin();
@@ -528,6 +682,15 @@ static void populatePopupMenu(QMenu *popupMenu, const QString &undoOrRedo, const
         // LOCOMPAT: should be centered text.
         popupMenu->addSection(i18np("%1 more item", "%1 more items", commandList.size() - i));
     }
+
+    if (!commandList.isEmpty()) {
+        const QLocale locale;
+        QAction *sizeAction = popupMenu->addAction(i18nc("@item:inmenu undo/redo history size",
+                                                         "In memory: %1, on disk: %2",
+                                                         locale.formattedDataSize(memorySize),
+                                                         locale.formattedDataSize(diskSize)));
+        sizeAction->setEnabled(false);
+    }
 }
 
 // protected
@@ -573,6 +736,8 @@ void kpCommandHistoryBase::updateActions()
 #if DEBUG_KP_COMMAND_HISTORY
     qCDebug(kpLogCommands) << "\tpopuplatePopupMenu redo=" << timer.elapsed() << "ms";
 #endif
+
+    Q_EMIT commandsChanged();
 }
 
 // public
@@ -8,6 +8,8 @@
 #ifndef kpCommandHistoryBase_H
 #define kpCommandHistoryBase_H
 
+#include <memory>
+
 #include <QList>
 #include <QObject>
 #include <QString>
@@ -20,11 +22,14 @@ class KActionCollection;
 class KToolBarPopupAction;
 
 class kpCommand;
+class kpSpillFile;
 
 // Clone of KCommandHistory with features required by KolourPaint but which
 // could also be useful for other apps:
 // - nextUndoCommand()/nextRedoCommand()
 // - undo/redo history limited by both number and size
+// - commands over the size limit are spilled to disk, rather than
+//   discarded, if they can be
 //
 // Features not required by KolourPaint (e.g. commandExecuted()) are not
 // implemented and undo limit == redo limit.  So compared to
@@ -81,6 +86,12 @@ protected:
     QString redoActionToolTip() const;
 
     void trimCommandListsUpdateActions();
+    // Lets all undo commands but the next one compress() themselves.
+    void compressCommands();
+    std::shared_ptr<kpSpillFile> spillFile();
+    // If most of the spill file is no longer used by any command, moves
+    // what is still used into a new file and lets go of the old one.
+    void compactSpillFile();
     void trimCommandList(QList<kpCommand *> &commandList);
     void trimCommandLists();
     void updateActions();
@@ -94,9 +105,16 @@ public:
 public Q_SLOTS:
     virtual void documentSaved();
 
+private Q_SLOTS:
+    void slotCompressionFinished();
+
 Q_SIGNALS:
     void documentRestored();
 
+    // Emitted whenever a command has been added, undone or redone, or the
+    // history cleared.
+    void commandsChanged();
+
 protected:
     KToolBarPopupAction *m_actionUndo, *m_actionRedo;
 
@@ -107,6 +125,10 @@ protected:
     int m_undoMinLimit, m_undoMaxLimit;
     kpCommandSize::SizeType m_undoMaxLimitSizeLimit;
 
+    // Where commands over <m_undoMaxLimitSizeLimit> are spilled to.
+    // Created when first needed.
+    std::shared_ptr<kpSpillFile> m_spillFile;
+
     // What you have to do to get back to the document's unmodified state:
     // * -x: must Undo x times
     // * 0: unmodified
@@ -115,6 +137,10 @@ protected:
     //
     // ASSUMPTION: will never have INT_MAX commands in any list.
     int m_documentRestoredPosition;
+
+    // Whether trimCommandLists() is about to be called again, now that
+    // commands have compressed themselves.
+    bool m_retrimQueued;
 };
 
 #endif // kpCommandHistoryBase_H
@@ -8,6 +8,7 @@
 #define DEBUG_KP_COMMAND_SIZE 0
 
 #include "commands/kpCommandSize.h"
+#include "imagelib/kpCompressedImage.h"
 #include "layers/selections/kpAbstractSelection.h"
 
 #include <QImage>
@@ -79,6 +80,12 @@ kpCommandSize::SizeType kpCommandSize::ImageSize(const kpImage *image)
     return kpCommandSize::PixmapSize(image);
 }
 
+// public static
+kpCommandSize::SizeType kpCommandSize::ImageSize(const kpCompressedImage &image)
+{
+    return image.size();
+}
+
 // public static
 kpCommandSize::SizeType kpCommandSize::SelectionSize(const kpAbstractSelection &sel)
 {
@@ -15,6 +15,7 @@ class QPolygon;
 class QString;
 
 class kpAbstractSelection;
+class kpCompressedImage;
 
 //
 // Estimates the size of the object being pointed to, in bytes.
@@ -50,6 +51,7 @@ public:
 
     static SizeType ImageSize(const kpImage &image);
     static SizeType ImageSize(const kpImage *image);
+    static SizeType ImageSize(const kpCompressedImage &image);
 
     static SizeType SelectionSize(const kpAbstractSelection &sel);
     static SizeType SelectionSize(const kpAbstractSelection *sel);
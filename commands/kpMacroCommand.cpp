@@ -98,6 +98,38 @@ void kpMacroCommand::unexecute()
 
 //---------------------------------------------------------------------
 
+// public virtual [base kpCommand]
+void kpMacroCommand::compress()
+{
+    for (kpCommand *command : std::as_const(m_commandList)) {
+        command->compress();
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public virtual [base kpCommand]
+void kpMacroCommand::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    for (kpCommand *command : std::as_const(m_commandList)) {
+        command->spill(file);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpMacroCommand::spilledSize() const
+{
+    SizeType s = 0;
+    for (kpCommand *command : m_commandList) {
+        s += command->spilledSize();
+    }
+    return s;
+}
+
+//---------------------------------------------------------------------
+
 // public
 void kpMacroCommand::addCommand(kpCommand *command)
 {
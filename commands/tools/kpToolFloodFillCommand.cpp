@@ -11,7 +11,6 @@
 
 #include "document/kpDocument.h"
 #include "imagelib/kpColor.h"
-#include "imagelib/kpImage.h"
 #include "kpDefs.h"
 #include "kpLogCategories.h"
 
@@ -22,7 +21,6 @@
 //---------------------------------------------------------------------
 
 struct kpToolFloodFillCommandPrivate {
-    kpImage oldImage;
     bool fillEntireImage{false};
 };
 
@@ -35,6 +33,8 @@ kpToolFloodFillCommand::kpToolFloodFillCommand(int x, int y, const kpColor &colo
     , d(new kpToolFloodFillCommandPrivate())
 {
     d->fillEntireImage = false;
+
+    kpFloodFill::setIndex(document()->floodFillIndex());
 }
 
 //---------------------------------------------------------------------
@@ -57,7 +57,8 @@ QString kpToolFloodFillCommand::name() const
 // public virtual [base kpCommand]
 kpCommandSize::SizeType kpToolFloodFillCommand::size() const
 {
-    return kpFloodFill::size() + ImageSize(d->oldImage);
+    // (includes the pixels saved for unexecute())
+    return kpFloodFill::size();
 }
 
 //---------------------------------------------------------------------
@@ -87,7 +88,7 @@ void kpToolFloodFillCommand::execute()
         if (rect.isValid()) {
             QApplication::setOverrideCursor(Qt::WaitCursor);
             {
-                d->oldImage = doc->getImageAt(rect);
+                kpFloodFill::saveOldPixels();
 
                 kpFloodFill::fill();
                 doc->slotContentsChanged(rect);
@@ -118,9 +119,7 @@ void kpToolFloodFillCommand::unexecute()
     } else {
         QRect rect = kpFloodFill::boundingRect();
         if (rect.isValid()) {
-            doc->setImageAt(d->oldImage, rect.topLeft());
-
-            d->oldImage = kpImage();
+            kpFloodFill::restoreOldPixels();
 
             doc->slotContentsChanged(rect);
         }
@@ -13,7 +13,7 @@
 #include "environments/commands/kpCommandEnvironment.h"
 #include "kpDefs.h"
 #include "layers/selections/kpAbstractSelection.h"
-#include "tools/kpTool.h"
+#include "pixmapfx/kpPixmapFX.h"
 #include "views/manager/kpViewManager.h"
 #include "widgets/toolbars/options/kpToolWidgetOpaqueOrTransparent.h"
 
@@ -21,6 +21,22 @@
 
 //--------------------------------------------------------------------------------
 
+// Width and height of the tiles that the document's pixels are saved in.
+// (large enough for kpCompressedImage::compressLater() to compress)
+static const int TileSize = 128;
+
+static quint64 TileKey(int tileX, int tileY)
+{
+    return (quint64(quint32(tileY)) << 32) | quint32(tileX);
+}
+
+static QPoint TileTopLeft(quint64 key)
+{
+    return {int(quint32(key)) * TileSize, int(quint32(key >> 32)) * TileSize};
+}
+
+//--------------------------------------------------------------------------------
+
 kpToolSelectionMoveCommand::kpToolSelectionMoveCommand(const QString &name, kpCommandEnvironment *environ)
     : kpNamedCommand(name, environ)
 {
@@ -49,7 +65,12 @@ kpAbstractSelection *kpToolSelectionMoveCommand::originalSelectionClone() const
 // public virtual [base kpComand]
 kpCommandSize::SizeType kpToolSelectionMoveCommand::size() const
 {
-    return ImageSize(m_oldDocumentImage) + PolygonSize(m_copyOntoDocumentPoints);
+    SizeType ret = PolygonSize(m_copyOntoDocumentPoints);
+    for (const kpCompressedImage &tile : m_oldDocumentTiles) {
+        ret += ImageSize(tile);
+    }
+
+    return ret;
 }
 
 // public virtual [base kpCommand]
@@ -102,8 +123,15 @@ void kpToolSelectionMoveCommand::unexecute()
 
     vm->setQueueUpdates();
 
-    if (!m_oldDocumentImage.isNull()) {
-        doc->setImageAt(m_oldDocumentImage, m_documentBoundingRect.topLeft());
+    if (!m_oldDocumentTiles.isEmpty()) {
+        // Pixels of the tiles outside <m_documentBoundingRect> were never
+        // changed, so restoring them as well is harmless.
+        kpImage *image = doc->imagePointer();
+        for (auto it = m_oldDocumentTiles.cbegin(); it != m_oldDocumentTiles.cend(); ++it) {
+            kpPixmapFX::setPixmapAt(image, ::TileTopLeft(it.key()), it.value().image());
+        }
+
+        doc->slotContentsChanged(m_documentBoundingRect);
     }
 
 #if DEBUG_KP_TOOL_SELECTION && 1
@@ -116,6 +144,33 @@ void kpToolSelectionMoveCommand::unexecute()
     vm->restoreQueueUpdates();
 }
 
+// public virtual [base kpCommand]
+void kpToolSelectionMoveCommand::compress()
+{
+    for (kpCompressedImage &tile : m_oldDocumentTiles) {
+        tile.compressLater();
+    }
+}
+
+// public virtual [base kpCommand]
+void kpToolSelectionMoveCommand::spill(const std::shared_ptr<kpSpillFile> &file)
+{
+    for (kpCompressedImage &tile : m_oldDocumentTiles) {
+        tile.spillTo(file);
+    }
+}
+
+// public virtual [base kpCommand]
+kpCommandSize::SizeType kpToolSelectionMoveCommand::spilledSize() const
+{
+    SizeType ret = 0;
+    for (const kpCompressedImage &tile : m_oldDocumentTiles) {
+        ret += tile.spilledSize();
+    }
+
+    return ret;
+}
+
 // public
 void kpToolSelectionMoveCommand::moveTo(const QPoint &point, bool moveLater)
 {
@@ -162,11 +217,9 @@ void kpToolSelectionMoveCommand::copyOntoDocument()
     // to be consistent with the requirement on other selection operations.
     Q_ASSERT(sel && sel->hasContent());
 
-    if (m_oldDocumentImage.isNull()) {
-        m_oldDocumentImage = doc->image();
-    }
-
     QRect selBoundingRect = sel->boundingRect();
+    saveOldDocumentTiles(selBoundingRect & doc->rect());
+
     m_documentBoundingRect = m_documentBoundingRect.united(selBoundingRect);
 
     doc->selectionCopyOntoDocument();
@@ -174,10 +227,29 @@ void kpToolSelectionMoveCommand::copyOntoDocument()
     m_copyOntoDocumentPoints.putPoints(m_copyOntoDocumentPoints.count(), 1, selBoundingRect.x(), selBoundingRect.y());
 }
 
-// public
-void kpToolSelectionMoveCommand::finalize()
+// private
+void kpToolSelectionMoveCommand::saveOldDocumentTiles(const QRect &rect)
 {
-    if (!m_oldDocumentImage.isNull() && !m_documentBoundingRect.isNull()) {
-        m_oldDocumentImage = kpTool::neededPixmap(m_oldDocumentImage, m_documentBoundingRect);
+    if (rect.isEmpty()) {
+        return;
     }
+
+    kpDocument *doc = document();
+    Q_ASSERT(doc);
+
+    for (int tileY = rect.top() / TileSize; tileY <= rect.bottom() / TileSize; tileY++) {
+        for (int tileX = rect.left() / TileSize; tileX <= rect.right() / TileSize; tileX++) {
+            const quint64 key = ::TileKey(tileX, tileY);
+            if (m_oldDocumentTiles.contains(key)) {
+                continue;
+            }
+
+            const QRect tileRect = QRect(tileX * TileSize, tileY * TileSize, TileSize, TileSize) & doc->rect();
+            m_oldDocumentTiles.insert(key, doc->getImageAt(tileRect));
+        }
+    }
+
+#if DEBUG_KP_TOOL_SELECTION
+    qCDebug(kpLogCommands) << "kpToolSelectionMoveCommand::saveOldDocumentTiles(" << rect << ") tiles=" << m_oldDocumentTiles.size();
+#endif
 }
@@ -8,12 +8,13 @@
 #ifndef kpToolSelectionMoveCommand_H
 #define kpToolSelectionMoveCommand_H
 
+#include <QHash>
 #include <QPoint>
 #include <QPolygon>
 #include <QRect>
 
 #include "commands/kpNamedCommand.h"
-#include "imagelib/kpImage.h"
+#include "imagelib/kpCompressedImage.h"
 
 class kpAbstractSelection;
 
@@ -30,15 +31,26 @@ public:
     void execute() override;
     void unexecute() override;
 
+    void compress() override;
+    void spill(const std::shared_ptr<kpSpillFile> &file) override;
+    SizeType spilledSize() const override;
+
     void moveTo(const QPoint &point, bool moveLater = false);
     void moveTo(int x, int y, bool moveLater = false);
     void copyOntoDocument();
-    void finalize();
 
 private:
+    // Saves the pixels of the tiles of the document under <rect> that have
+    // not been saved yet.
+    void saveOldDocumentTiles(const QRect &rect);
+
     QPoint m_startPoint, m_endPoint;
 
-    kpImage m_oldDocumentImage;
+    // The pixels of each tile of the document from before the first
+    // copyOntoDocument() that touched it, keyed by ::TileKey().  Only the
+    // tiles under the stamps are kept, so smearing a small selection across
+    // a large document does not copy the whole document.
+    QHash<quint64, kpCompressedImage> m_oldDocumentTiles;
 
     // area of document affected (not the bounding rect of the sel)
     QRect m_documentBoundingRect;
@@ -12,7 +12,7 @@
 #include "layers/selections/text/kpTextSelection.h"
 #include "views/manager/kpViewManager.h"
 
-#include <QList>
+#include <algorithm>
 
 kpToolTextBackspaceCommand::kpToolTextBackspaceCommand(const QString &name, int row, int col, Action action, kpCommandEnvironment *environ)
     : kpNamedCommand(name, environ)
@@ -32,31 +32,27 @@ kpToolTextBackspaceCommand::~kpToolTextBackspaceCommand() = default;
 // public
 void kpToolTextBackspaceCommand::addBackspace()
 {
-    QList<QString> textLines = textSelection()->textLines();
+    kpTextSelection *textSel = textSelection();
 
     if (m_col > 0) {
-        m_deletedText.prepend(textLines[m_row][m_col - 1]);
+        m_deletedText.append(textSel->textLines().at(m_row).at(m_col - 1));
 
-        textLines[m_row] = textLines[m_row].left(m_col - 1) + textLines[m_row].mid(m_col);
+        textSel->deleteText(m_row, m_col - 1, 1);
         m_col--;
     } else {
         if (m_row > 0) {
             int newCursorRow = m_row - 1;
-            int newCursorCol = textLines[newCursorRow].length();
+            int newCursorCol = static_cast<int>(textSel->textLines().at(newCursorRow).length());
 
-            m_deletedText.prepend(QLatin1Char('\n'));
+            m_deletedText.append(QLatin1Char('\n'));
 
-            textLines[newCursorRow] += textLines[m_row];
-
-            textLines.erase(textLines.begin() + m_row);
+            textSel->joinTextLines(newCursorRow);
 
             m_row = newCursorRow;
             m_col = newCursorCol;
         }
     }
 
-    textSelection()->setTextLines(textLines);
-
     viewManager()->setTextCursorPosition(m_row, m_col);
 
     m_numBackspaces++;
@@ -87,29 +83,21 @@ void kpToolTextBackspaceCommand::unexecute()
 {
     viewManager()->setTextCursorPosition(m_row, m_col);
 
-    QList<QString> textLines = textSelection()->textLines();
-
-    for (auto &&i : m_deletedText) {
-        if (i == QLatin1Char('\n')) {
-            const QString rightHalf = textLines[m_row].mid(m_col);
-
-            textLines[m_row].truncate(m_col);
-            textLines.insert(textLines.begin() + m_row + 1, rightHalf);
+    // (m_deletedText is in reverse order)
+    QString text = m_deletedText;
+    std::reverse(text.begin(), text.end());
 
-            m_row++;
-            m_col = 0;
-        } else {
-            const QString leftHalf = textLines[m_row].left(m_col);
-            const QString rightHalf = textLines[m_row].mid(m_col);
+    textSelection()->insertText(m_row, m_col, text);
 
-            textLines[m_row] = leftHalf + i + rightHalf;
-            m_col++;
-        }
+    const int lastNewline = static_cast<int>(text.lastIndexOf(QLatin1Char('\n')));
+    if (lastNewline >= 0) {
+        m_row += static_cast<int>(text.count(QLatin1Char('\n')));
+        m_col = static_cast<int>(text.length()) - (lastNewline + 1);
+    } else {
+        m_col += static_cast<int>(text.length());
     }
 
     m_deletedText.clear();
 
-    textSelection()->setTextLines(textLines);
-
     viewManager()->setTextCursorPosition(m_row, m_col);
 }
@@ -31,6 +31,8 @@ public:
 protected:
     int m_row, m_col;
     int m_numBackspaces;
+    // The deleted text in reverse order, so that each backspace is an
+    // append, not a prepend.
     QString m_deletedText;
 };
 
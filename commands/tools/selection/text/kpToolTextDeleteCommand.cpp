@@ -12,8 +12,6 @@
 #include "layers/selections/text/kpTextSelection.h"
 #include "views/manager/kpViewManager.h"
 
-#include <QList>
-
 kpToolTextDeleteCommand::kpToolTextDeleteCommand(const QString &name, int row, int col, Action action, kpCommandEnvironment *environ)
     : kpNamedCommand(name, environ)
     , m_row(row)
@@ -32,23 +30,23 @@ kpToolTextDeleteCommand::~kpToolTextDeleteCommand() = default;
 // public
 void kpToolTextDeleteCommand::addDelete()
 {
-    QList<QString> textLines = textSelection()->textLines();
+    kpTextSelection *textSel = textSelection();
+
+    // (don't hold onto this, else editing <textSel> would copy all its lines)
+    const QString line = textSel->textLines().at(m_row);
 
-    if (m_col < static_cast<int>(textLines[m_row].length())) {
-        m_deletedText.prepend(textLines[m_row][m_col]);
+    if (m_col < static_cast<int>(line.length())) {
+        m_deletedText.append(line.at(m_col));
 
-        textLines[m_row] = textLines[m_row].left(m_col) + textLines[m_row].mid(m_col + 1);
+        textSel->deleteText(m_row, m_col, 1);
     } else {
-        if (m_row < static_cast<int>(textLines.size() - 1)) {
-            m_deletedText.prepend(QLatin1Char('\n'));
+        if (m_row < static_cast<int>(textSel->textLines().size() - 1)) {
+            m_deletedText.append(QLatin1Char('\n'));
 
-            textLines[m_row] += textLines[m_row + 1];
-            textLines.erase(textLines.begin() + m_row + 1);
+            textSel->joinTextLines(m_row);
         }
     }
 
-    textSelection()->setTextLines(textLines);
-
     viewManager()->setTextCursorPosition(m_row, m_col);
 
     m_numDeletes++;
@@ -79,25 +77,10 @@ void kpToolTextDeleteCommand::unexecute()
 {
     viewManager()->setTextCursorPosition(m_row, m_col);
 
-    QList<QString> textLines = textSelection()->textLines();
-
-    for (auto &&i : m_deletedText) {
-        if (i == QLatin1Char('\n')) {
-            const QString rightHalf = textLines[m_row].mid(m_col);
-
-            textLines[m_row].truncate(m_col);
-            textLines.insert(textLines.begin() + m_row + 1, rightHalf);
-        } else {
-            const QString leftHalf = textLines[m_row].left(m_col);
-            const QString rightHalf = textLines[m_row].mid(m_col);
-
-            textLines[m_row] = leftHalf + i + rightHalf;
-        }
-    }
+    // (the cursor stays where it is, before the restored text)
+    textSelection()->insertText(m_row, m_col, m_deletedText);
 
     m_deletedText.clear();
 
-    textSelection()->setTextLines(textLines);
-
     viewManager()->setTextCursorPosition(m_row, m_col);
 }
@@ -31,6 +31,7 @@ public:
 protected:
     int m_row, m_col;
     int m_numDeletes;
+    // The deleted text, in document order.
     QString m_deletedText;
 };
 
@@ -12,8 +12,6 @@
 #include "layers/selections/text/kpTextSelection.h"
 #include "views/manager/kpViewManager.h"
 
-#include <QList>
-
 kpToolTextEnterCommand::kpToolTextEnterCommand(const QString &name, int row, int col, Action action, kpCommandEnvironment *environ)
     : kpNamedCommand(name, environ)
     , m_row(row)
@@ -32,14 +30,7 @@ kpToolTextEnterCommand::~kpToolTextEnterCommand() = default;
 // public
 void kpToolTextEnterCommand::addEnter()
 {
-    QList<QString> textLines = textSelection()->textLines();
-
-    const QString rightHalf = textLines[m_row].mid(m_col);
-
-    textLines[m_row].truncate(m_col);
-    textLines.insert(textLines.begin() + m_row + 1, rightHalf);
-
-    textSelection()->setTextLines(textLines);
+    textSelection()->splitTextLine(m_row, m_col);
 
     m_row++;
     m_col = 0;
@@ -72,7 +63,7 @@ void kpToolTextEnterCommand::unexecute()
 {
     viewManager()->setTextCursorPosition(m_row, m_col);
 
-    QList<QString> textLines = textSelection()->textLines();
+    kpTextSelection *textSel = textSelection();
 
     for (int i = 0; i < m_numEnters; i++) {
         Q_ASSERT(m_col == 0);
@@ -82,17 +73,13 @@ void kpToolTextEnterCommand::unexecute()
         }
 
         int newRow = m_row - 1;
-        int newCol = textLines[newRow].length();
-
-        textLines[newRow] += textLines[m_row];
+        int newCol = static_cast<int>(textSel->textLines().at(newRow).length());
 
-        textLines.erase(textLines.begin() + m_row);
+        textSel->joinTextLines(newRow);
 
         m_row = newRow;
         m_col = newCol;
     }
 
-    textSelection()->setTextLines(textLines);
-
     viewManager()->setTextCursorPosition(m_row, m_col);
 }
@@ -12,8 +12,6 @@
 #include "layers/selections/text/kpTextSelection.h"
 #include "views/manager/kpViewManager.h"
 
-#include <QList>
-
 //---------------------------------------------------------------------
 
 kpToolTextInsertCommand::kpToolTextInsertCommand(const QString &name, int row, int col, const QString &newText, kpCommandEnvironment *environ)
@@ -34,11 +32,7 @@ void kpToolTextInsertCommand::addText(const QString &moreText)
         return;
     }
 
-    QList<QString> textLines = textSelection()->textLines();
-    const QString leftHalf = textLines[m_row].left(m_col);
-    const QString rightHalf = textLines[m_row].mid(m_col);
-    textLines[m_row] = leftHalf + moreText + rightHalf;
-    textSelection()->setTextLines(textLines);
+    textSelection()->insertText(m_row, m_col, moreText);
 
     m_newText += moreText;
     m_col += moreText.length();
@@ -73,11 +67,7 @@ void kpToolTextInsertCommand::unexecute()
 {
     viewManager()->setTextCursorPosition(m_row, m_col);
 
-    QList<QString> textLines = textSelection()->textLines();
-    const QString leftHalf = textLines[m_row].left(m_col - m_newText.length());
-    const QString rightHalf = textLines[m_row].mid(m_col);
-    textLines[m_row] = leftHalf + rightHalf;
-    textSelection()->setTextLines(textLines);
+    textSelection()->deleteText(m_row, m_col - m_newText.length(), m_newText.length());
 
     m_col -= m_newText.length();
 
@@ -9,8 +9,10 @@
 
 #include "kpEffectsDialog.h"
 
+#include "commands/imagelib/effects/kpEffectCommandBase.h"
 #include "document/kpDocument.h"
 #include "environments/dialogs/imagelib/transforms/kpTransformDialogEnvironment.h"
+#include "imagelib/kpAdjustmentStack.h"
 #include "kpDefs.h"
 #include "pixmapfx/kpPixmapFX.h"
 #include "widgets/imagelib/effects/kpEffectBalanceWidget.h"
@@ -31,8 +33,11 @@
 #include <QImage>
 #include <QLabel>
 #include <QLayout>
+#include <QStandardItemModel>
 #include <QTimer>
 
+#include <memory>
+
 // protected static
 int kpEffectsDialog::s_lastWidth = 640;
 int kpEffectsDialog::s_lastHeight = 620;
@@ -140,6 +145,75 @@ kpEffectCommandBase *kpEffectsDialog::createCommand() const
     return m_effectWidget->createCommand(m_environ->commandEnvironment());
 }
 
+// public static
+bool kpEffectsDialog::EffectCanBeAdjustment(int which)
+{
+    // sync: order in constructor.
+    switch (which) {
+    case 0: // Balance
+    case 4: // Hue, Saturation, Value
+    case 5: // Invert
+    case 7: // Soften & Sharpen
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// public
+void kpEffectsDialog::restrictToAdjustments()
+{
+    auto *model = qobject_cast<QStandardItemModel *>(m_effectsComboBox->model());
+    Q_ASSERT(model);
+
+    for (int i = 0; i < m_effectsComboBox->count(); i++) {
+        model->item(i)->setEnabled(kpEffectsDialog::EffectCanBeAdjustment(i));
+    }
+
+    if (!kpEffectsDialog::EffectCanBeAdjustment(selectedEffect())) {
+        selectEffect(0);
+    }
+}
+
+// public
+void kpEffectsDialog::setSettings(const QVariantList &settings)
+{
+    if (!m_effectWidget) {
+        return;
+    }
+
+    // Update once, rather than for every control changed.
+    m_effectWidget->blockSignals(true);
+    m_effectWidget->setSettings(settings);
+    m_effectWidget->blockSignals(false);
+
+    slotUpdate();
+}
+
+// public
+kpAdjustment kpEffectsDialog::createAdjustment() const
+{
+    kpAdjustment ret;
+
+    if (!m_effectWidget || !kpEffectsDialog::EffectCanBeAdjustment(selectedEffect())) {
+        return ret;
+    }
+
+    ret.name = m_effectsComboBox->currentText();
+    ret.effect = selectedEffect();
+    ret.settings = m_effectWidget->settings();
+
+    // The command is only used to apply the effect, never executed.
+    std::shared_ptr<kpEffectCommandBase> command(m_effectWidget->createCommand(m_environ->commandEnvironment()));
+    ret.margin = command->tileMargin();
+    ret.apply = [command](const kpImage &image) {
+        return command->applyTo(image);
+    };
+
+    return ret;
+}
+
 // protected virtual [base kpTransformPreviewDialog]
 QSize kpEffectsDialog::newDimensions() const
 {
@@ -258,6 +332,8 @@ void kpEffectsDialog::selectEffect(int which)
         qCDebug(kpLogDialogs) << "about to setUpdatesEnabled()";
 #endif
         setUpdatesEnabled(e);
+
+        Q_EMIT settingsChanged();
     }
 
 #if DEBUG_KP_EFFECTS_DIALOG
@@ -276,6 +352,8 @@ void kpEffectsDialog::slotUpdate()
     m_delayedUpdateTimer->stop();
 
     kpTransformPreviewDialog::slotUpdate();
+
+    Q_EMIT settingsChanged();
 }
 
 // protected slot virtual [base kpTransformPreviewDialog]
@@ -10,6 +10,8 @@
 
 #include "dialogs/imagelib/transforms/kpTransformPreviewDialog.h"
 
+#include <QVariantList>
+
 class QComboBox;
 class QGroupBox;
 class QImage;
@@ -18,6 +20,7 @@ class QVBoxLayout;
 
 class kpEffectCommandBase;
 class kpEffectWidgetBase;
+struct kpAdjustment;
 
 class kpEffectsDialog : public kpTransformPreviewDialog
 {
@@ -32,6 +35,27 @@ public:
     bool isNoOp() const override;
     kpEffectCommandBase *createCommand() const;
 
+    // Returns whether effect <which> (as for selectEffect()) can be used as
+    // an adjustment.  That needs it to be applicable to part of an image
+    // (see kpEffectCommandBase::tileMargin()) and its widget to implement
+    // kpEffectWidgetBase::settings().
+    static bool EffectCanBeAdjustment(int which);
+
+    // Disables the effects that cannot be used as adjustments, for editing
+    // an adjustment instead of applying an effect.
+    void restrictToAdjustments();
+
+    // Sets the controls of the selected effect to <settings>, as returned by
+    // kpEffectWidgetBase::settings().
+    void setSettings(const QVariantList &settings);
+
+    kpAdjustment createAdjustment() const;
+
+Q_SIGNALS:
+    // Emitted whenever the preview is updated for new settings or a new
+    // effect.
+    void settingsChanged();
+
 protected:
     QSize newDimensions() const override;
     QImage transformPixmap(const QImage &pixmap, int targetWidth, int targetHeight) const override;
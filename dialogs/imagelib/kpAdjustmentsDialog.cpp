@@ -0,0 +1,246 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_ADJUSTMENTS_DIALOG 0
+
+#include "kpAdjustmentsDialog.h"
+
+#include "dialogs/imagelib/effects/kpEffectsDialog.h"
+#include "document/kpDocument.h"
+#include "environments/dialogs/imagelib/transforms/kpTransformDialogEnvironment.h"
+
+#include "kpLogCategories.h"
+#include <KLocalizedString>
+
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QListWidget>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+struct kpAdjustmentsDialogPrivate {
+    kpTransformDialogEnvironment *environ;
+
+    kpAdjustmentList originalAdjustments;
+    kpAdjustmentList adjustments;
+
+    // Effect last chosen for a new adjustment.
+    int lastEffect;
+
+    QListWidget *listWidget;
+    QPushButton *addButton, *editButton, *removeButton;
+};
+
+kpAdjustmentsDialog::kpAdjustmentsDialog(kpTransformDialogEnvironment *environ, QWidget *parent)
+
+    : QDialog(parent)
+    , d(new kpAdjustmentsDialogPrivate())
+{
+    d->environ = environ;
+
+    d->originalAdjustments = d->adjustments = document()->adjustments();
+    d->lastEffect = 0;
+
+    setWindowTitle(i18nc("@title:window", "Adjustments"));
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+
+    connect(buttons, &QDialogButtonBox::accepted, this, &kpAdjustmentsDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &kpAdjustmentsDialog::reject);
+
+    auto *baseWidget = new QWidget(this);
+
+    auto *dialogLayout = new QVBoxLayout(this);
+    dialogLayout->addWidget(baseWidget);
+    dialogLayout->addWidget(buttons);
+
+    d->listWidget = new QListWidget(baseWidget);
+    d->listWidget->setWhatsThis(
+        i18n("<qt>"
+             "<p>Adjustments are effects that are shown on top of the image"
+             " without changing it, so that they can be edited or removed"
+             " later.  They are applied in order, from top to bottom.</p>"
+
+             "<p>The image is only changed when it is saved, exported or"
+             " printed.</p>"
+             "</qt>"));
+
+    d->addButton = new QPushButton(i18n("&Add..."), baseWidget);
+    d->editButton = new QPushButton(i18n("&Edit..."), baseWidget);
+    d->removeButton = new QPushButton(i18n("&Remove"), baseWidget);
+
+    auto *buttonsLay = new QVBoxLayout();
+    buttonsLay->addWidget(d->addButton);
+    buttonsLay->addWidget(d->editButton);
+    buttonsLay->addWidget(d->removeButton);
+    buttonsLay->addStretch();
+
+    auto *baseLay = new QHBoxLayout(baseWidget);
+    baseLay->setContentsMargins(0, 0, 0, 0);
+    baseLay->addWidget(d->listWidget, 1 /*stretch*/);
+    baseLay->addLayout(buttonsLay);
+
+    connect(d->addButton, &QPushButton::clicked, this, &kpAdjustmentsDialog::slotAdd);
+    connect(d->editButton, &QPushButton::clicked, this, &kpAdjustmentsDialog::slotEdit);
+    connect(d->removeButton, &QPushButton::clicked, this, &kpAdjustmentsDialog::slotRemove);
+
+    connect(d->listWidget, &QListWidget::itemDoubleClicked, this, &kpAdjustmentsDialog::slotEdit);
+    connect(d->listWidget, &QListWidget::currentRowChanged, this, &kpAdjustmentsDialog::slotCurrentRowChanged);
+
+    updateList();
+}
+
+kpAdjustmentsDialog::~kpAdjustmentsDialog()
+{
+    delete d;
+}
+
+// public
+bool kpAdjustmentsDialog::isNoOp() const
+{
+    if (d->adjustments.size() != d->originalAdjustments.size()) {
+        return false;
+    }
+
+    for (int i = 0; i < d->adjustments.size(); i++) {
+        if (d->adjustments[i].key() != d->originalAdjustments[i].key()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// public
+kpAdjustmentList kpAdjustmentsDialog::originalAdjustments() const
+{
+    return d->originalAdjustments;
+}
+
+// public
+kpAdjustmentList kpAdjustmentsDialog::adjustments() const
+{
+    return d->adjustments;
+}
+
+// private
+kpDocument *kpAdjustmentsDialog::document() const
+{
+    kpDocument *doc = d->environ->document();
+    Q_ASSERT(doc);
+
+    return doc;
+}
+
+// private
+void kpAdjustmentsDialog::updateList()
+{
+    const int row = d->listWidget->currentRow();
+
+    d->listWidget->clear();
+    for (const kpAdjustment &adjustment : std::as_const(d->adjustments)) {
+        d->listWidget->addItem(adjustment.name);
+    }
+
+    d->listWidget->setCurrentRow(qMin(row, d->listWidget->count() - 1));
+    slotCurrentRowChanged();
+}
+
+// private
+void kpAdjustmentsDialog::editAdjustment(int row)
+{
+    const int effect = (row >= 0) ? d->adjustments[row].effect : d->lastEffect;
+
+    kpEffectsDialog dialog(false /*act on image, not selection*/, d->environ, this, effect);
+    dialog.restrictToAdjustments();
+    if (row >= 0) {
+        dialog.setSettings(d->adjustments[row].settings);
+    }
+
+    // Returns adjustments() with the one being edited as in <dialog>.
+    const auto adjustmentsWithDialog = [this, &dialog, row] {
+        kpAdjustmentList ret = d->adjustments;
+        if (row >= 0) {
+            ret.removeAt(row);
+        }
+
+        if (!dialog.isNoOp()) {
+            ret.insert((row >= 0) ? row : ret.size(), dialog.createAdjustment());
+        }
+
+        return ret;
+    };
+
+    // Show the adjustment in the document as it is being edited: only the
+    // visible tiles of the document are reevaluated.
+    connect(&dialog, &kpEffectsDialog::settingsChanged, this, [this, &adjustmentsWithDialog] {
+        document()->setAdjustments(adjustmentsWithDialog());
+    });
+
+    if (dialog.exec()) {
+        d->adjustments = adjustmentsWithDialog();
+        if (row < 0) {
+            d->lastEffect = dialog.selectedEffect();
+        }
+    }
+
+#if DEBUG_KP_ADJUSTMENTS_DIALOG
+    qCDebug(kpLogDialogs) << "kpAdjustmentsDialog::editAdjustment(" << row << ") ->" << d->adjustments.size() << "adjustments";
+#endif
+
+    document()->setAdjustments(d->adjustments);
+    updateList();
+}
+
+// private slot
+void kpAdjustmentsDialog::slotAdd()
+{
+    editAdjustment(-1);
+    d->listWidget->setCurrentRow(d->listWidget->count() - 1);
+}
+
+// private slot
+void kpAdjustmentsDialog::slotEdit()
+{
+    const int row = d->listWidget->currentRow();
+    if (row < 0) {
+        return;
+    }
+
+    editAdjustment(row);
+}
+
+// private slot
+void kpAdjustmentsDialog::slotRemove()
+{
+    const int row = d->listWidget->currentRow();
+    if (row < 0) {
+        return;
+    }
+
+    d->adjustments.removeAt(row);
+    document()->setAdjustments(d->adjustments);
+
+    updateList();
+}
+
+// private slot
+void kpAdjustmentsDialog::slotCurrentRowChanged()
+{
+    const bool haveCurrent = (d->listWidget->currentRow() >= 0);
+    d->editButton->setEnabled(haveCurrent);
+    d->removeButton->setEnabled(haveCurrent);
+}
+
+// public slot virtual [base QDialog]
+void kpAdjustmentsDialog::reject()
+{
+    d->adjustments = d->originalAdjustments;
+    document()->setAdjustments(d->originalAdjustments);
+
+    QDialog::reject();
+}
+
+#include "moc_kpAdjustmentsDialog.cpp"
@@ -0,0 +1,61 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpAdjustmentsDialog_H
+#define kpAdjustmentsDialog_H
+
+#include <QDialog>
+
+#include "imagelib/kpAdjustmentStack.h"
+
+class kpDocument;
+class kpTransformDialogEnvironment;
+
+// Dialog for editing the document's adjustments (see
+// kpDocument::adjustments()).  Adjustments are added and edited with
+// kpEffectsDialog.
+//
+// Every change, including each change to the settings of an adjustment
+// being edited, is shown in the document straight away.  After exec(),
+// the document is left with adjustments() if accepted, or
+// originalAdjustments() if rejected.
+class kpAdjustmentsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    kpAdjustmentsDialog(kpTransformDialogEnvironment *environ, QWidget *parent);
+    ~kpAdjustmentsDialog() override;
+
+    bool isNoOp() const;
+
+    kpAdjustmentList originalAdjustments() const;
+    kpAdjustmentList adjustments() const;
+
+public Q_SLOTS:
+    // Restores originalAdjustments().
+    void reject() override;
+
+private:
+    kpDocument *document() const;
+
+    void updateList();
+
+    // Opens a kpEffectsDialog for the adjustment at <row> of adjustments(),
+    // or a new adjustment if <row> is -1.
+    void editAdjustment(int row);
+
+private Q_SLOTS:
+    void slotAdd();
+    void slotEdit();
+    void slotRemove();
+    void slotCurrentRowChanged();
+
+private:
+    struct kpAdjustmentsDialogPrivate *const d;
+};
+
+#endif // kpAdjustmentsDialog_H
@@ -23,6 +23,7 @@
 #include "environments/dialogs/imagelib/transforms/kpTransformDialogEnvironment.h"
 #include "generic/widgets/kpResizeSignallingLabel.h"
 #include "imagelib/kpColor.h"
+#include "imagelib/kpResampler.h"
 #include "layers/selections/image/kpAbstractImageSelection.h"
 #include "pixmapfx/kpPixmapFX.h"
 
@@ -257,9 +258,11 @@ void kpTransformPreviewDialog::updateShrunkenDocumentPixmap()
             image = doc->image();
         }
 
-        m_shrunkenDocumentPixmap = kpPixmapFX::scale(image,
-                                                     scaleDimension(m_oldWidth, keepsAspectScale, 1, m_previewPixmapLabel->width()),
-                                                     scaleDimension(m_oldHeight, keepsAspectScale, 1, m_previewPixmapLabel->height()));
+        // (averaged, rather than sampled, so that fine detail does not alias)
+        m_shrunkenDocumentPixmap = kpResampler::scale(image,
+                                                      scaleDimension(m_oldWidth, keepsAspectScale, 1, m_previewPixmapLabel->width()),
+                                                      scaleDimension(m_oldHeight, keepsAspectScale, 1, m_previewPixmapLabel->height()),
+                                                      kpResampler::Box);
 
         m_previewPixmapLabelSizeWhenUpdatedPixmap = m_previewPixmapLabel->size();
     }
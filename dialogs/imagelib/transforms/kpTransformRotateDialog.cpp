@@ -196,7 +196,11 @@ QSize kpTransformRotateDialog::newDimensions() const
 // private virtual [base kpTransformPreviewDialog]
 QImage kpTransformRotateDialog::transformPixmap(const QImage &image, int targetWidth, int targetHeight) const
 {
-    return kpPixmapFX::rotate(image, angle(), m_environ->backgroundColor(m_actOnSelection), targetWidth, targetHeight);
+    // Interpolate only if the preview is shrunk, so that it does not look
+    // any blurrier than the result.
+    const bool pretty = (targetWidth > 0 && targetWidth < newDimensions().width());
+
+    return kpPixmapFX::rotate(image, angle(), m_environ->backgroundColor(m_actOnSelection), targetWidth, targetHeight, pretty);
 }
 
 // private slot
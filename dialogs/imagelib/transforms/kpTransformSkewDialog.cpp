@@ -123,12 +123,16 @@ QSize kpTransformSkewDialog::newDimensions() const
 // private virtual [base kpTransformPreviewDialog]
 QImage kpTransformSkewDialog::transformPixmap(const QImage &image, int targetWidth, int targetHeight) const
 {
+    // (sync: kpTransformRotateDialog::transformPixmap())
+    const bool pretty = (targetWidth > 0 && targetWidth < newDimensions().width());
+
     return kpPixmapFX::skew(image,
                             horizontalAngleForPixmapFX(),
                             verticalAngleForPixmapFX(),
                             m_environ->backgroundColor(m_actOnSelection),
                             targetWidth,
-                            targetHeight);
+                            targetHeight,
+                            pretty);
 }
 
 // private
@@ -0,0 +1,55 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "kpDocumentOpenProgressDialog.h"
+
+#include <KLocalizedString>
+
+#include <QDialogButtonBox>
+#include <QImage>
+#include <QLabel>
+#include <QPixmap>
+#include <QProgressBar>
+#include <QVBoxLayout>
+
+kpDocumentOpenProgressDialog::kpDocumentOpenProgressDialog(const QString &prettyFilename, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(i18nc("@title:window", "Opening Image"));
+    setModal(true);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Cancel, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &kpDocumentOpenProgressDialog::reject);
+
+    auto *messageLabel = new QLabel(i18n("Opening \"%1\"...", prettyFilename), this);
+    messageLabel->setWordWrap(true);
+
+    // Empty until setPreview() - reserve the space so that the dialog
+    // does not jump around when the preview arrives.
+    m_previewLabel = new QLabel(this);
+    m_previewLabel->setAlignment(Qt::AlignCenter);
+    m_previewLabel->setMinimumSize(256, 256);
+
+    // Decoders do not report progress, so just show that we are busy.
+    auto *progressBar = new QProgressBar(this);
+    progressBar->setRange(0, 0);
+
+    auto *dialogLayout = new QVBoxLayout(this);
+    dialogLayout->addWidget(messageLabel);
+    dialogLayout->addWidget(m_previewLabel, 1 /*stretch*/);
+    dialogLayout->addWidget(progressBar);
+    dialogLayout->addWidget(buttons);
+}
+
+kpDocumentOpenProgressDialog::~kpDocumentOpenProgressDialog() = default;
+
+// public slot
+void kpDocumentOpenProgressDialog::setPreview(const QImage &preview)
+{
+    m_previewLabel->setPixmap(QPixmap::fromImage(preview));
+}
+
+#include "moc_kpDocumentOpenProgressDialog.cpp"
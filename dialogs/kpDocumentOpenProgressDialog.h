@@ -0,0 +1,35 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef KP_DOCUMENT_OPEN_PROGRESS_DIALOG_H
+#define KP_DOCUMENT_OPEN_PROGRESS_DIALOG_H
+
+#include <QDialog>
+
+class QImage;
+class QLabel;
+
+//
+// Shown while a large image is being decoded by kpDocumentLoader.
+// Displays a downscaled preview of the image, if one is available, and
+// lets the user cancel (which emits rejected()).
+//
+class kpDocumentOpenProgressDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    kpDocumentOpenProgressDialog(const QString &prettyFilename, QWidget *parent);
+    ~kpDocumentOpenProgressDialog() override;
+
+public Q_SLOTS:
+    void setPreview(const QImage &preview);
+
+private:
+    QLabel *m_previewLabel;
+};
+
+#endif // KP_DOCUMENT_OPEN_PROGRESS_DIALOG_H
@@ -192,6 +192,10 @@ void kpDocument::setMetaInfo(const kpDocumentMetaInfo &metaInfo)
 
 void kpDocument::setModified(bool yes)
 {
+    if (yes) {
+        d->changeCount++;
+    }
+
     if (yes == m_modified) {
         return;
     }
@@ -330,6 +334,55 @@ kpImage *kpDocument::imagePointer() const
 
 //---------------------------------------------------------------------
 
+// public
+kpFloodFillIndex *kpDocument::floodFillIndex() const
+{
+    return &d->floodFillIndex;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpAdjustmentList kpDocument::adjustments() const
+{
+    return d->adjustmentStack.adjustments();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocument::setAdjustments(const kpAdjustmentList &adjustments)
+{
+    d->adjustmentStack.setAdjustments(adjustments);
+
+    Q_EMIT adjustmentsChanged(m_image->rect());
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpImage kpDocument::getAdjustedImageAt(const QRect &rect) const
+{
+    if (d->adjustmentStack.isEmpty()) {
+        return getImageAt(rect);
+    }
+
+    // (sync: kpPixmapFX::getPixmapAt() for the parts of <rect> outside the
+    //  image)
+    const QRect imageRect = rect & m_image->rect();
+    if (imageRect == rect) {
+        return d->adjustmentStack.imageAt(*m_image, rect);
+    }
+
+    kpImage ret = getImageAt(rect);
+    if (!imageRect.isEmpty()) {
+        kpPixmapFX::setPixmapAt(&ret, imageRect.topLeft() - rect.topLeft(), d->adjustmentStack.imageAt(*m_image, imageRect));
+    }
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
 // public
 void kpDocument::setImage(const kpImage &image)
 {
@@ -376,6 +429,18 @@ void kpDocument::fill(const kpColor &color)
 
 //---------------------------------------------------------------------
 
+void kpDocument::flip(bool horiz, bool vert)
+{
+#if DEBUG_KP_DOCUMENT
+    qCDebug(kpLogDocument) << "kpDocument::flip (horiz=" << horiz << ",vert=" << vert << ")";
+#endif
+
+    kpPixmapFX::flip(m_image, horiz, vert);
+    slotContentsChanged(m_image->rect());
+}
+
+//---------------------------------------------------------------------
+
 void kpDocument::resize(int w, int h, const kpColor &backgroundColor)
 {
 #if DEBUG_KP_DOCUMENT
@@ -402,14 +467,24 @@ void kpDocument::resize(int w, int h, const kpColor &backgroundColor)
 
 void kpDocument::slotContentsChanged(const QRect &rect)
 {
+    d->floodFillIndex.imageChanged(*m_image, rect);
+    const QRect adjustedRect = d->adjustmentStack.imageChanged(rect) & m_image->rect();
+
     setModified();
     Q_EMIT contentsChanged(rect);
+
+    if (!rect.contains(adjustedRect)) {
+        Q_EMIT adjustmentsChanged(adjustedRect);
+    }
 }
 
 //---------------------------------------------------------------------
 
 void kpDocument::slotSizeChanged(const QSize &newSize)
 {
+    d->floodFillIndex.imageChanged(*m_image, m_image->rect());
+    d->adjustmentStack.imageChanged(m_image->rect());
+
     setModified();
     Q_EMIT sizeChanged(newSize.width(), newSize.height());
     Q_EMIT sizeChanged(newSize);
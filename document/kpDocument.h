@@ -12,6 +12,7 @@
 #include <QString>
 #include <QUrl>
 
+#include "imagelib/kpAdjustmentStack.h"
 #include "imagelib/kpImage.h"
 #include "pixmapfx/kpPixmapFX.h"
 #undef environ
@@ -26,6 +27,7 @@ class kpColor;
 class kpDocumentEnvironment;
 class kpDocumentSaveOptions;
 class kpDocumentMetaInfo;
+class kpFloodFillIndex;
 class kpAbstractImageSelection;
 class kpAbstractSelection;
 class kpTextSelection;
@@ -58,7 +60,8 @@ public:
                                     bool suppressDoesntExistDialog,
                                     QWidget *parent,
                                     kpDocumentSaveOptions *saveOptions = nullptr,
-                                    kpDocumentMetaInfo *metaInfo = nullptr);
+                                    kpDocumentMetaInfo *metaInfo = nullptr,
+                                    bool *userCancelled = nullptr);
     // REFACTOR: fix: open*() should only be called once.
     //                Create a new kpDocument() if you want to open again.
     void openNew(const QUrl &url);
@@ -71,6 +74,8 @@ public:
     //
 
     static bool lossyPromptContinue(const QImage &pixmap, const kpDocumentSaveOptions &saveOptions, QWidget *parent);
+    // <lossyType> is as returned by kpDocumentSaveOptions::isLossyForSaving().
+    static bool lossyTypePromptContinue(int lossyType, const kpDocumentSaveOptions &saveOptions, QWidget *parent);
     static bool savePixmapToDevice(const QImage &pixmap,
                                    QIODevice *device,
                                    const kpDocumentSaveOptions &saveOptions,
@@ -87,6 +92,21 @@ public:
     bool save(bool lossyPrompt = false);
     bool saveAs(const QUrl &url, const kpDocumentSaveOptions &saveOptions, bool lossyPrompt = true);
 
+    // Like save() and saveAs() but only take a snapshot of the document
+    // and then return, leaving a kpDocumentSaver to write the snapshot
+    // on a worker thread while the user continues editing.
+    //
+    // Returns whether the save was started (or, for remote URLs, which
+    // are saved synchronously, whether it succeeded).  The result is
+    // reported by backgroundSaveFinished() and, if the document was not
+    // changed in the meantime, documentSaved().
+    bool saveInBackground(bool lossyPrompt = false);
+    bool saveAsInBackground(const QUrl &url, const kpDocumentSaveOptions &saveOptions, bool lossyPrompt = true);
+
+    bool isSavingInBackground() const;
+    // Runs a local event loop until any background save has finished.
+    void waitForBackgroundSave();
+
     // Returns whether save() or saveAs() have ever been called and returned true
     bool savedAtLeastOnceBefore() const;
 
@@ -167,11 +187,33 @@ public:
     kpImage image(bool ofSelection = false) const;
     kpImage *imagePointer() const;
 
+    // Index of the regions of imagePointer() for exact-match flood fills,
+    // kept up to date by slotContentsChanged() and slotSizeChanged().
+    kpFloodFillIndex *floodFillIndex() const;
+
     void setImage(const kpImage &image);
     // ASSUMPTION: If setting the selection's image, the selection must be
     //             an image selection.
     void setImage(bool ofSelection, const kpImage &image);
 
+    //
+    // Adjustments
+    //
+    // Effects shown on top of the document's image without changing it
+    // (see kpAdjustmentStack).  They are only applied to the image when it
+    // leaves KolourPaint: see flattenedImage().
+    //
+
+    kpAdjustmentList adjustments() const;
+    // Emits adjustmentsChanged().  Does not mark the document as modified,
+    // so that adjustments can be previewed (kpAdjustmentsCommand does).
+    void setAdjustments(const kpAdjustmentList &adjustments);
+
+    // Same as getImageAt() but with the adjustments applied, for display.
+    // Only the tiles of <rect> that have changed since the last call are
+    // evaluated.
+    kpImage getAdjustedImageAt(const QRect &rect) const;
+
     //
     // Selections
     //
@@ -262,6 +304,14 @@ public:
     //
     kpImage imageWithSelection() const;
 
+    // Returns the part of imageWithSelection() given by <rect>, without
+    // copying the rest of the document's image.
+    kpImage imageWithSelectionAt(const QRect &rect) const;
+
+    // Returns imageWithSelection() with the adjustments applied, which is
+    // what gets saved, exported and printed.
+    kpImage flattenedImage() const;
+
     /*
      * Transformations
      * (convenience only - you could achieve the same effect (and more) with
@@ -270,16 +320,25 @@ public:
 
     void fill(const kpColor &color);
     void resize(int w, int h, const kpColor &backgroundColor);
+    void flip(bool horiz, bool vert);
 
 public Q_SLOTS:
     // these will emit signals!
     void slotContentsChanged(const QRect &rect);
     void slotSizeChanged(const QSize &newSize);
 
+private Q_SLOTS:
+    void slotBackgroundSaveFinished(bool success);
+
 Q_SIGNALS:
     void documentOpened();
     void documentSaved();
 
+    void backgroundSaveStarted(const QUrl &url);
+    void backgroundSaveProgress(int percent);
+    // Emitted after documentSaved() (if that is emitted at all).
+    void backgroundSaveFinished(const QUrl &url, bool success);
+
     // Emitted whenever the isModified() flag changes from false to true.
     // This is the _only_ signal that may be emitted in addition to the others.
     void documentModified();
@@ -288,6 +347,11 @@ Q_SIGNALS:
     void sizeChanged(int newWidth, int newHeight); // see oldWidth(), oldHeight()
     void sizeChanged(const QSize &newSize);
 
+    // Emitted when what getAdjustedImageAt() returns changes at <rect>
+    // other than as reported by contentsChanged() (e.g. the adjustments
+    // were changed, or they spread a change to the image's pixels).
+    void adjustmentsChanged(const QRect &rect);
+
     void selectionEnabled(bool on);
 
     // Emitted when setSelection() is given a selection such that we change
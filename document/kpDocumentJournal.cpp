@@ -0,0 +1,506 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_DOCUMENT_JOURNAL 0
+
+#include "document/kpDocumentJournal.h"
+
+#include "document/kpDocument.h"
+#include "document/kpDocumentSaveOptions.h"
+#include "generic/kpDamageRegion.h"
+#include "imagelib/kpDocumentMetaInfo.h"
+#include "pixmapfx/kpPixmapFX.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QUrl>
+#include <QUuid>
+
+#include <KLocalizedString>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+static const quint32 Magic = 0x4b504a31; // "KPJ1"
+
+enum RecordType : quint32 {
+    // The document as last saved: QUrl url, QDateTime lastModified,
+    // qint64 fileSize.
+    BaseUrlRecord = 1,
+
+    // Pixels of the document: QSize documentSize, QRect rect,
+    // QByteArray qCompress()ed rows of premultiplied ARGB32 pixels.
+    PatchRecord = 2
+};
+
+// Once the patches written add up to this many times the size of the
+// document, the journal starts over from the whole document.
+static const int CompactFactor = 2;
+
+//---------------------------------------------------------------------
+
+// Shared between the journal and its writer, so that records already
+// queued are still written while the journal is being destroyed.
+struct kpDocumentJournalState {
+    QFile file;
+    // (also read by the journal)
+    std::atomic<bool> failed{false};
+};
+
+struct kpDocumentJournalPrivate {
+    kpDocument *document = nullptr;
+
+    QString path;
+    std::unique_ptr<QLockFile> lock;
+    std::shared_ptr<kpDocumentJournalState> state;
+
+    // Single thread, so that records are written in the order queued.
+    QThreadPool writer;
+
+    kpDamageRegion dirty;
+    qint64 bytesSinceRestart = 0;
+};
+
+//---------------------------------------------------------------------
+
+static QString RecoveryDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QLatin1String("/recovery");
+}
+
+//---------------------------------------------------------------------
+
+static QString LockPath(const QString &path)
+{
+    return path + QLatin1String(".lock");
+}
+
+//---------------------------------------------------------------------
+
+// Runs on the writer.
+static void WriteRecord(kpDocumentJournalState *state, quint32 type, const QByteArray &payload)
+{
+    if (state->failed) {
+        return;
+    }
+
+    QDataStream stream(&state->file);
+    stream << type << quint64(payload.size());
+
+    // Flushed to the OS (which survives KolourPaint crashing), but not
+    // synced to disk, which would make every edit wait for the disk.
+    if (stream.writeRawData(payload.constData(), int(payload.size())) != payload.size() || !state->file.flush()) {
+        qCWarning(kpLogDocument) << "kpDocumentJournal: could not write to" << state->file.fileName() << ":" << state->file.errorString();
+        state->failed = true;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Runs on the writer.
+static QByteArray EncodePatch(const QSize &documentSize, const QRect &rect, const kpImage &image)
+{
+    const QImage argb = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    const int rowBytes = argb.width() * 4;
+    QByteArray rows(qsizetype(rowBytes) * argb.height(), Qt::Uninitialized);
+    for (int y = 0; y < argb.height(); y++) {
+        std::memcpy(rows.data() + qsizetype(y) * rowBytes, argb.constScanLine(y), rowBytes);
+    }
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << documentSize << rect << qCompress(rows, 1);
+    return payload;
+}
+
+//---------------------------------------------------------------------
+
+// Reverses ::EncodePatch(), painting it onto <*image>.
+static bool ApplyPatch(const QByteArray &payload, kpImage *image)
+{
+    QDataStream stream(payload);
+
+    QSize documentSize;
+    QRect rect;
+    QByteArray compressedRows;
+    stream >> documentSize >> rect >> compressedRows;
+
+    if (stream.status() != QDataStream::Ok || documentSize.isEmpty() || !QRect(QPoint(0, 0), documentSize).contains(rect)) {
+        return false;
+    }
+
+    const QByteArray rows = qUncompress(compressedRows);
+    const int rowBytes = rect.width() * 4;
+    if (rows.size() != qsizetype(rowBytes) * rect.height()) {
+        return false;
+    }
+
+    if (image->size() != documentSize) {
+        kpImage resized(documentSize, QImage::Format_ARGB32_Premultiplied);
+        resized.fill(0);
+        if (!image->isNull()) {
+            kpPixmapFX::setPixmapAt(&resized, QPoint(0, 0), *image);
+        }
+        *image = resized;
+    }
+
+    QImage patch(rect.size(), QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < rect.height(); y++) {
+        std::memcpy(patch.scanLine(y), rows.constData() + qsizetype(y) * rowBytes, rowBytes);
+    }
+
+    kpPixmapFX::setPixmapAt(image, rect.topLeft(), patch);
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// Calls <handle>(type, payload) for each complete record of the journal at
+// <path>, stopping at the first incomplete one (e.g. the one being written
+// when KolourPaint crashed) or when <handle> returns false.
+template<typename Handler>
+static bool ReadRecords(const QString &path, Handler handle)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+
+    quint32 magic = 0;
+    stream >> magic;
+    if (magic != Magic) {
+        return false;
+    }
+
+    while (!stream.atEnd()) {
+        quint32 type = 0;
+        quint64 size = 0;
+        stream >> type >> size;
+
+        if (stream.status() != QDataStream::Ok || size > quint64(file.bytesAvailable())) {
+            break;
+        }
+
+        QByteArray payload(qsizetype(size), Qt::Uninitialized);
+        if (stream.readRawData(payload.data(), int(size)) != int(size)) {
+            break;
+        }
+
+        if (!handle(type, payload)) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+kpDocumentJournal::kpDocumentJournal(kpDocument *document, QObject *parent)
+    : QObject(parent)
+    , d(new kpDocumentJournalPrivate())
+{
+    Q_ASSERT(document);
+    d->document = document;
+
+    d->state = std::make_shared<kpDocumentJournalState>();
+    d->writer.setMaxThreadCount(1);
+
+    const QString dir = ::RecoveryDirectory();
+    if (!QDir().mkpath(dir)) {
+        qCWarning(kpLogDocument) << "kpDocumentJournal: could not create" << dir;
+        d->state->failed = true;
+        return;
+    }
+
+    d->path = dir + QLatin1Char('/') + QUuid::createUuid().toString(QUuid::WithoutBraces) + QLatin1String(".kpjournal");
+
+    // Held for as long as the journal is in use, so that OrphanedJournals()
+    // can tell it apart from the journal of a crashed KolourPaint.
+    d->lock = std::make_unique<QLockFile>(::LockPath(d->path));
+    d->lock->setStaleLockTime(0);
+    if (!d->lock->tryLock(0)) {
+        qCWarning(kpLogDocument) << "kpDocumentJournal: could not lock" << d->path;
+        d->state->failed = true;
+        return;
+    }
+
+    d->state->file.setFileName(d->path);
+
+#if DEBUG_KP_DOCUMENT_JOURNAL
+    qCDebug(kpLogDocument) << "kpDocumentJournal: journaling to" << d->path;
+#endif
+
+    connect(d->document, &kpDocument::contentsChanged, this, &kpDocumentJournal::slotContentsChanged);
+    connect(d->document, static_cast<void (kpDocument::*)(const QSize &)>(&kpDocument::sizeChanged), this, &kpDocumentJournal::slotSizeChanged);
+    connect(d->document, &kpDocument::documentSaved, this, &kpDocumentJournal::restart);
+
+    restart();
+}
+
+//---------------------------------------------------------------------
+
+kpDocumentJournal::~kpDocumentJournal()
+{
+    d->writer.waitForDone();
+
+    if (d->lock && d->lock->isLocked()) {
+        d->state->file.close();
+        QFile::remove(d->path);
+        d->lock->unlock();
+    }
+
+    delete d;
+}
+
+//---------------------------------------------------------------------
+
+// public slot
+void kpDocumentJournal::flush()
+{
+    if (d->state->failed || d->dirty.isEmpty()) {
+        return;
+    }
+
+    const QRect documentRect = d->document->rect();
+    const qint64 documentBytes = qint64(documentRect.width()) * documentRect.height() * 4;
+
+    // The patches cost more to replay than the whole document would.
+    if (d->bytesSinceRestart > documentBytes * CompactFactor) {
+#if DEBUG_KP_DOCUMENT_JOURNAL
+        qCDebug(kpLogDocument) << "kpDocumentJournal::flush() compacting after" << d->bytesSinceRestart << "bytes";
+#endif
+        restart();
+        return;
+    }
+
+    const QList<QRect> rects = d->dirty.rects();
+    d->dirty.clear();
+
+    for (const QRect &dirtyRect : rects) {
+        const QRect rect = dirtyRect & documentRect;
+        if (rect.isEmpty()) {
+            continue;
+        }
+
+#if DEBUG_KP_DOCUMENT_JOURNAL
+        qCDebug(kpLogDocument) << "kpDocumentJournal::flush() rect=" << rect;
+#endif
+
+        // Only the copy happens here: encoding and writing are left to the
+        // writer.
+        const kpImage image = d->document->getImageAt(rect);
+        const QSize documentSize = documentRect.size();
+
+        std::shared_ptr<kpDocumentJournalState> state = d->state;
+        d->writer.start([state, documentSize, rect, image] {
+            ::WriteRecord(state.get(), PatchRecord, ::EncodePatch(documentSize, rect, image));
+        });
+
+        d->bytesSinceRestart += qint64(rect.width()) * rect.height() * 4;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpDocumentJournal::slotContentsChanged(const QRect &rect)
+{
+    d->dirty.add(rect);
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpDocumentJournal::slotSizeChanged(const QSize &size)
+{
+    d->dirty.add(QRect(QPoint(0, 0), size));
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpDocumentJournal::restart()
+{
+    if (!d->lock || !d->lock->isLocked()) {
+        return;
+    }
+
+    d->dirty.clear();
+    d->bytesSinceRestart = 0;
+
+    // Only refer to the file if reading it back gives exactly the
+    // document's image: it was opened from it, or saved to it losslessly,
+    // the selection (which the file includes) is not floating, and there
+    // are no adjustments (which the file has flattened in, but the patches
+    // recorded after it would not).
+    const kpDocument *doc = d->document;
+    const QUrl url = doc->url();
+    bool useUrl = url.isLocalFile() && doc->isFromExistingURL() && !doc->isModified() && !doc->selection() && doc->adjustments().isEmpty();
+    if (useUrl && doc->savedAtLeastOnceBefore()) {
+        useUrl = doc->saveOptions()->isLossyForSaving(doc->image()) == kpDocumentSaveOptions::LossLess;
+    }
+
+    QByteArray base;
+    quint32 baseType;
+    QRect rect;
+    kpImage image;
+    if (useUrl) {
+        const QFileInfo info(url.toLocalFile());
+        QDataStream stream(&base, QIODevice::WriteOnly);
+        stream << url << info.lastModified() << qint64(info.size());
+        baseType = BaseUrlRecord;
+    } else {
+        rect = doc->rect();
+        image = doc->image();
+        baseType = PatchRecord;
+    }
+
+#if DEBUG_KP_DOCUMENT_JOURNAL
+    qCDebug(kpLogDocument) << "kpDocumentJournal::restart() useUrl=" << useUrl << "url=" << url;
+#endif
+
+    std::shared_ptr<kpDocumentJournalState> state = d->state;
+    d->writer.start([state, baseType, base, rect, image] {
+        state->file.close();
+        if (!state->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCWarning(kpLogDocument) << "kpDocumentJournal: could not open" << state->file.fileName() << ":" << state->file.errorString();
+            state->failed = true;
+            return;
+        }
+        state->failed = false;
+
+        QDataStream(&state->file) << Magic;
+        ::WriteRecord(state.get(), baseType, baseType == PatchRecord ? ::EncodePatch(rect.size(), rect, image) : base);
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QStringList kpDocumentJournal::OrphanedJournals()
+{
+    QStringList ret;
+
+    const QDir dir(::RecoveryDirectory());
+    const QStringList names = dir.entryList(QStringList(QStringLiteral("*.kpjournal")), QDir::Files, QDir::Time);
+    for (const QString &name : names) {
+        const QString path = dir.filePath(name);
+
+        // Still locked by a running KolourPaint?
+        QLockFile lock(::LockPath(path));
+        lock.setStaleLockTime(0);
+        if (!lock.tryLock(0)) {
+            continue;
+        }
+        lock.unlock();
+
+        ret.append(path);
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QString kpDocumentJournal::Description(const QString &path)
+{
+    QUrl url;
+    ::ReadRecords(path, [&url](quint32 type, const QByteArray &payload) {
+        if (type == BaseUrlRecord) {
+            QDataStream(payload) >> url;
+        }
+        return false;
+    });
+
+    return url.isEmpty() ? i18n("Untitled") : url.fileName();
+}
+
+//---------------------------------------------------------------------
+
+// public static
+kpDocument *kpDocumentJournal::Recover(const QString &path, kpDocumentEnvironment *environ, QWidget *parent)
+{
+#if DEBUG_KP_DOCUMENT_JOURNAL
+    qCDebug(kpLogDocument) << "kpDocumentJournal::Recover(" << path << ")";
+#endif
+
+    kpImage image;
+    QUrl url;
+    kpDocumentSaveOptions saveOptions;
+    kpDocumentMetaInfo metaInfo;
+
+    ::ReadRecords(path, [&](quint32 type, const QByteArray &payload) {
+        switch (type) {
+        case BaseUrlRecord: {
+            QDateTime lastModified;
+            qint64 fileSize = 0;
+            QDataStream(payload) >> url >> lastModified >> fileSize;
+
+            // The edits only make sense on top of the file as it was.
+            const QFileInfo info(url.toLocalFile());
+            if (info.lastModified() != lastModified || info.size() != fileSize) {
+                qCWarning(kpLogDocument) << "kpDocumentJournal: " << url << "has changed since it was journaled";
+                url.clear();
+                return false;
+            }
+
+            image = kpDocument::getPixmapFromFile(url, true /*suppress "doesn't exist" dialog*/, parent, &saveOptions, &metaInfo);
+            return !image.isNull();
+        }
+
+        case PatchRecord:
+            return ::ApplyPatch(payload, &image);
+
+        default:
+            qCWarning(kpLogDocument) << "kpDocumentJournal: unknown record type" << type;
+            return false;
+        }
+    });
+
+    if (image.isNull()) {
+        return nullptr;
+    }
+
+    auto *doc = new kpDocument(image.width(), image.height(), environ);
+    doc->setImage(image);
+    if (!url.isEmpty()) {
+        doc->setURL(url, true /*is from url*/);
+        doc->setSaveOptions(saveOptions);
+        doc->setMetaInfo(metaInfo);
+    }
+    doc->setModified(true);
+
+    return doc;
+}
+
+//---------------------------------------------------------------------
+
+// public static
+void kpDocumentJournal::Remove(const QString &path)
+{
+    QFile::remove(path);
+    QFile::remove(::LockPath(path));
+}
+
+//---------------------------------------------------------------------
+
+#include "moc_kpDocumentJournal.cpp"
@@ -0,0 +1,80 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpDocumentJournal_H
+#define kpDocumentJournal_H
+
+#include <QObject>
+#include <QStringList>
+
+class QRect;
+class QSize;
+class QWidget;
+
+class kpDocument;
+class kpDocumentEnvironment;
+
+//
+// Crash-recovery journal of a document.
+//
+// The journal starts with either the URL of the document (if it is
+// unmodified and stored in a local file) or its whole image.  After that,
+// each flush() appends only the pixels that have changed since the last
+// one, so the cost of keeping the journal is proportional to the size of
+// each edit, not of the document.  Encoding and writing happen on a
+// worker thread, in order.
+//
+// The journal starts over whenever the document is saved, or once the
+// changes appended add up to more than the document itself.
+//
+// Destroying the journal deletes it: the document was closed on purpose.
+// If the process dies instead, the journal is left behind and
+// OrphanedJournals() finds it the next time KolourPaint starts.
+//
+// Only the document image is journaled: a floating selection that has not
+// been deselected is not recovered, nor is the document's meta info
+// unless it was opened from a file.
+//
+class kpDocumentJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    // <document> must outlive the journal.
+    explicit kpDocumentJournal(kpDocument *document, QObject *parent = nullptr);
+    ~kpDocumentJournal() override;
+
+public Q_SLOTS:
+    // Appends the pixels changed since the last call.  Call this whenever
+    // the command history changes.
+    void flush();
+
+private Q_SLOTS:
+    void slotContentsChanged(const QRect &rect);
+    void slotSizeChanged(const QSize &size);
+
+    void restart();
+
+public:
+    // Journals left behind by KolourPaint processes that did not exit
+    // normally.
+    static QStringList OrphanedJournals();
+
+    // Returns a short, user-visible description of what is in the journal
+    // at <path> (e.g. the name of the file it was opened from).
+    static QString Description(const QString &path);
+
+    // Rebuilds the document in the journal at <path>, marked as modified.
+    // Returns nullptr if nothing could be recovered.
+    static kpDocument *Recover(const QString &path, kpDocumentEnvironment *environ, QWidget *parent);
+
+    static void Remove(const QString &path);
+
+private:
+    struct kpDocumentJournalPrivate *d;
+};
+
+#endif // kpDocumentJournal_H
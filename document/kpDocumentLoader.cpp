@@ -0,0 +1,310 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_DOCUMENT_LOADER 0
+
+#include "document/kpDocumentLoader.h"
+
+#include "document/kpDocument.h"
+#include "document/kpDocumentSaveOptions.h"
+#include "imagelib/kpDocumentMetaInfo.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QFile>
+#include <QImageIOHandler>
+#include <QImageReader>
+#include <QThreadPool>
+
+#include "kpLogCategories.h"
+
+#include <atomic>
+
+//---------------------------------------------------------------------
+
+namespace
+{
+// Longest side of the preview.
+const int PreviewSize = 256;
+
+// Below this, the full image decodes quickly enough that a preview
+// would only slow things down.
+const qint64 PreviewMinPixels = 2048 * 2048;
+} // namespace
+
+//---------------------------------------------------------------------
+
+// Shared between the loader and its worker, so that the mapping outlives
+// a loader that is destroyed while the worker is still decoding.
+struct kpDocumentLoaderState {
+    // Declared before <data> so that <data>, which may point into the
+    // mapping, is destroyed first.
+    QFile file;
+    QByteArray data;
+
+    std::atomic<bool> cancelled{false};
+
+    // Written by the worker, read by the loader after finished().
+    QImage image;
+    kpDocumentSaveOptions saveOptions;
+    kpDocumentMetaInfo metaInfo;
+};
+
+struct kpDocumentLoaderPrivate {
+    std::shared_ptr<kpDocumentLoaderState> state;
+
+    QString errorString;
+
+    bool started = false;
+    bool finished = false;
+
+    QImage preview;
+
+    QImage image;
+    kpDocumentSaveOptions saveOptions;
+    kpDocumentMetaInfo metaInfo;
+};
+
+//---------------------------------------------------------------------
+
+kpDocumentLoader::kpDocumentLoader(QObject *parent)
+    : QObject(parent)
+    , d(new kpDocumentLoaderPrivate())
+{
+    d->state = std::make_shared<kpDocumentLoaderState>();
+}
+
+//---------------------------------------------------------------------
+
+kpDocumentLoader::~kpDocumentLoader()
+{
+    // The worker (if any) keeps its own reference to the state and will
+    // release it once it notices.
+    d->state->cancelled.store(true, std::memory_order_relaxed);
+
+    delete d;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpDocumentLoader::setLocalFile(const QString &path)
+{
+    Q_ASSERT(!d->started);
+
+    kpDocumentLoaderState *state = d->state.get();
+
+    state->data.clear();
+    state->file.close();
+    state->file.setFileName(path);
+
+    if (!state->file.open(QIODevice::ReadOnly)) {
+        d->errorString = state->file.errorString();
+        return false;
+    }
+
+    const qint64 size = state->file.size();
+
+    uchar *mapped = size > 0 ? state->file.map(0, size) : nullptr;
+    if (mapped) {
+        state->data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), static_cast<qsizetype>(size));
+    } else {
+        // e.g. a pipe or a file system that does not support mapping.
+#if DEBUG_KP_DOCUMENT_LOADER
+        qCDebug(kpLogDocument) << "kpDocumentLoader::setLocalFile() could not map" << path << "- reading instead";
+#endif
+        state->data = state->file.readAll();
+        state->file.close();
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentLoader::setData(const QByteArray &data)
+{
+    Q_ASSERT(!d->started);
+
+    d->state->data = data;
+    d->state->file.close();
+}
+
+//---------------------------------------------------------------------
+
+// public
+QByteArray kpDocumentLoader::data() const
+{
+    Q_ASSERT(!d->started);
+
+    return d->state->data;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QString kpDocumentLoader::errorString() const
+{
+    return d->errorString;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentLoader::start()
+{
+    Q_ASSERT(!d->started);
+    d->started = true;
+
+    std::shared_ptr<kpDocumentLoaderState> state = d->state;
+    QPointer<kpDocumentLoader> loader(this);
+    QThreadPool::globalInstance()->start([state, loader] {
+        kpDocumentLoader::Decode(state, loader);
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpDocumentLoader::isFinished() const
+{
+    return d->finished;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QImage kpDocumentLoader::preview() const
+{
+    return d->preview;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QImage kpDocumentLoader::image() const
+{
+    return d->image;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentLoader::getDataFromImage(kpDocumentSaveOptions *saveOptions, kpDocumentMetaInfo *metaInfo) const
+{
+    if (saveOptions) {
+        *saveOptions = d->saveOptions;
+    }
+
+    if (metaInfo) {
+        *metaInfo = d->metaInfo;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private static
+void kpDocumentLoader::Decode(const std::shared_ptr<kpDocumentLoaderState> &state, const QPointer<kpDocumentLoader> &loader)
+{
+#if DEBUG_KP_DOCUMENT_LOADER
+    qCDebug(kpLogDocument) << "kpDocumentLoader::Decode() size=" << state->data.size();
+#endif
+
+    // Reuses the (possibly mapped) data without copying it.
+    QBuffer buffer;
+    buffer.setData(state->data);
+    buffer.open(QIODevice::ReadOnly);
+
+    //
+    // Preview
+    //
+
+    {
+        QImageReader reader(&buffer);
+        reader.setAutoTransform(true);
+        reader.setDecideFormatFromContent(true);
+
+        const QSize size = reader.size();
+        if (size.isValid() && qint64(size.width()) * size.height() >= PreviewMinPixels
+            && reader.supportsOption(QImageIOHandler::ScaledSize)) {
+            reader.setScaledSize(size.scaled(PreviewSize, PreviewSize, Qt::KeepAspectRatio).expandedTo(QSize(1, 1)));
+
+            QImage preview;
+            if (reader.read(&preview) && !state->cancelled.load(std::memory_order_relaxed)) {
+#if DEBUG_KP_DOCUMENT_LOADER
+                qCDebug(kpLogDocument) << "\tpreview" << preview.size() << "of" << size;
+#endif
+                // (runs on the GUI thread, where <loader> lives)
+                QMetaObject::invokeMethod(
+                    qApp,
+                    [loader, preview] {
+                        if (loader) {
+                            loader->d->preview = preview;
+                            Q_EMIT loader->previewReady(preview);
+                        }
+                    },
+                    Qt::QueuedConnection);
+            }
+        }
+    }
+
+    //
+    // Full image
+    //
+
+    if (!state->cancelled.load(std::memory_order_relaxed)) {
+        buffer.seek(0);
+
+        QImageReader reader(&buffer);
+        reader.setAutoTransform(true);
+        reader.setDecideFormatFromContent(true);
+
+        // Do *NOT* convert to
+        // QImage image = reader.read();
+        // (sync: kpDocument::getPixmapFromFile())
+        QImage image;
+        reader.read(&image);
+
+        if (!image.isNull()) {
+            kpDocument::getDataFromImage(image, state->saveOptions, state->metaInfo);
+
+            // (sync: kpDocument::getPixmapFromFile())
+            if (image.format() != QImage::Format_ARGB32_Premultiplied) {
+                image.convertTo(QImage::Format_ARGB32_Premultiplied);
+            }
+        }
+
+        state->image = image;
+    }
+
+    // Release the mapping now, rather than when the loader is destroyed.
+    buffer.close();
+    buffer.setData(QByteArray());
+    state->data.clear();
+    state->file.close();
+
+    QMetaObject::invokeMethod(
+        qApp,
+        [state, loader] {
+            if (!loader) {
+                return;
+            }
+
+            kpDocumentLoaderPrivate *d = loader->d;
+            d->image = std::move(state->image);
+            d->saveOptions = state->saveOptions;
+            d->metaInfo = state->metaInfo;
+            d->finished = true;
+
+            Q_EMIT loader->finished();
+        },
+        Qt::QueuedConnection);
+}
+
+//---------------------------------------------------------------------
+
+#include "moc_kpDocumentLoader.cpp"
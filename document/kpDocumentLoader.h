@@ -0,0 +1,93 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpDocumentLoader_H
+#define kpDocumentLoader_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+#include <memory>
+
+class kpDocumentMetaInfo;
+class kpDocumentSaveOptions;
+
+struct kpDocumentLoaderState;
+
+//
+// Decodes an image file on a worker thread.
+//
+// Local files are memory-mapped instead of being read into a QByteArray,
+// so peak memory use while opening is roughly the size of the decoded
+// image, not the file plus a copy of the file plus the decoded image.
+//
+// If the image format can decode a downscaled version cheaply (e.g. JPEG),
+// previewReady() is emitted with a small version of the image before the
+// full decode starts, so that the UI has something to show while waiting.
+//
+// Example Usage:
+//
+//     kpDocumentLoader loader;
+//     if (!loader.setLocalFile (path))
+//         ...
+//     connect (&loader, &kpDocumentLoader::finished, ...);
+//     loader.start ();
+//
+// The loader may be destroyed before the worker finishes (e.g. if the user
+// cancels); the worker then discards its result and releases the file.
+//
+class kpDocumentLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit kpDocumentLoader(QObject *parent = nullptr);
+    ~kpDocumentLoader() override;
+
+    // Maps the file at <path> into memory.
+    // Returns false (and sets errorString()) if it cannot be opened.
+    bool setLocalFile(const QString &path);
+
+    // Decodes from <data> (e.g. from a KIO job) instead of a local file.
+    void setData(const QByteArray &data);
+
+    // The encoded file contents, without copying.  Only valid for the
+    // lifetime of this loader and until start() is called.
+    QByteArray data() const;
+
+    QString errorString() const;
+
+    // Starts decoding on a worker thread.
+    void start();
+
+    bool isFinished() const;
+
+    // The image passed to the last previewReady(), or a null image if it
+    // has not been emitted (yet).
+    QImage preview() const;
+
+    // After finished(): the decoded image, converted to
+    // QImage::Format_ARGB32_Premultiplied, or a null image on error.
+    QImage image() const;
+
+    // After finished(): as per kpDocument::getDataFromImage(), computed
+    // from the image as it was before conversion.
+    void getDataFromImage(kpDocumentSaveOptions *saveOptions, kpDocumentMetaInfo *metaInfo) const;
+
+Q_SIGNALS:
+    void previewReady(const QImage &preview);
+    void finished();
+
+private:
+    static void Decode(const std::shared_ptr<kpDocumentLoaderState> &state, const QPointer<kpDocumentLoader> &loader);
+
+    struct kpDocumentLoaderPrivate *d;
+};
+
+#endif // kpDocumentLoader_H
@@ -8,15 +8,38 @@
 #ifndef kpDocumentPrivate_H
 #define kpDocumentPrivate_H
 
+#include <QtGlobal>
+
+#include "imagelib/kpAdjustmentStack.h"
+#include "imagelib/kpFloodFillIndex.h"
+
 class kpDocumentEnvironment;
+class kpDocumentSaver;
 
 struct kpDocumentPrivate {
     kpDocumentPrivate()
         : environ(nullptr)
+        , changeCount(0)
+        , backgroundSaver(nullptr)
+        , backgroundSaveChangeCount(0)
     {
     }
 
     kpDocumentEnvironment *environ;
+
+    // Incremented by every setModified(true), whether or not the document
+    // was already modified.
+    quint64 changeCount;
+
+    // Non-null while a background save is in progress.
+    kpDocumentSaver *backgroundSaver;
+    // <changeCount> when the background save's snapshot was taken.
+    quint64 backgroundSaveChangeCount;
+
+    kpFloodFillIndex floodFillIndex;
+
+    // Kept up to date by slotContentsChanged() and slotSizeChanged().
+    kpAdjustmentStack adjustmentStack;
 };
 
 #endif // kpDocumentPrivate_H
@@ -449,15 +449,23 @@ bool kpDocumentSaveOptions::mimeTypeHasConfigurableQuality() const
 
 // public
 int kpDocumentSaveOptions::isLossyForSaving(const QImage &image) const
+{
+    return isLossyForSaving(image.depth(), image.hasAlphaChannel());
+}
+
+//---------------------------------------------------------------------
+
+// public
+int kpDocumentSaveOptions::isLossyForSaving(int depth, bool hasAlphaChannel) const
 {
     int ret = 0;
 
-    if (mimeTypeMaximumColorDepth() < image.depth()) {
+    if (mimeTypeMaximumColorDepth() < depth) {
         ret |= MimeTypeMaximumColorDepthLow;
     }
 
     if (mimeTypeHasConfigurableColorDepth()
-        && !colorDepthIsInvalid() /*REFACTOR: guarantee it is valid*/ && ((colorDepth() < image.depth()) || (colorDepth() < 32 && image.hasAlphaChannel()))) {
+        && !colorDepthIsInvalid() /*REFACTOR: guarantee it is valid*/ && ((colorDepth() < depth) || (colorDepth() < 32 && hasAlphaChannel))) {
         ret |= ColorDepthLow;
     }
 
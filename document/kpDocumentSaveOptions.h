@@ -101,6 +101,9 @@ public:
     // loss of information.  Returned value is the bitwise OR of
     // LossType enum possibilities.
     int isLossyForSaving(const QImage &image) const;
+    // Same, for an image of <depth> that may have an alpha channel, without
+    // having to make the image.
+    int isLossyForSaving(int depth, bool hasAlphaChannel) const;
 
 private:
     // There is no need to maintain binary compatibility at this stage.
@@ -0,0 +1,308 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_DOCUMENT_SAVER 0
+
+#include "document/kpDocumentSaver.h"
+
+#include "document/kpDocument.h"
+#include "document/kpDocumentSaveOptions.h"
+#include "imagelib/kpDocumentMetaInfo.h"
+#include "layers/selections/kpAbstractSelection.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QPainter>
+#include <QSaveFile>
+#include <QThreadPool>
+
+#include <KLocalizedString>
+
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+// Shared between the saver and its worker, so that a saver destroyed
+// while the worker is still writing does not interrupt the write.
+struct kpDocumentSaverState {
+    kpImage image;
+    // The part of <image> under the selection, with the selection painted
+    // on top, or null if there is no selection.
+    kpImage selectionImage;
+    QPoint selectionTopLeft;
+    kpAdjustmentList adjustments;
+    kpDocumentMetaInfo metaInfo;
+
+    QUrl url;
+    kpDocumentSaveOptions saveOptions;
+
+    // Written by the worker, read by the saver after finished().
+    bool success = false;
+    QString errorString;
+};
+
+struct kpDocumentSaverPrivate {
+    std::shared_ptr<kpDocumentSaverState> state;
+
+    bool started = false;
+    bool finished = false;
+    bool success = false;
+    QString errorString;
+};
+
+//---------------------------------------------------------------------
+
+kpDocumentSaver::kpDocumentSaver(QObject *parent)
+    : QObject(parent)
+    , d(new kpDocumentSaverPrivate())
+{
+    d->state = std::make_shared<kpDocumentSaverState>();
+}
+
+//---------------------------------------------------------------------
+
+kpDocumentSaver::~kpDocumentSaver()
+{
+    delete d;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentSaver::setSnapshot(const kpImage &image, const kpAbstractSelection *selection, const kpDocumentMetaInfo &metaInfo)
+{
+    Q_ASSERT(!d->started);
+
+    d->state->image = image;
+    d->state->metaInfo = metaInfo;
+
+    d->state->selectionImage = kpImage();
+    if (selection) {
+        // Selections must only be painted on the GUI thread, so only the
+        // pixels under it are composited here (which does not detach
+        // <image>) and the worker copies them over the document.
+        const QRect rect = selection->boundingRect().intersected(image.rect());
+        if (!rect.isEmpty()) {
+            kpImage selectionImage = image.copy(rect);
+
+            // (this is a NOP for image selections without content)
+            selection->paint(&selectionImage, rect);
+
+            d->state->selectionImage = selectionImage;
+            d->state->selectionTopLeft = rect.topLeft();
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentSaver::setAdjustments(const kpAdjustmentList &adjustments)
+{
+    Q_ASSERT(!d->started);
+
+    d->state->adjustments = adjustments;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentSaver::setDestination(const QUrl &url, const kpDocumentSaveOptions &saveOptions)
+{
+    Q_ASSERT(!d->started);
+    Q_ASSERT(url.isLocalFile());
+
+    d->state->url = url;
+    d->state->saveOptions = saveOptions;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QUrl kpDocumentSaver::url() const
+{
+    return d->state->url;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpDocumentSaveOptions kpDocumentSaver::saveOptions() const
+{
+    return d->state->saveOptions;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentSaver::start()
+{
+    Q_ASSERT(!d->started);
+    d->started = true;
+
+#if DEBUG_KP_DOCUMENT_SAVER
+    qCDebug(kpLogDocument) << "kpDocumentSaver::start() url=" << d->state->url;
+#endif
+
+    std::shared_ptr<kpDocumentSaverState> state = d->state;
+    QPointer<kpDocumentSaver> saver(this);
+    QThreadPool::globalInstance()->start([state, saver] {
+        kpDocumentSaver::Save(state, saver);
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpDocumentSaver::isFinished() const
+{
+    return d->finished;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpDocumentSaver::isSuccessful() const
+{
+    return d->success;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QString kpDocumentSaver::errorString() const
+{
+    return d->errorString;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocumentSaver::waitForFinished()
+{
+    Q_ASSERT(d->started);
+
+    if (d->finished) {
+        return;
+    }
+
+    QEventLoop eventLoop;
+    connect(this, &kpDocumentSaver::finished, &eventLoop, &QEventLoop::quit);
+
+    // (sync: KJob::exec())
+    eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+}
+
+//---------------------------------------------------------------------
+
+// private static
+void kpDocumentSaver::ReportProgress(const QPointer<kpDocumentSaver> &saver, int percent)
+{
+    // (runs on the GUI thread, where <saver> lives)
+    QMetaObject::invokeMethod(
+        qApp,
+        [saver, percent] {
+            if (saver) {
+                Q_EMIT saver->progress(percent);
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+//---------------------------------------------------------------------
+
+// private static
+void kpDocumentSaver::Save(const std::shared_ptr<kpDocumentSaverState> &state, const QPointer<kpDocumentSaver> &saver)
+{
+#if DEBUG_KP_DOCUMENT_SAVER
+    qCDebug(kpLogDocument) << "kpDocumentSaver::Save() url=" << state->url;
+#endif
+
+    kpDocumentSaver::ReportProgress(saver, 0);
+
+    //
+    // Composite the selection and flatten the adjustments
+    //
+    // (sync: kpDocument::flattenedImage())
+    //
+
+    kpImage image = state->image;
+    // Let go of the document's pixels as soon as possible.
+    state->image = kpImage();
+
+    if (!state->selectionImage.isNull()) {
+        QPainter painter(&image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(state->selectionTopLeft, state->selectionImage);
+        painter.end();
+
+        state->selectionImage = kpImage();
+    }
+
+    image = kpAdjustmentStack::Flatten(image, state->adjustments);
+    state->adjustments.clear();
+
+    kpDocumentSaver::ReportProgress(saver, 10);
+
+    //
+    // Encode and write
+    //
+    // (sync: kpDocument::savePixmapToFile())
+    //
+
+    // sync: All failure exit paths _must_ call QSaveFile::cancelWriting() or
+    //       else, the QSaveFile destructor will overwrite the file,
+    //       despite the failure.
+    QSaveFile atomicFileWriter(state->url.toLocalFile());
+    if (!atomicFileWriter.open(QIODevice::WriteOnly)) {
+        atomicFileWriter.cancelWriting();
+        state->errorString = i18n("Unable to create temporary file.");
+    } else if (!kpDocument::savePixmapToDevice(image,
+                                               &atomicFileWriter,
+                                               state->saveOptions,
+                                               state->metaInfo,
+                                               false /*no lossy prompt*/,
+                                               nullptr /*no dialogs on this thread*/)) {
+        atomicFileWriter.cancelWriting();
+        state->errorString = i18n("Error saving image");
+    } else {
+        kpDocumentSaver::ReportProgress(saver, 90);
+
+        // Atomically overwrite local file with the temporary file
+        // we saved to.
+        if (!atomicFileWriter.commit()) {
+            atomicFileWriter.cancelWriting();
+            state->errorString = atomicFileWriter.errorString();
+        } else {
+            state->success = true;
+        }
+    }
+
+#if DEBUG_KP_DOCUMENT_SAVER
+    qCDebug(kpLogDocument) << "\tsuccess=" << state->success << "error=" << state->errorString;
+#endif
+
+    QMetaObject::invokeMethod(
+        qApp,
+        [state, saver] {
+            if (!saver) {
+                return;
+            }
+
+            kpDocumentSaverPrivate *d = saver->d;
+            d->success = state->success;
+            d->errorString = state->errorString;
+            d->finished = true;
+
+            Q_EMIT saver->progress(100);
+            Q_EMIT saver->finished(d->success);
+        },
+        Qt::QueuedConnection);
+}
+
+//---------------------------------------------------------------------
+
+#include "moc_kpDocumentSaver.cpp"
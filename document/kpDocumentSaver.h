@@ -0,0 +1,86 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpDocumentSaver_H
+#define kpDocumentSaver_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QUrl>
+
+#include "imagelib/kpAdjustmentStack.h"
+#include "imagelib/kpImage.h"
+
+#include <memory>
+
+class kpAbstractSelection;
+class kpDocumentMetaInfo;
+class kpDocumentSaveOptions;
+
+struct kpDocumentSaverState;
+
+//
+// Writes a snapshot of a document to a local file on a worker thread.
+//
+// The snapshot is taken cheaply on the GUI thread (kpImage is implicitly
+// shared, so the document may continue to be edited without affecting
+// it).  Only the pixels under the selection are composited there, since
+// selections may only be painted on the GUI thread.  Copying them over the
+// document, flattening the adjustments, reducing colors, encoding and
+// writing through QSaveFile all happen on the worker.
+//
+// Destroying the saver does not cancel writing - the file is always
+// either fully written or left untouched.
+//
+class kpDocumentSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit kpDocumentSaver(QObject *parent = nullptr);
+    ~kpDocumentSaver() override;
+
+    // <selection> may be null.  If not, it is painted on top of <image>
+    // (ownership is not taken, and it is not used after this returns).
+    void setSnapshot(const kpImage &image, const kpAbstractSelection *selection, const kpDocumentMetaInfo &metaInfo);
+
+    // Applied after compositing the selection (sync:
+    // kpDocument::flattenedImage()).
+    void setAdjustments(const kpAdjustmentList &adjustments);
+
+    // <url> must be a local file.
+    void setDestination(const QUrl &url, const kpDocumentSaveOptions &saveOptions);
+
+    QUrl url() const;
+    kpDocumentSaveOptions saveOptions() const;
+
+    void start();
+
+    bool isFinished() const;
+
+    // After finished(): whether the file was written and, if not, a
+    // user-visible explanation.
+    bool isSuccessful() const;
+    QString errorString() const;
+
+    // Runs a local event loop until finished() has been emitted.
+    void waitForFinished();
+
+Q_SIGNALS:
+    // Approximate, since image writers do not report their progress.
+    void progress(int percent);
+
+    void finished(bool success);
+
+private:
+    static void Save(const std::shared_ptr<kpDocumentSaverState> &state, const QPointer<kpDocumentSaver> &saver);
+    static void ReportProgress(const QPointer<kpDocumentSaver> &saver, int percent);
+
+    struct kpDocumentSaverPrivate *d;
+};
+
+#endif // kpDocumentSaver_H
@@ -9,6 +9,8 @@
 #include "kpDocument.h"
 #include "kpDocumentPrivate.h"
 
+#include "dialogs/kpDocumentOpenProgressDialog.h"
+#include "document/kpDocumentLoader.h"
 #include "document/kpDocumentSaveOptions.h"
 #include "environments/document/kpDocumentEnvironment.h"
 #include "imagelib/effects/kpEffectReduceColors.h"
@@ -21,11 +23,12 @@
 #include "views/manager/kpViewManager.h"
 #include "widgets/toolbars/kpColorToolBar.h"
 
-#include <QBuffer>
 #include <QColor>
+#include <QEventLoop>
 #include <QImage>
-#include <QImageReader>
 #include <QMimeDatabase>
+#include <QPointer>
+#include <QTimer>
 
 #include "kpLogCategories.h"
 #include <KIO/StoredTransferJob>
@@ -57,7 +60,8 @@ QImage kpDocument::getPixmapFromFile(const QUrl &url,
                                      bool suppressDoesntExistDialog,
                                      QWidget *parent,
                                      kpDocumentSaveOptions *saveOptions,
-                                     kpDocumentMetaInfo *metaInfo)
+                                     kpDocumentMetaInfo *metaInfo,
+                                     bool *userCancelled)
 {
 #if DEBUG_KP_DOCUMENT
     qCDebug(kpLogDocument) << "kpDocument::getPixmapFromFile(" << url << "," << parent << ")";
@@ -71,14 +75,31 @@ QImage kpDocument::getPixmapFromFile(const QUrl &url,
         *metaInfo = kpDocumentMetaInfo();
     }
 
+    if (userCancelled) {
+        *userCancelled = false;
+    }
+
     if (url.isEmpty()) {
         return {};
     }
 
-    KIO::StoredTransferJob *job = KIO::storedGet(url);
-    KJobWidgets::setWindow(job, parent);
+    kpDocumentLoader loader;
+
+    // Map local files directly instead of copying them through KIO.
+    bool gotData = false;
+    if (url.isLocalFile()) {
+        gotData = loader.setLocalFile(url.toLocalFile());
+    } else {
+        KIO::StoredTransferJob *job = KIO::storedGet(url);
+        KJobWidgets::setWindow(job, parent);
+
+        if (job->exec()) {
+            loader.setData(job->data());
+            gotData = true;
+        }
+    }
 
-    if (!job->exec()) {
+    if (!gotData) {
         if (!suppressDoesntExistDialog) {
             // TODO: Use "Cannot" instead of "Could not" in all dialogs in KolourPaint.
             //       Or at least choose one consistently.
@@ -89,10 +110,9 @@ QImage kpDocument::getPixmapFromFile(const QUrl &url,
 
         return {};
     }
-    QByteArray data = job->data();
 
     QMimeDatabase db;
-    QMimeType mimeType = db.mimeTypeForFileNameAndData(url.fileName(), data);
+    QMimeType mimeType = db.mimeTypeForFileNameAndData(url.fileName(), loader.data());
 
     if (saveOptions) {
         saveOptions->setMimeType(mimeType.name());
@@ -103,18 +123,70 @@ QImage kpDocument::getPixmapFromFile(const QUrl &url,
     qCDebug(kpLogDocument) << "\tsrc=" << url.path();
 #endif
 
-    QBuffer buffer(&data);
-    buffer.open(QIODevice::ReadOnly);
-    QImageReader reader(&buffer);
-    reader.setAutoTransform(true);
-    reader.setDecideFormatFromContent(true);
+    //
+    // Decode on a worker thread, keeping the UI responsive.  Like the
+    // KIO job above, this waits in a local event loop so that callers
+    // can continue to treat opening as synchronous.
+    //
+    // If decoding takes noticeably long, show a progress dialog (with a
+    // preview of the image, if the decoder can produce one cheaply) that
+    // lets the user cancel.
+    //
+
+    bool cancelled = false;
+    {
+        QEventLoop eventLoop;
+        QObject::connect(&loader, &kpDocumentLoader::finished, &eventLoop, &QEventLoop::quit);
+
+        QPointer<kpDocumentOpenProgressDialog> progressDialog;
+        QTimer showProgressTimer;
+        showProgressTimer.setSingleShot(true);
+        QObject::connect(&showProgressTimer, &QTimer::timeout, &eventLoop, [&] {
+            progressDialog = new kpDocumentOpenProgressDialog(kpUrlFormatter::PrettyFilename(url), parent);
+            // (the preview is often ready before the dialog is shown)
+            if (!loader.preview().isNull()) {
+                progressDialog->setPreview(loader.preview());
+            }
+            QObject::connect(&loader, &kpDocumentLoader::previewReady, progressDialog, &kpDocumentOpenProgressDialog::setPreview);
+            QObject::connect(progressDialog, &QDialog::rejected, &eventLoop, [&] {
+                cancelled = true;
+                eventLoop.quit();
+            });
+            progressDialog->show();
+
+            // Continue below, now that the modal dialog protects the
+            // rest of the UI from user input.
+            eventLoop.quit();
+        });
+
+        loader.start();
+        showProgressTimer.start(300 /*ms*/);
+
+        // (sync: KJob::exec())
+        eventLoop.exec(QEventLoop::ExcludeUserInputEvents);
+
+        if (progressDialog && !loader.isFinished() && !cancelled) {
+            // Allow the user to press Cancel.
+            eventLoop.exec();
+        }
+
+        delete progressDialog;
+    }
+
+    if (cancelled) {
+#if DEBUG_KP_DOCUMENT
+        qCDebug(kpLogDocument) << "\tcancelled by user";
+#endif
+        if (userCancelled) {
+            *userCancelled = true;
+        }
+
+        // <loader> lets the worker finish in the background and discard
+        // its result.
+        return {};
+    }
 
-    // Do *NOT* convert to
-    // QImage image = reader.read();
-    // this variant is more lenient on errors and we may get something that we would not otherwise
-    // e.g. image from https://bugs.kde.org/show_bug.cgi?id=441554
-    QImage image;
-    reader.read(&image);
+    QImage image = loader.image();
 
     if (image.isNull()) {
         KMessageBox::error(parent,
@@ -125,17 +197,15 @@ QImage kpDocument::getPixmapFromFile(const QUrl &url,
     }
 
 #if DEBUG_KP_DOCUMENT
-    qCDebug(kpLogDocument) << "\tpixmap: depth=" << image.depth() << " hasAlphaChannel=" << image.hasAlphaChannel();
+    qCDebug(kpLogDocument) << "\tpixmap: size=" << image.size();
 #endif
 
+    // (the image has already been converted to
+    //  Format_ARGB32_Premultiplied - use the data from before that)
     if (saveOptions && metaInfo) {
-        getDataFromImage(image, *saveOptions, *metaInfo);
-    }
-
-    // make sure we always have Format_ARGB32_Premultiplied as this is the fastest to draw on
-    // and Qt can not draw onto Format_Indexed8 (Qt-4.7)
-    if (image.format() != QImage::Format_ARGB32_Premultiplied) {
-        image.convertTo(QImage::Format_ARGB32_Premultiplied);
+        QString mimeTypeName = saveOptions->mimeType();
+        loader.getDataFromImage(saveOptions, metaInfo);
+        saveOptions->setMimeType(mimeTypeName);
     }
 
     return image;
@@ -182,11 +252,13 @@ bool kpDocument::open(const QUrl &url, bool newDocSameNameIfNotExist)
 
     kpDocumentSaveOptions newSaveOptions;
     kpDocumentMetaInfo newMetaInfo;
+    bool userCancelled = false;
     QImage newPixmap = kpDocument::getPixmapFromFile(url,
                                                      newDocSameNameIfNotExist /*suppress "doesn't exist" dialog*/,
                                                      d->environ->dialogParent(),
                                                      &newSaveOptions,
-                                                     &newMetaInfo);
+                                                     &newMetaInfo,
+                                                     &userCancelled);
 
     if (!newPixmap.isNull()) {
         delete m_image;
@@ -201,6 +273,12 @@ bool kpDocument::open(const QUrl &url, bool newDocSameNameIfNotExist)
         return true;
     }
 
+    // Don't create a blank document with the name of a file that exists
+    // but the user chose not to wait for.
+    if (userCancelled) {
+        return false;
+    }
+
     if (newDocSameNameIfNotExist) {
         if (urlExists(url)) // not just a permission error?
         {
@@ -22,11 +22,13 @@
 #include <KMessageBox>
 
 #include "document/kpDocumentSaveOptions.h"
+#include "document/kpDocumentSaver.h"
 #include "environments/document/kpDocumentEnvironment.h"
 #include "imagelib/effects/kpEffectReduceColors.h"
 #include "imagelib/kpColor.h"
 #include "imagelib/kpDocumentMetaInfo.h"
 #include "kpDefs.h"
+#include "layers/selections/kpAbstractSelection.h"
 #include "lgpl/generic/kpUrlFormatter.h"
 #include "pixmapfx/kpPixmapFX.h"
 #include "tools/kpTool.h"
@@ -60,9 +62,17 @@ bool kpDocument::save(bool lossyPrompt)
 
 // public static
 bool kpDocument::lossyPromptContinue(const QImage &pixmap, const kpDocumentSaveOptions &saveOptions, QWidget *parent)
+{
+    return lossyTypePromptContinue(saveOptions.isLossyForSaving(pixmap), saveOptions, parent);
+}
+
+//---------------------------------------------------------------------
+
+// public static
+bool kpDocument::lossyTypePromptContinue(int lossyType, const kpDocumentSaveOptions &saveOptions, QWidget *parent)
 {
 #if DEBUG_KP_DOCUMENT
-    qCDebug(kpLogDocument) << "kpDocument::lossyPromptContinue()";
+    qCDebug(kpLogDocument) << "kpDocument::lossyTypePromptContinue(" << lossyType << ")";
 #endif
 
 #define QUIT_IF_CANCEL(messageBoxCommand)                                                                                                                      \
@@ -72,7 +82,6 @@ bool kpDocument::lossyPromptContinue(const QImage &pixmap, const kpDocumentSaveO
         }                                                                                                                                                      \
     }
 
-    const int lossyType = saveOptions.isLossyForSaving(pixmap);
     if (lossyType & (kpDocumentSaveOptions::MimeTypeMaximumColorDepthLow | kpDocumentSaveOptions::Quality)) {
         QMimeDatabase db;
 
@@ -354,7 +363,7 @@ bool kpDocument::saveAs(const QUrl &url, const kpDocumentSaveOptions &saveOption
     qCDebug(kpLogDocument) << "kpDocument::saveAs (" << url << "," << saveOptions.mimeType() << ")" << endl;
 #endif
 
-    if (kpDocument::savePixmapToFile(imageWithSelection(), url, saveOptions, *metaInfo(), lossyPrompt, d->environ->dialogParent())) {
+    if (kpDocument::savePixmapToFile(flattenedImage(), url, saveOptions, *metaInfo(), lossyPrompt, d->environ->dialogParent())) {
         setURL(url, true /*is from url*/);
         *m_saveOptions = saveOptions;
         m_modified = false;
@@ -369,3 +378,129 @@ bool kpDocument::saveAs(const QUrl &url, const kpDocumentSaveOptions &saveOption
 }
 
 //---------------------------------------------------------------------
+
+// public
+bool kpDocument::saveInBackground(bool lossyPrompt)
+{
+#if DEBUG_KP_DOCUMENT
+    qCDebug(kpLogDocument) << "kpDocument::saveInBackground(lossyPrompt=" << lossyPrompt << ") url=" << m_url;
+#endif
+
+    // (sync: save())
+    if (m_url.isEmpty() || m_saveOptions->mimeType().isEmpty()) {
+        return save(lossyPrompt);
+    }
+
+    return saveAsInBackground(m_url, *m_saveOptions, lossyPrompt);
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpDocument::saveAsInBackground(const QUrl &url, const kpDocumentSaveOptions &saveOptions, bool lossyPrompt)
+{
+#if DEBUG_KP_DOCUMENT
+    qCDebug(kpLogDocument) << "kpDocument::saveAsInBackground (" << url << "," << saveOptions.mimeType() << ")";
+#endif
+
+    // Writes must reach the disk in the order they were requested.
+    waitForBackgroundSave();
+
+    // Uploading is done by KIO, which is asynchronous anyway.
+    if (!url.isLocalFile()) {
+        return saveAs(url, saveOptions, lossyPrompt);
+    }
+
+    // Compositing the selection and flattening the adjustments changes
+    // neither the depth of the image nor whether it has an alpha channel,
+    // so the document's image says whether saving would be lossy without
+    // making flattenedImage().
+    const int lossyType = saveOptions.isLossyForSaving(m_image->depth(), m_image->hasAlphaChannel());
+    if (lossyPrompt && lossyType != kpDocumentSaveOptions::LossLess && !lossyTypePromptContinue(lossyType, saveOptions, d->environ->dialogParent())) {
+#if DEBUG_KP_DOCUMENT
+        qCDebug(kpLogDocument) << "\treturning false because of lossyPrompt";
+#endif
+        return false;
+    }
+
+    // Only shallow copies, and the pixels under the selection, are made
+    // here - the adjustments are flattened on the worker (sync:
+    // flattenedImage()).
+    d->backgroundSaver = new kpDocumentSaver(this);
+    d->backgroundSaver->setSnapshot(*m_image, m_selection, *m_metaInfo);
+    d->backgroundSaver->setAdjustments(adjustments());
+    d->backgroundSaver->setDestination(url, saveOptions);
+    d->backgroundSaveChangeCount = d->changeCount;
+
+    connect(d->backgroundSaver, &kpDocumentSaver::progress, this, &kpDocument::backgroundSaveProgress);
+    connect(d->backgroundSaver, &kpDocumentSaver::finished, this, &kpDocument::slotBackgroundSaveFinished);
+
+    d->backgroundSaver->start();
+
+    Q_EMIT backgroundSaveStarted(url);
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpDocument::isSavingInBackground() const
+{
+    return d->backgroundSaver != nullptr;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDocument::waitForBackgroundSave()
+{
+    if (!d->backgroundSaver) {
+        return;
+    }
+
+#if DEBUG_KP_DOCUMENT
+    qCDebug(kpLogDocument) << "kpDocument::waitForBackgroundSave()";
+#endif
+
+    // (slotBackgroundSaveFinished() will be called before this returns)
+    d->backgroundSaver->waitForFinished();
+    Q_ASSERT(!d->backgroundSaver);
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpDocument::slotBackgroundSaveFinished(bool success)
+{
+    kpDocumentSaver *saver = d->backgroundSaver;
+    Q_ASSERT(saver);
+    d->backgroundSaver = nullptr;
+    saver->deleteLater();
+
+    const QUrl url = saver->url();
+
+#if DEBUG_KP_DOCUMENT
+    qCDebug(kpLogDocument) << "kpDocument::slotBackgroundSaveFinished(" << success << ") url=" << url
+                           << "changedSinceSnapshot=" << (d->changeCount != d->backgroundSaveChangeCount);
+#endif
+
+    if (success) {
+        // (sync: saveAs())
+        setURL(url, true /*is from url*/);
+        *m_saveOptions = saver->saveOptions();
+        m_savedAtLeastOnceBefore = true;
+
+        // Only if the file matches what the user now sees.  Otherwise,
+        // the document remains modified.
+        if (d->changeCount == d->backgroundSaveChangeCount) {
+            m_modified = false;
+            Q_EMIT documentSaved();
+        }
+    } else {
+        ::CouldNotSaveDialog(url, saver->errorString(), d->environ->dialogParent());
+    }
+
+    Q_EMIT backgroundSaveFinished(url, success);
+}
+
+//---------------------------------------------------------------------
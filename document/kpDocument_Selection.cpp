@@ -10,6 +10,8 @@
 #include "kpDocument.h"
 #include "kpDocumentPrivate.h"
 
+#include <atomic>
+
 #include <QImage>
 #include <QPainter>
 #include <QRect>
@@ -18,11 +20,13 @@
 #include <KLocalizedString>
 
 #include "environments/document/kpDocumentEnvironment.h"
+#include "generic/kpParallel.h"
 #include "imagelib/kpColor.h"
 #include "kpDefs.h"
 #include "layers/selections/image/kpAbstractImageSelection.h"
 #include "layers/selections/kpAbstractSelection.h"
 #include "layers/selections/text/kpTextSelection.h"
+#include "pixmapfx/kpPixmapFX.h"
 
 // public
 kpAbstractSelection *kpDocument::selection() const
@@ -190,14 +194,21 @@ void kpDocument::imageSelectionPullFromDocument(const kpColor &backgroundColor)
     }
 #endif
 
-    kpImage eraseImage(boundingRect.size(), QImage::Format_ARGB32_Premultiplied);
-    eraseImage.fill(backgroundColor.toQRgb());
-
-    // only paint the region of the shape of the selection
-    QPainter painter(m_image);
-    painter.setClipRegion(imageSel->shapeRegion());
-    painter.setCompositionMode(QPainter::CompositionMode_Source);
-    painter.drawImage(boundingRect.topLeft(), eraseImage);
+    if (boundingRect == rect() && imageSel->isRectangular() && m_image->format() == QImage::Format_ARGB32_Premultiplied) {
+        // The selection now shares all of the document's pixels.  Rather
+        // than copying them, only to overwrite every one, start afresh.
+        kpImage holeImage(m_image->size(), QImage::Format_ARGB32_Premultiplied);
+        holeImage.fill(backgroundColor.toQRgb());
+        *m_image = holeImage;
+    } else {
+        // only paint the region of the shape of the selection
+        QPainter painter(m_image);
+        if (!imageSel->isRectangular()) {
+            painter.setClipRegion(imageSel->shapeRegion());
+        }
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(boundingRect, backgroundColor.toQColor());
+    }
     slotContentsChanged(boundingRect);
 
     d->environ->restoreQueueViewUpdates();
@@ -234,6 +245,39 @@ void kpDocument::selectionDelete()
 
 //---------------------------------------------------------------------
 
+// Returns whether every pixel of <image> is fully opaque.
+static bool IsOpaque(const kpImage &image)
+{
+    if (!image.hasAlphaChannel()) {
+        return true;
+    }
+
+    if (image.format() != QImage::Format_ARGB32_Premultiplied && image.format() != QImage::Format_ARGB32) {
+        return false;
+    }
+
+    const uchar *const bits = image.constBits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    const int width = image.width();
+
+    std::atomic<bool> isOpaque(true);
+    kpParallelFor(image.height(), qMax(1, 65536 / qMax(1, width)), [=, &isOpaque](int begin, int end) {
+        for (int y = begin; y < end && isOpaque; y++) {
+            const auto *line = reinterpret_cast<const QRgb *>(bits + y * bytesPerLine);
+            for (int x = 0; x < width; x++) {
+                if (qAlpha(line[x]) != 255) {
+                    isOpaque = false;
+                    return;
+                }
+            }
+        }
+    });
+
+    return isOpaque;
+}
+
+//---------------------------------------------------------------------
+
 // public
 void kpDocument::selectionCopyOntoDocument(bool applySelTransparency)
 {
@@ -246,10 +290,15 @@ void kpDocument::selectionCopyOntoDocument(bool applySelTransparency)
     Q_ASSERT(boundingRect.isValid());
 
     if (imageSelection()) {
-        if (applySelTransparency) {
-            imageSelection()->paint(m_image, rect());
+        const kpImage image = applySelTransparency ? imageSelection()->transparentImage() : imageSelection()->baseImage();
+
+        if (boundingRect == rect() && m_selection->isRectangular() && image.format() == m_image->format() && ::IsOpaque(image)) {
+            // Drawing it would replace every pixel of the document, so
+            // share the selection's pixels instead of copying them.
+            *m_image = image;
         } else {
-            imageSelection()->paintWithBaseImage(m_image, rect());
+            // (sync: kpAbstractImageSelection::paint())
+            kpPixmapFX::paintPixmapAt(m_image, boundingRect.topLeft(), image);
         }
     } else {
         // (for antialiasing with background)
@@ -300,3 +349,32 @@ kpImage kpDocument::imageWithSelection() const
 }
 
 //---------------------------------------------------------------------
+
+// public
+kpImage kpDocument::imageWithSelectionAt(const QRect &rect) const
+{
+#if DEBUG_KP_DOCUMENT && 1
+    qCDebug(kpLogDocument) << "kpDocument::imageWithSelectionAt(" << rect << ")";
+#endif
+
+    // (sync: imageWithSelection())
+    kpImage output = getImageAt(rect);
+
+    if (m_selection) {
+        // (this is a NOP for image selections without content)
+        m_selection->paint(&output, rect);
+    }
+
+    return output;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpImage kpDocument::flattenedImage() const
+{
+    // (sync: kpDocumentSaver::Save())
+    return kpAdjustmentStack::Flatten(imageWithSelection(), adjustments());
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,212 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_DAMAGE_REGION 0
+
+#include "generic/kpDamageRegion.h"
+
+#include <QRegion>
+
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+// Merging 2 rectangles is always acceptable if it repaints no more than
+// this many extra pixels (e.g. 2 adjacent spraycan dabs).
+static const qint64 MergeSlackPixels = 32 * 32;
+
+static qint64 Area(const QRect &rect)
+{
+    return rect.isEmpty() ? 0 : qint64(rect.width()) * rect.height();
+}
+
+//---------------------------------------------------------------------
+
+// Returns the number of pixels inside the bounding rectangle of <a> and <b>
+// that are in neither.
+static qint64 MergeWaste(const QRect &a, const QRect &b)
+{
+    return ::Area(a.united(b)) - (::Area(a) + ::Area(b) - ::Area(a.intersected(b)));
+}
+
+//---------------------------------------------------------------------
+
+static bool IsCheapMerge(const QRect &a, const QRect &b)
+{
+    const qint64 waste = ::MergeWaste(a, b);
+    return (waste <= MergeSlackPixels || waste * 4 <= ::Area(a) + ::Area(b));
+}
+
+//---------------------------------------------------------------------
+
+// Appends the (up to 4) disjoint rectangles covering the parts of <rect>
+// that are not in <hole> to <*pieces>.
+static void SubtractRect(const QRect &rect, const QRect &hole, QList<QRect> *pieces)
+{
+    const QRect overlap = rect.intersected(hole);
+    if (overlap.isEmpty()) {
+        pieces->append(rect);
+        return;
+    }
+
+    // Full-width bands above and below the overlap.
+    if (overlap.top() > rect.top()) {
+        pieces->append(QRect(rect.left(), rect.top(), rect.width(), overlap.top() - rect.top()));
+    }
+    if (overlap.bottom() < rect.bottom()) {
+        pieces->append(QRect(rect.left(), overlap.bottom() + 1, rect.width(), rect.bottom() - overlap.bottom()));
+    }
+
+    // Either side of the overlap.
+    if (overlap.left() > rect.left()) {
+        pieces->append(QRect(rect.left(), overlap.top(), overlap.left() - rect.left(), overlap.height()));
+    }
+    if (overlap.right() < rect.right()) {
+        pieces->append(QRect(overlap.right() + 1, overlap.top(), rect.right() - overlap.right(), overlap.height()));
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDamageRegion::clear()
+{
+    m_rects.clear();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDamageRegion::add(const QRect &rect)
+{
+#if DEBUG_KP_DAMAGE_REGION
+    qCDebug(kpLogViews) << "kpDamageRegion::add(" << rect << ") rects=" << m_rects;
+#endif
+
+    const QRect newRect = rect.normalized();
+    if (newRect.isEmpty()) {
+        return;
+    }
+
+    for (int i = 0; i < m_rects.size(); i++) {
+        if (m_rects[i].contains(newRect)) {
+            return;
+        }
+    }
+
+    // Grow an existing rectangle, if that wastes little area?
+    for (int i = 0; i < m_rects.size(); i++) {
+        if (::IsCheapMerge(m_rects[i], newRect)) {
+            const QRect merged = m_rects[i].united(newRect);
+            m_rects.removeAt(i);
+            absorb(merged);
+            return;
+        }
+    }
+
+    // Else, keep the rectangles disjoint, so that no pixel is repainted
+    // twice, by only adding the parts of <newRect> not already covered.
+    QList<QRect> pieces;
+    pieces.append(newRect);
+    for (const QRect &existingRect : std::as_const(m_rects)) {
+        if (!existingRect.intersects(newRect)) {
+            continue;
+        }
+
+        QList<QRect> remainingPieces;
+        for (const QRect &piece : std::as_const(pieces)) {
+            ::SubtractRect(piece, existingRect, &remainingPieces);
+        }
+        pieces = remainingPieces;
+    }
+    m_rects.append(pieces);
+
+    while (m_rects.size() > MaxRects) {
+        mergeCheapestPair();
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpDamageRegion::add(const QRegion &region)
+{
+    for (const QRect &rect : region) {
+        add(rect);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+QRegion kpDamageRegion::region() const
+{
+    QRegion ret;
+    for (const QRect &rect : std::as_const(m_rects)) {
+        ret += rect;
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpDamageRegion::mergeCheapestPair()
+{
+    Q_ASSERT(m_rects.size() >= 2);
+
+    int bestI = 0, bestJ = 1;
+    qint64 bestWaste = -1;
+    for (int i = 0; i < m_rects.size(); i++) {
+        for (int j = i + 1; j < m_rects.size(); j++) {
+            const qint64 waste = ::MergeWaste(m_rects[i], m_rects[j]);
+            if (bestWaste < 0 || waste < bestWaste) {
+                bestI = i;
+                bestJ = j;
+                bestWaste = waste;
+            }
+        }
+    }
+
+    const QRect merged = m_rects[bestI].united(m_rects[bestJ]);
+    m_rects.removeAt(bestJ);
+    m_rects.removeAt(bestI);
+
+#if DEBUG_KP_DAMAGE_REGION
+    qCDebug(kpLogViews) << "\tmerging cheapest pair (waste=" << bestWaste << ") ->" << merged;
+#endif
+
+    absorb(merged);
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpDamageRegion::absorb(const QRect &rect)
+{
+    // Swallow anything <rect> overlaps, rather than splitting <rect> up
+    // again.  As this only ever reduces the number of rectangles, merges
+    // can't ping-pong with splits.
+    QRect merged = rect;
+
+    bool grew;
+    do {
+        grew = false;
+        for (int i = 0; i < m_rects.size(); i++) {
+            if (m_rects[i].intersects(merged)) {
+                merged = merged.united(m_rects[i]);
+                m_rects.removeAt(i);
+                i--;
+                grew = true;
+            }
+        }
+    } while (grew);
+
+    m_rects.append(merged);
+}
+
+//---------------------------------------------------------------------
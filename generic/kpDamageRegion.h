@@ -0,0 +1,61 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpDamageRegion_H
+#define kpDamageRegion_H
+
+#include <QList>
+#include <QRect>
+
+class QRegion;
+
+//
+// Accumulates the areas of a widget that need repainting as a small set of
+// disjoint rectangles.
+//
+// Unlike a QRegion, this never grows beyond MaxRects rectangles, no matter
+// how many scattered areas are added (e.g. by the spraycan).  Unlike a
+// bounding rectangle, two small areas in opposite corners stay two small
+// areas.
+//
+// A new rectangle is only merged with an existing one if their bounding
+// rectangle wastes little area, or if there would otherwise be more than
+// MaxRects.  Otherwise, only its parts that are not yet covered are added.
+//
+class kpDamageRegion
+{
+public:
+    enum {
+        MaxRects = 32
+    };
+
+    bool isEmpty() const
+    {
+        return m_rects.isEmpty();
+    }
+
+    void clear();
+
+    void add(const QRect &rect);
+    void add(const QRegion &region);
+
+    // The disjoint rectangles, in no particular order.
+    const QList<QRect> &rects() const
+    {
+        return m_rects;
+    }
+
+    QRegion region() const;
+
+private:
+    void mergeCheapestPair();
+    // Adds <rect>, merged with every rectangle it overlaps.
+    void absorb(const QRect &rect);
+
+    QList<QRect> m_rects;
+};
+
+#endif // kpDamageRegion_H
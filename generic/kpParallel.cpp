@@ -0,0 +1,57 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "generic/kpParallel.h"
+
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+//---------------------------------------------------------------------
+
+void kpParallelFor(int count, int grainSize, const std::function<void(int begin, int end)> &func)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    grainSize = std::max(1, grainSize);
+
+    const int maxChunks = std::max(1, QThread::idealThreadCount());
+    const int numChunks = std::min(maxChunks, (count + grainSize - 1) / grainSize);
+    if (numChunks <= 1) {
+        func(0, count);
+        return;
+    }
+
+    const int chunkSize = (count + numChunks - 1) / numChunks;
+
+    QSemaphore finished;
+    int numStarted = 0;
+
+    for (int begin = chunkSize; begin < count; begin += chunkSize) {
+        const int end = std::min(count, begin + chunkSize);
+
+        const bool started = QThreadPool::globalInstance()->tryStart([&func, &finished, begin, end] {
+            func(begin, end);
+            finished.release();
+        });
+
+        if (started) {
+            numStarted++;
+        } else {
+            func(begin, end);
+        }
+    }
+
+    func(0, std::min(count, chunkSize));
+
+    finished.acquire(numStarted);
+}
+
+//---------------------------------------------------------------------
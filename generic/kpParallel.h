@@ -0,0 +1,26 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpParallel_H
+#define kpParallel_H
+
+#include <functional>
+
+//
+// Splits the range [0, <count>) into contiguous chunks of at least
+// <grainSize> items and calls <func>(begin, end) on each chunk, using
+// QThreadPool::globalInstance() for all but the first chunk.  Blocks until
+// all chunks have been processed.
+//
+// Chunks that cannot be given to an idle pool thread straight away are run
+// on the calling thread, so this is safe to call from pool threads (e.g.
+// in batch mode) without risking deadlock.
+//
+// <func> must be safe to call concurrently on disjoint ranges.
+//
+void kpParallelFor(int count, int grainSize, const std::function<void(int begin, int end)> &func);
+
+#endif // kpParallel_H
@@ -0,0 +1,347 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_PROFILER 0
+
+#include "generic/kpProfiler.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+#include <KLocalizedString>
+
+#include "kpLogCategories.h"
+
+#include <vector>
+
+//---------------------------------------------------------------------
+
+std::atomic<bool> kpProfiler::s_enabled{false};
+
+namespace
+{
+// Enough for a few seconds of continuous drawing at a high mouse rate.
+const int RingBufferCapacity = 4096;
+
+struct kpProfilerRingBuffer {
+    QMutex mutex;
+    std::vector<kpProfiler::Event> events;
+    // Index of the slot the next event will be written to.
+    int next = 0;
+    bool wrapped = false;
+
+    kpProfiler::Event lastEvents[kpProfiler::CategoryCount];
+    bool haveLastEvent[kpProfiler::CategoryCount] = {};
+};
+
+kpProfilerRingBuffer *RingBuffer()
+{
+    static kpProfilerRingBuffer ringBuffer;
+    return &ringBuffer;
+}
+
+const QElapsedTimer &Clock()
+{
+    static const QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock;
+}
+
+// Innermost active scope on this thread.
+thread_local kpProfilerScope *CurrentScope = nullptr;
+} // namespace
+
+//---------------------------------------------------------------------
+
+// public static
+void kpProfiler::setEnabled(bool yes)
+{
+#if DEBUG_KP_PROFILER
+    qCDebug(kpLogMisc) << "kpProfiler::setEnabled(" << yes << ")";
+#endif
+
+    // Start the clock before the first event, not during it.
+    (void)Clock();
+
+    s_enabled.store(yes, std::memory_order_relaxed);
+}
+
+//---------------------------------------------------------------------
+
+// public static
+void kpProfiler::initFromEnvironment()
+{
+    const QByteArray value = qgetenv("KOLOURPAINT_PROFILE");
+    if (!value.isEmpty() && value != "0") {
+        setEnabled(true);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public static
+void kpProfiler::clear()
+{
+    kpProfilerRingBuffer *rb = RingBuffer();
+    QMutexLocker locker(&rb->mutex);
+
+    rb->events.clear();
+    rb->next = 0;
+    rb->wrapped = false;
+
+    for (int i = 0; i < CategoryCount; i++) {
+        rb->haveLastEvent[i] = false;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QList<kpProfiler::Event> kpProfiler::events()
+{
+    kpProfilerRingBuffer *rb = RingBuffer();
+    QMutexLocker locker(&rb->mutex);
+
+    QList<Event> ret;
+    ret.reserve(static_cast<int>(rb->events.size()));
+
+    if (rb->wrapped) {
+        for (int i = rb->next; i < static_cast<int>(rb->events.size()); i++) {
+            ret.append(rb->events[i]);
+        }
+    }
+
+    for (int i = 0; i < rb->next; i++) {
+        ret.append(rb->events[i]);
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public static
+bool kpProfiler::lastEvent(Category category, Event *event)
+{
+    Q_ASSERT(category >= 0 && category < CategoryCount);
+    Q_ASSERT(event);
+
+    kpProfilerRingBuffer *rb = RingBuffer();
+    QMutexLocker locker(&rb->mutex);
+
+    if (!rb->haveLastEvent[category]) {
+        return false;
+    }
+
+    *event = rb->lastEvents[category];
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// public static
+const char *kpProfiler::categoryName(Category category)
+{
+    switch (category) {
+    case Paint:
+        return "paint";
+    case ToolDraw:
+        return "tool";
+    case CommandExecute:
+        return "execute";
+    case CommandUnexecute:
+        return "unexecute";
+    case Effect:
+        return "effect";
+    case CategoryCount:
+        break;
+    }
+
+    Q_ASSERT(!"Unknown category");
+    return "unknown";
+}
+
+//---------------------------------------------------------------------
+
+// public static
+qint64 kpProfiler::nowNsecs()
+{
+    return Clock().nsecsElapsed();
+}
+
+//---------------------------------------------------------------------
+
+// public static
+void kpProfiler::addCopy()
+{
+    if (CurrentScope) {
+        CurrentScope->addCopy();
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private static
+void kpProfiler::record(const Event &event)
+{
+    kpProfilerRingBuffer *rb = RingBuffer();
+    QMutexLocker locker(&rb->mutex);
+
+    if (static_cast<int>(rb->events.size()) < RingBufferCapacity) {
+        rb->events.push_back(event);
+    } else {
+        rb->events[rb->next] = event;
+    }
+
+    rb->next++;
+    if (rb->next == RingBufferCapacity) {
+        rb->next = 0;
+        rb->wrapped = true;
+    }
+
+    rb->lastEvents[event.category] = event;
+    rb->haveLastEvent[event.category] = true;
+}
+
+//---------------------------------------------------------------------
+
+// public static
+bool kpProfiler::exportChromeTrace(const QString &fileName, QString *errorMessage)
+{
+    Q_ASSERT(errorMessage);
+
+    const QList<Event> allEvents = events();
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    for (const Event &event : allEvents) {
+        QJsonObject args;
+        args.insert(QStringLiteral("pixels"), event.pixels);
+        args.insert(QStringLiteral("copies"), event.copies);
+        if (!event.detail.isEmpty()) {
+            args.insert(QStringLiteral("detail"), event.detail);
+        }
+
+        QJsonObject traceEvent;
+        traceEvent.insert(QStringLiteral("name"), QString::fromLatin1(event.name));
+        traceEvent.insert(QStringLiteral("cat"), QString::fromLatin1(categoryName(event.category)));
+        // "Complete" event - has both a start and a duration.
+        traceEvent.insert(QStringLiteral("ph"), QStringLiteral("X"));
+        // The format wants microseconds.
+        traceEvent.insert(QStringLiteral("ts"), double(event.startNsecs) / 1000.0);
+        traceEvent.insert(QStringLiteral("dur"), double(event.durationNsecs) / 1000.0);
+        traceEvent.insert(QStringLiteral("pid"), pid);
+        traceEvent.insert(QStringLiteral("tid"), static_cast<qint64>(event.threadId));
+        traceEvent.insert(QStringLiteral("args"), args);
+
+        traceEvents.append(traceEvent);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), traceEvents);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *errorMessage = i18n("Could not open \"%1\" for writing: %2", fileName, file.errorString());
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+
+    if (!file.commit()) {
+        *errorMessage = i18n("Could not save \"%1\": %2", fileName, file.errorString());
+        return false;
+    }
+
+#if DEBUG_KP_PROFILER
+    qCDebug(kpLogMisc) << "kpProfiler::exportChromeTrace() wrote" << allEvents.size() << "events to" << fileName;
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+
+// public
+void kpProfilerScope::setDetail(const QString &detail)
+{
+    if (m_active) {
+        m_event.detail = detail;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpProfilerScope::addPixels(qint64 pixels)
+{
+    if (m_active) {
+        m_event.pixels += pixels;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpProfilerScope::addCopy()
+{
+    if (m_active) {
+        m_event.copies++;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpProfilerScope::begin(kpProfiler::Category category, const char *name)
+{
+    m_event.category = category;
+    m_event.name = name;
+    m_event.pixels = 0;
+    m_event.copies = 0;
+    m_event.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    m_event.durationNsecs = 0;
+
+    m_parent = CurrentScope;
+    CurrentScope = this;
+
+    // Last, so that the bookkeeping above is not included in the timing.
+    m_event.startNsecs = kpProfiler::nowNsecs();
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpProfilerScope::end()
+{
+    m_event.durationNsecs = kpProfiler::nowNsecs() - m_event.startNsecs;
+
+    Q_ASSERT(CurrentScope == this);
+    CurrentScope = m_parent;
+
+    // Work done by nested scopes is also work done by us.
+    if (m_parent) {
+        m_parent->m_event.pixels += m_event.pixels;
+        m_parent->m_event.copies += m_event.copies;
+    }
+
+    kpProfiler::record(m_event);
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,162 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpProfiler_H
+#define kpProfiler_H
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+
+//
+// Always-available, low-overhead instrumentation of KolourPaint's hot paths
+// (view painting, tool drawing, command execution and effects).
+//
+// Unlike the DEBUG_KP_* timing blocks, this is compiled into normal builds.
+// When recording is disabled, a kpProfilerScope costs a single relaxed
+// atomic load.  When enabled, each scope appends one Event to a fixed-size
+// ring buffer, which can be shown by kpProfilerOverlay or exported as a
+// Chrome trace (load it in chrome://tracing or https://ui.perfetto.dev/).
+//
+// Recording is enabled by "Settings / Show Performance Overlay" or by
+// setting the environment variable KOLOURPAINT_PROFILE=1 before startup.
+//
+class kpProfiler
+{
+public:
+    enum Category {
+        Paint,
+        ToolDraw,
+        CommandExecute,
+        CommandUnexecute,
+        Effect,
+
+        CategoryCount
+    };
+
+    struct Event {
+        Category category;
+        // Static string e.g. a class name.
+        const char *name;
+        // Optional, more specific description e.g. a command's name().
+        QString detail;
+
+        qint64 startNsecs;
+        qint64 durationNsecs;
+
+        // Number of pixels read or written.
+        qint64 pixels;
+        // Number of deep image copies made.
+        int copies;
+
+        quintptr threadId;
+    };
+
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void setEnabled(bool yes);
+
+    // Enables recording if KOLOURPAINT_PROFILE is set in the environment.
+    static void initFromEnvironment();
+
+    static void clear();
+
+    // Returns all events in the ring buffer, oldest first.
+    static QList<Event> events();
+
+    // Returns the most recent event of <category> in <*event>.
+    // Returns false if there is none.
+    static bool lastEvent(Category category, Event *event);
+
+    static const char *categoryName(Category category);
+
+    // Nanoseconds since an arbitrary, fixed point in time.
+    static qint64 nowNsecs();
+
+    // Attribute a copy to the innermost active kpProfilerScope on the
+    // calling thread (if any).  This may be called from anywhere e.g.
+    // kpPixmapFX, without needing access to the scope object.
+    static void addCopy();
+
+    // Writes the ring buffer to <fileName> in the Chrome Trace Event
+    // format.  On error, returns false and sets <*errorMessage> to a
+    // user-visible explanation.
+    static bool exportChromeTrace(const QString &fileName, QString *errorMessage);
+
+private:
+    friend class kpProfilerScope;
+
+    static void record(const Event &event);
+
+    static std::atomic<bool> s_enabled;
+};
+
+//
+// Times the enclosing C++ scope and records it as a kpProfiler::Event.
+//
+// Example Usage:
+//
+//     void kpTool::drawInternal ()
+//     {
+//         kpProfilerScope profilerScope (kpProfiler::ToolDraw, "kpTool::draw");
+//
+//         draw (...);
+//
+//     }   // Stack unwinds, recording the event
+//
+// <name> must point to a string that outlives the program's use of
+// kpProfiler e.g. a string literal or QMetaObject::className().
+//
+class kpProfilerScope
+{
+public:
+    kpProfilerScope(kpProfiler::Category category, const char *name)
+        : m_active(kpProfiler::isEnabled())
+    {
+        if (m_active) {
+            begin(category, name);
+        }
+    }
+
+    ~kpProfilerScope()
+    {
+        if (m_active) {
+            end();
+        }
+    }
+
+    kpProfilerScope(const kpProfilerScope &) = delete;
+    kpProfilerScope &operator=(const kpProfilerScope &) = delete;
+
+    // Whether this scope is recording.  Check this before doing any
+    // expensive work to compute arguments to setDetail().
+    bool isActive() const
+    {
+        return m_active;
+    }
+
+    void setDetail(const QString &detail);
+
+    void addPixels(qint64 pixels);
+    void addCopy();
+
+private:
+    void begin(kpProfiler::Category category, const char *name);
+    void end();
+
+    friend class kpProfiler;
+
+    bool m_active;
+    kpProfiler::Event m_event;
+    kpProfilerScope *m_parent = nullptr;
+};
+
+#endif // kpProfiler_H
@@ -0,0 +1,123 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_SPILL_FILE 0
+
+#include "generic/kpSpillFile.h"
+
+#include <cstring>
+
+#include <QDir>
+
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+kpSpillFile::kpSpillFile()
+    : m_file(QDir::tempPath() + QLatin1String("/kolourpaint-spill-XXXXXX"))
+    , m_openFailed(false)
+{
+}
+
+//---------------------------------------------------------------------
+
+// private
+bool kpSpillFile::open()
+{
+    if (m_file.isOpen()) {
+        return true;
+    }
+
+    if (m_openFailed) {
+        return false;
+    }
+
+    if (!m_file.open()) {
+        qCWarning(kpLogMisc) << "kpSpillFile: could not create scratch file:" << m_file.errorString();
+        m_openFailed = true;
+        return false;
+    }
+
+#if DEBUG_KP_SPILL_FILE
+    qCDebug(kpLogMisc) << "kpSpillFile: created" << m_file.fileName();
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpSpillFile::Record kpSpillFile::append(const char *data, qint64 size)
+{
+    if (!open()) {
+        return {};
+    }
+
+    Record record;
+    record.offset = m_file.size();
+    record.size = size;
+
+    // (always append, even after a failed, partial write)
+    if (!m_file.seek(record.offset) || m_file.write(data, size) != size || !m_file.flush()) {
+        qCWarning(kpLogMisc) << "kpSpillFile: could not write" << size << "bytes:" << m_file.errorString();
+        return {};
+    }
+
+#if DEBUG_KP_SPILL_FILE
+    qCDebug(kpLogMisc) << "kpSpillFile::append() offset=" << record.offset << "size=" << size;
+#endif
+
+    return record;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpSpillFile::Record kpSpillFile::append(const QByteArray &data)
+{
+    return append(data.constData(), data.size());
+}
+
+//---------------------------------------------------------------------
+
+// public
+QByteArray kpSpillFile::read(const Record &record)
+{
+    if (!record.isValid() || !m_file.isOpen()) {
+        return {};
+    }
+
+    if (record.size == 0) {
+        return QByteArray("");
+    }
+
+    QByteArray ret(record.size, Qt::Uninitialized);
+
+    if (uchar *mapped = m_file.map(record.offset, record.size)) {
+        std::memcpy(ret.data(), mapped, record.size);
+        m_file.unmap(mapped);
+        return ret;
+    }
+
+    // Mapping is not supported everywhere.
+    if (!m_file.seek(record.offset) || m_file.read(ret.data(), record.size) != record.size) {
+        qCWarning(kpLogMisc) << "kpSpillFile: could not read" << record.size << "bytes at" << record.offset << ":" << m_file.errorString();
+        return {};
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+qint64 kpSpillFile::size() const
+{
+    return m_file.isOpen() ? m_file.size() : 0;
+}
+
+//---------------------------------------------------------------------
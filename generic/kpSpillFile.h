@@ -0,0 +1,61 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpSpillFile_H
+#define kpSpillFile_H
+
+#include <QByteArray>
+#include <QTemporaryFile>
+
+//
+// An append-only scratch file for data that is too big to keep in memory
+// but may still be needed (e.g. old undo snapshots).
+//
+// Data is written once, with append(), and read back through a memory
+// mapping of just the record asked for.  Nothing is ever removed: the file
+// is deleted, along with everything in it, when this object is destroyed.
+// To reclaim the space of records that are no longer needed, move the rest
+// to a new file (see kpCommandHistoryBase::compactSpillFile()).
+//
+// Not thread-safe.
+//
+class kpSpillFile
+{
+public:
+    struct Record {
+        qint64 offset = -1;
+        qint64 size = 0;
+
+        bool isValid() const
+        {
+            return offset >= 0;
+        }
+    };
+
+    kpSpillFile();
+
+    kpSpillFile(const kpSpillFile &) = delete;
+    kpSpillFile &operator=(const kpSpillFile &) = delete;
+
+    // Returns an invalid record if the data could not be written (e.g. the
+    // disk is full).
+    Record append(const char *data, qint64 size);
+    Record append(const QByteArray &data);
+
+    // Returns a null array if the record could not be read.
+    QByteArray read(const Record &record);
+
+    // Bytes written so far.
+    qint64 size() const;
+
+private:
+    bool open();
+
+    QTemporaryFile m_file;
+    bool m_openFailed;
+};
+
+#endif // kpSpillFile_H
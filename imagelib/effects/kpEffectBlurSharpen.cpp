@@ -13,6 +13,8 @@
 
 #include "pixmapfx/kpPixmapFX.h"
 
+#include <cmath>
+
 #if DEBUG_KP_EFFECT_BLUR_SHARPEN
 #include <QTime>
 #endif
@@ -34,21 +36,49 @@
 // </quote>
 //
 
+// The numbers that follow were picked by experimentation to try to get
+// an effect linearly proportional to <strength> and at the same time,
+// be fast enough.
+//
+// I still have no idea what "radius" and "sigma" mean.
+
+static int BlurRadius(int strength)
+{
+    const double RadiusMin = 1;
+    const double RadiusMax = 10;
+    return qRound(RadiusMin + (strength - 1) * (RadiusMax - RadiusMin) / (kpEffectBlurSharpen::MaxStrength - 1));
+}
+
+static double SharpenRadius(int strength)
+{
+    const double RadiusMin = 0.1;
+    const double RadiusMax = 2.5;
+    return RadiusMin + (strength - 1) * (RadiusMax - RadiusMin) / (kpEffectBlurSharpen::MaxStrength - 1);
+}
+
+static double SharpenSigma(int strength)
+{
+    const double SigmaMin = 0.5;
+    const double SigmaMax = 3.0;
+    return SigmaMin + (strength - 1) * (SigmaMax - SigmaMin) / (kpEffectBlurSharpen::MaxStrength - 1);
+}
+
+static int SharpenRepeat(int strength)
+{
+    const double RepeatMin = 1;
+    const double RepeatMax = 2;
+    return qRound(RepeatMin + (strength - 1) * (RepeatMax - RepeatMin) / (kpEffectBlurSharpen::MaxStrength - 1));
+}
+
+//---------------------------------------------------------------------
+
 static QImage BlurQImage(const QImage &qimage, int strength)
 {
     if (strength == 0) {
         return qimage;
     }
 
-    // The numbers that follow were picked by experimentation to try to get
-    // an effect linearly proportional to <strength> and at the same time,
-    // be fast enough.
-    //
-    // I still have no idea what "radius" means.
-
-    const double RadiusMin = 1;
-    const double RadiusMax = 10;
-    const double radius = RadiusMin + (strength - 1) * (RadiusMax - RadiusMin) / (kpEffectBlurSharpen::MaxStrength - 1);
+    const int radius = ::BlurRadius(strength);
 
 #if DEBUG_KP_EFFECT_BLUR_SHARPEN
     qCDebug(kpLogImagelib) << "kpEffectBlurSharpen.cpp:BlurQImage(strength=" << strength << ")"
@@ -56,7 +86,7 @@ static QImage BlurQImage(const QImage &qimage, int strength)
 #endif
 
     QImage img(qimage);
-    return Blitz::blur(img, qRound(radius));
+    return Blitz::blur(img, radius);
 }
 
 //---------------------------------------------------------------------
@@ -68,23 +98,9 @@ static QImage SharpenQImage(const QImage &qimage_, int strength)
         return qimage;
     }
 
-    // The numbers that follow were picked by experimentation to try to get
-    // an effect linearly proportional to <strength> and at the same time,
-    // be fast enough.
-    //
-    // I still have no idea what "radius" and "sigma" mean.
-
-    const double RadiusMin = 0.1;
-    const double RadiusMax = 2.5;
-    const double radius = RadiusMin + (strength - 1) * (RadiusMax - RadiusMin) / (kpEffectBlurSharpen::MaxStrength - 1);
-
-    const double SigmaMin = 0.5;
-    const double SigmaMax = 3.0;
-    const double sigma = SigmaMin + (strength - 1) * (SigmaMax - SigmaMin) / (kpEffectBlurSharpen::MaxStrength - 1);
-
-    const double RepeatMin = 1;
-    const double RepeatMax = 2;
-    const double repeat = qRound(RepeatMin + (strength - 1) * (RepeatMax - RepeatMin) / (kpEffectBlurSharpen::MaxStrength - 1));
+    const double radius = ::SharpenRadius(strength);
+    const double sigma = ::SharpenSigma(strength);
+    const int repeat = ::SharpenRepeat(strength);
 
 #if DEBUG_KP_EFFECT_BLUR_SHARPEN
     qCDebug(kpLogImagelib) << "kpEffectBlurSharpen.cpp:SharpenQImage(strength=" << strength << ")"
@@ -107,6 +123,28 @@ static QImage SharpenQImage(const QImage &qimage_, int strength)
 
 //---------------------------------------------------------------------
 
+// public static
+int kpEffectBlurSharpen::neighborhoodRadius(Type type, int strength)
+{
+    if (strength == 0) {
+        return 0;
+    }
+
+    switch (type) {
+    case Blur:
+        // (Blitz::blur() reads one pixel further to the right)
+        return ::BlurRadius(strength) + 1;
+    case Sharpen:
+        // (sync: Blitz::gaussianSharpen() with a positive radius)
+        return int(std::ceil(::SharpenRadius(strength))) * ::SharpenRepeat(strength);
+    default:
+        // MakeConfidential depends on the width of the image.
+        return -1;
+    }
+}
+
+//---------------------------------------------------------------------
+
 // public static
 kpImage kpEffectBlurSharpen::applyEffect(const kpImage &image, Type type, int strength)
 {
@@ -29,6 +29,10 @@ public:
     // <strength> = strength of the effect
     //              (must be between MinStrength and MaxStrength inclusive)
     static kpImage applyEffect(const kpImage &image, Type type, int strength);
+
+    // Returns how many pixels around each pixel are read to compute it, or
+    // -1 if the result depends on the whole image.
+    static int neighborhoodRadius(Type type, int strength);
 };
 
 #endif // kpEffectBlurSharpen_H
@@ -12,6 +12,8 @@
 
 #include "kpLogCategories.h"
 
+#include "imagelib/kpColorQuantizer.h"
+
 //---------------------------------------------------------------------
 
 static QImage::Format DepthToFormat(int depth)
@@ -67,75 +69,25 @@ QImage kpEffectReduceColors::convertImageDepth(const QImage &image, int depth, b
     }
 #endif
 
-    // Hack around Qt's braindead QImage::convertToFormat(QImage::Format_MonoLSB, ...)
-    // (with dithering off) which produces pathetic results with an image that
-    // only has 2 colors - sometimes it just gives a completely black
-    // result (try yellow and white as input).  Instead, we simply preserve
-    // the 2 colors.
-    //
-    // One use case is resaving a "color monochrome" image (<= 2 colors but
-    // not necessarily black & white).
-    if (depth == 1 && !dither) {
-#if DEBUG_KP_EFFECT_REDUCE_COLORS
-        qCDebug(kpLogImagelib) << "\tinvoking convert-to-depth 1 hack";
-#endif
-        QRgb color0 = 0, color1 = 0;
-        bool color0Valid = false, color1Valid = false;
-
-        bool moreThan2Colors = false;
-
-        QImage monoImage(image.width(), image.height(), QImage::Format_MonoLSB);
-        monoImage.setColorCount(2);
-#if DEBUG_KP_EFFECT_REDUCE_COLORS
-        qCDebug(kpLogImagelib) << "\t\tinitialising output image w=" << monoImage.width() << ",h=" << monoImage.height() << ",d=" << monoImage.depth();
-#endif
-        for (int y = 0; y < image.height(); y++) {
-            for (int x = 0; x < image.width(); x++) {
-                // (this can be transparent)
-                QRgb imagePixel = image.pixel(x, y);
-
-                if (color0Valid && imagePixel == color0) {
-                    monoImage.setPixel(x, y, 0);
-                } else if (color1Valid && imagePixel == color1) {
-                    monoImage.setPixel(x, y, 1);
-                } else if (!color0Valid) {
-                    color0 = imagePixel;
-                    color0Valid = true;
-                    monoImage.setPixel(x, y, 0);
-#if DEBUG_KP_EFFECT_REDUCE_COLORS
-                    qCDebug(kpLogImagelib) << "\t\t\tcolor0=" << (int *)color0 << " at x=" << x << ",y=" << y;
-#endif
-                } else if (!color1Valid) {
-                    color1 = imagePixel;
-                    color1Valid = true;
-                    monoImage.setPixel(x, y, 1);
-#if DEBUG_KP_EFFECT_REDUCE_COLORS
-                    qCDebug(kpLogImagelib) << "\t\t\tcolor1=" << (int *)color1 << " at x=" << x << ",y=" << y;
-#endif
-                } else {
-#if DEBUG_KP_EFFECT_REDUCE_COLORS
-                    qCDebug(kpLogImagelib) << "\t\t\timagePixel=" << (int *)imagePixel << " at x=" << x << ",y=" << y << " moreThan2Colors - abort hack";
-#endif
-                    moreThan2Colors = true;
-
-                    // Dijkstra, this is clearer than double break'ing or
-                    // a check in both loops
-                    goto exit_loop;
-                }
-            }
-        }
-    exit_loop:
-
-        if (!moreThan2Colors) {
-            monoImage.setColor(0, color0Valid ? color0 : 0xFFFFFF);
-            monoImage.setColor(1, color1Valid ? color1 : 0x000000);
-            return monoImage;
-        }
+    QImage retImage;
+
+    if (depth == 1) {
+        // Qt's QImage::convertToFormat(QImage::Format_MonoLSB, ...) (with
+        // dithering off) produces pathetic results with an image that only
+        // has 2 colors - sometimes it just gives a completely black result
+        // (try yellow and white as input).  Instead, we simply preserve the
+        // 2 colors.
+        //
+        // One use case is resaving a "color monochrome" image (<= 2 colors
+        // but not necessarily black & white).
+        retImage = kpColorQuantizer::toMonochrome(image, dither, !dither /*keep 2 colors*/);
+    } else if (depth == 8) {
+        retImage = kpColorQuantizer::toIndexed8(image, dither);
+    } else {
+        retImage = image.convertToFormat(::DepthToFormat(depth),
+                                         Qt::AutoColor | (dither ? Qt::DiffuseDither : Qt::ThresholdDither) | Qt::ThresholdAlphaDither
+                                             | (dither ? Qt::PreferDither : Qt::AvoidDither));
     }
-
-    QImage retImage = image.convertToFormat(::DepthToFormat(depth),
-                                            Qt::AutoColor | (dither ? Qt::DiffuseDither : Qt::ThresholdDither) | Qt::ThresholdAlphaDither
-                                                | (dither ? Qt::PreferDither : Qt::AvoidDither));
 #if DEBUG_KP_EFFECT_REDUCE_COLORS
     qCDebug(kpLogImagelib) << "\tformat: before=" << image.format() << "after=" << retImage.format();
 #endif
@@ -20,6 +20,8 @@ public:
     //
     //            Also, this can increase the image depth while applyEffect()
     //            will not.
+    //
+    // Depths 1 and 8 are converted by kpColorQuantizer.
     static QImage convertImageDepth(const QImage &image, int depth, bool dither);
 
     static void applyEffect(QImage *destPixmapPtr, int depth, bool dither);
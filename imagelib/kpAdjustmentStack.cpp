@@ -0,0 +1,349 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_ADJUSTMENT_STACK 0
+
+#include "imagelib/kpAdjustmentStack.h"
+
+#include <QDataStream>
+#include <QHashFunctions>
+#include <QMutexLocker>
+#include <QPainter>
+
+#include "generic/kpParallel.h"
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+// Width and height of the tiles that adjustments are evaluated in.
+static const int TileSize = 256;
+
+// Pixels of context given around each tile regardless of the margin of
+// the adjustment (sync: kpEffectCommandBase::applyEffectAt()).
+static const int MinMargin = 8;
+
+// Kilobytes of evaluated tiles to keep.
+static const int CacheMaxKB = 128 * 1024;
+
+//---------------------------------------------------------------------
+
+// Everything needed to evaluate the adjustments, taken under the mutex at
+// the start of kpAdjustmentStack::imageAt().
+struct kpAdjustmentStack::Evaluation {
+    kpImage image;
+    kpAdjustmentList adjustments;
+    std::vector<quint64> stackKeys;
+};
+
+//---------------------------------------------------------------------
+
+// public
+quint64 kpAdjustment::key() const
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << effect << settings;
+
+    return qHash(bytes);
+}
+
+//---------------------------------------------------------------------
+
+size_t qHash(const kpAdjustmentStack::TileKey &key, size_t seed)
+{
+    return qHashMulti(seed, key.stackKey, key.depth, key.x, key.y);
+}
+
+//---------------------------------------------------------------------
+
+// Returns the rectangle of tile (<tileX>, <tileY>) in an image of <size>.
+static QRect TileRect(int tileX, int tileY, const QSize &size)
+{
+    return QRect(tileX * TileSize, tileY * TileSize, TileSize, TileSize) & QRect(QPoint(0, 0), size);
+}
+
+//---------------------------------------------------------------------
+
+static int Margin(const kpAdjustment &adjustment)
+{
+    return qMax(adjustment.margin, MinMargin);
+}
+
+//---------------------------------------------------------------------
+
+// Returns the part <rect> of an image of <size>, given <results>, the
+// evaluated tiles at the positions <tiles> that cover <rect>.
+static kpImage Assemble(const QRect &rect, const std::vector<QPoint> &tiles, const std::vector<kpImage> &results, const QSize &size)
+{
+    // Only one tile?  Avoid the copy, if it is exactly what is wanted.
+    if (tiles.size() == 1) {
+        const QRect tileRect = ::TileRect(tiles[0].x(), tiles[0].y(), size);
+        return tileRect == rect ? results[0] : results[0].copy(rect.translated(-tileRect.topLeft()));
+    }
+
+    kpImage ret(rect.size(), results.front().format());
+    ret.setDotsPerMeterX(results.front().dotsPerMeterX());
+    ret.setDotsPerMeterY(results.front().dotsPerMeterY());
+
+    QPainter painter(&ret);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        const QRect tileRect = ::TileRect(tiles[i].x(), tiles[i].y(), size);
+        painter.drawImage(tileRect.topLeft() - rect.topLeft(), results[i]);
+    }
+    painter.end();
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+kpAdjustmentStack::kpAdjustmentStack()
+    : m_stackKeys(1, 0)
+    , m_cache(CacheMaxKB)
+{
+}
+
+//---------------------------------------------------------------------
+
+kpAdjustmentStack::~kpAdjustmentStack() = default;
+
+//---------------------------------------------------------------------
+
+// public
+kpAdjustmentList kpAdjustmentStack::adjustments() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_adjustments;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpAdjustmentStack::setAdjustments(const kpAdjustmentList &adjustments)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_adjustments = adjustments;
+
+    // (tiles for the old keys stay cached, in case they are wanted again)
+    m_stackKeys.assign(1, 0);
+    for (const kpAdjustment &adjustment : adjustments) {
+        m_stackKeys.push_back(qHashMulti(m_stackKeys.back(), adjustment.key()));
+    }
+
+#if DEBUG_KP_ADJUSTMENT_STACK
+    qCDebug(kpLogImagelib) << "kpAdjustmentStack::setAdjustments() count=" << adjustments.size() << "cachedKB=" << m_cache.totalCost();
+#endif
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpAdjustmentStack::isEmpty() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_adjustments.isEmpty();
+}
+
+//---------------------------------------------------------------------
+
+// public
+QRect kpAdjustmentStack::imageChanged(const QRect &rect)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // How far the change reaches at each depth, or -1 for everywhere.
+    std::vector<int> reach(m_adjustments.size() + 1, 0);
+    for (int depth = 1; depth < int(reach.size()); depth++) {
+        const kpAdjustment &adjustment = m_adjustments[depth - 1];
+        reach[depth] = (reach[depth - 1] < 0 || adjustment.margin < 0) ? -1 : reach[depth - 1] + ::Margin(adjustment);
+    }
+
+    const QList<TileKey> keys = m_cache.keys();
+    for (const TileKey &key : keys) {
+        // Evaluated for other adjustments?  Whether or not they are affected,
+        // they can no longer be checked.
+        if (key.depth >= int(m_stackKeys.size()) || m_stackKeys[key.depth] != key.stackKey) {
+            m_cache.remove(key);
+            continue;
+        }
+
+        const int r = reach[key.depth];
+        if (r < 0 || key.x < 0 || ::TileRect(key.x, key.y, m_imageSize).intersects(rect.adjusted(-r, -r, r, r))) {
+            m_cache.remove(key);
+        }
+    }
+
+    const int r = reach.back();
+    return (r < 0) ? QRect(QPoint(0, 0), m_imageSize) : rect.adjusted(-r, -r, r, r);
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpImage kpAdjustmentStack::imageAt(const kpImage &image, const QRect &rect)
+{
+    Evaluation ev;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (image.size() != m_imageSize) {
+            m_cache.clear();
+            m_imageSize = image.size();
+        }
+
+        ev.image = image;
+        ev.adjustments = m_adjustments;
+        ev.stackKeys = m_stackKeys;
+    }
+
+    const int depth = int(ev.adjustments.size());
+    const QRect wantedRect = rect & image.rect();
+    if (depth == 0 || wantedRect.isEmpty()) {
+        return image.copy(wantedRect);
+    }
+
+    // Evaluate the adjustments that need the whole image first, so that
+    // the tiles evaluated concurrently below only read them.
+    for (int d = 1; d <= depth; d++) {
+        if (ev.adjustments[d - 1].margin < 0) {
+            wholeImage(ev, d);
+        }
+    }
+
+    std::vector<QPoint> tiles;
+    for (int tileY = wantedRect.top() / TileSize; tileY <= wantedRect.bottom() / TileSize; tileY++) {
+        for (int tileX = wantedRect.left() / TileSize; tileX <= wantedRect.right() / TileSize; tileX++) {
+            tiles.emplace_back(tileX, tileY);
+        }
+    }
+
+    std::vector<kpImage> results(tiles.size());
+    kpParallelFor(int(tiles.size()), 1, [this, &ev, &tiles, &results, depth](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            results[i] = tile(ev, tiles[i].x(), tiles[i].y(), depth);
+        }
+    });
+
+    return ::Assemble(wantedRect, tiles, results, image.size());
+}
+
+//---------------------------------------------------------------------
+
+// private
+kpImage kpAdjustmentStack::region(const Evaluation &ev, const QRect &rect, int depth)
+{
+    if (depth == 0) {
+        return ev.image.copy(rect);
+    }
+
+    std::vector<QPoint> tiles;
+    std::vector<kpImage> results;
+    for (int tileY = rect.top() / TileSize; tileY <= rect.bottom() / TileSize; tileY++) {
+        for (int tileX = rect.left() / TileSize; tileX <= rect.right() / TileSize; tileX++) {
+            tiles.emplace_back(tileX, tileY);
+            results.push_back(tile(ev, tileX, tileY, depth));
+        }
+    }
+
+    return ::Assemble(rect, tiles, results, ev.image.size());
+}
+
+//---------------------------------------------------------------------
+
+// private
+kpImage kpAdjustmentStack::tile(const Evaluation &ev, int tileX, int tileY, int depth)
+{
+    const TileKey key{ev.stackKeys[depth], depth, tileX, tileY};
+
+    kpImage ret;
+    if (cached(key, &ret)) {
+        return ret;
+    }
+
+    const kpAdjustment &adjustment = ev.adjustments[depth - 1];
+    const QRect tileRect = ::TileRect(tileX, tileY, ev.image.size());
+
+    if (adjustment.margin < 0) {
+        ret = wholeImage(ev, depth).copy(tileRect);
+    } else {
+        const int margin = ::Margin(adjustment);
+        const QRect sourceRect = tileRect.adjusted(-margin, -margin, margin, margin) & ev.image.rect();
+
+        ret = adjustment.apply(region(ev, sourceRect, depth - 1)).copy(tileRect.translated(-sourceRect.topLeft()));
+    }
+
+    insert(key, ret, ev.image.size());
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// private
+kpImage kpAdjustmentStack::wholeImage(const Evaluation &ev, int depth)
+{
+    const TileKey key{ev.stackKeys[depth], depth, -1, -1};
+
+    kpImage ret;
+    if (cached(key, &ret)) {
+        return ret;
+    }
+
+#if DEBUG_KP_ADJUSTMENT_STACK
+    qCDebug(kpLogImagelib) << "kpAdjustmentStack::wholeImage() depth=" << depth;
+#endif
+
+    ret = ev.adjustments[depth - 1].apply(region(ev, ev.image.rect(), depth - 1));
+
+    insert(key, ret, ev.image.size());
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// private
+bool kpAdjustmentStack::cached(const TileKey &key, kpImage *image) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (const kpImage *cachedImage = m_cache.object(key)) {
+        *image = *cachedImage;
+        return true;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpAdjustmentStack::insert(const TileKey &key, const kpImage &image, const QSize &imageSize)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Evaluated for an image that has since been resized?
+    if (image.isNull() || imageSize != m_imageSize) {
+        return;
+    }
+
+    m_cache.insert(key, new kpImage(image), qMax(qsizetype(1), image.sizeInBytes() / 1024));
+}
+
+//---------------------------------------------------------------------
+
+// public static
+kpImage kpAdjustmentStack::Flatten(const kpImage &image, const kpAdjustmentList &adjustments)
+{
+    kpImage ret = image;
+    for (const kpAdjustment &adjustment : adjustments) {
+        ret = adjustment.apply(ret);
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,127 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpAdjustmentStack_H
+#define kpAdjustmentStack_H
+
+#include <functional>
+#include <vector>
+
+#include <QCache>
+#include <QList>
+#include <QMutex>
+#include <QRect>
+#include <QString>
+#include <QVariantList>
+
+#include "imagelib/kpImage.h"
+
+//
+// An effect, with its settings, that is shown on top of the document
+// without changing its pixels.
+//
+struct kpAdjustment {
+    // User-visible e.g. "Balance".
+    QString name;
+
+    // The effect and its settings, as understood by kpEffectsDialog (to
+    // edit the adjustment again).  Together, they identify the adjustment
+    // in the cache of a kpAdjustmentStack.
+    int effect = -1;
+    QVariantList settings;
+
+    // As kpEffectCommandBase::tileMargin().
+    int margin = -1;
+
+    // Applies the effect.  Must be safe to call concurrently if <margin>
+    // is not -1.
+    std::function<kpImage(const kpImage &image)> apply;
+
+    quint64 key() const;
+};
+
+using kpAdjustmentList = QList<kpAdjustment>;
+
+//
+// An ordered list of adjustments on top of an image (the document's),
+// evaluated lazily: imageAt() only computes the tiles of each adjustment
+// needed for the rectangle asked for (e.g. what a view is showing), plus
+// the margin each adjustment reads around them.
+//
+// Evaluated tiles are cached, keyed by a hash of the adjustments up to
+// and including the one applied, so that changing the settings of one
+// adjustment keeps the tiles of those before it, and going back to
+// earlier settings finds the tiles evaluated for them.
+//
+// Adjustments that cannot be applied to part of an image (margin -1) are
+// applied to the whole image, once, and their result cached too.
+//
+// Thread-safe.
+//
+class kpAdjustmentStack
+{
+public:
+    kpAdjustmentStack();
+    ~kpAdjustmentStack();
+
+    kpAdjustmentStack(const kpAdjustmentStack &) = delete;
+    kpAdjustmentStack &operator=(const kpAdjustmentStack &) = delete;
+
+    kpAdjustmentList adjustments() const;
+    void setAdjustments(const kpAdjustmentList &adjustments);
+
+    bool isEmpty() const;
+
+    // Call this after changing the pixels of the image at <rect>.  Returns
+    // the part of the adjusted image that has changed as a result, which
+    // can be larger than <rect> (e.g. after a blur).
+    QRect imageChanged(const QRect &rect);
+
+    // Returns the part <rect> of <image> with the adjustments applied.
+    kpImage imageAt(const kpImage &image, const QRect &rect);
+
+    // Applies <adjustments> to the whole of <image>, in order, without
+    // any caching (e.g. for saving).
+    static kpImage Flatten(const kpImage &image, const kpAdjustmentList &adjustments);
+
+private:
+    struct TileKey {
+        quint64 stackKey;
+        int depth;
+        // (-1, -1) for the whole image
+        int x, y;
+
+        bool operator==(const TileKey &other) const
+        {
+            return stackKey == other.stackKey && depth == other.depth && x == other.x && y == other.y;
+        }
+    };
+    friend size_t qHash(const TileKey &key, size_t seed);
+
+    struct Evaluation;
+
+    // Returns the part <rect> of the image with the first <depth>
+    // adjustments applied.
+    kpImage region(const Evaluation &ev, const QRect &rect, int depth);
+    kpImage tile(const Evaluation &ev, int tileX, int tileY, int depth);
+    kpImage wholeImage(const Evaluation &ev, int depth);
+
+    bool cached(const TileKey &key, kpImage *image) const;
+    // <imageSize> is the size of the image <image> was evaluated from.
+    void insert(const TileKey &key, const kpImage &image, const QSize &imageSize);
+
+    mutable QMutex m_mutex;
+
+    kpAdjustmentList m_adjustments;
+    // m_stackKeys[d] identifies the first <d> adjustments.
+    std::vector<quint64> m_stackKeys;
+
+    QSize m_imageSize;
+
+    QCache<TileKey, kpImage> m_cache;
+};
+
+#endif // kpAdjustmentStack_H
@@ -0,0 +1,699 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_COLOR_QUANTIZER 0
+
+#include "imagelib/kpColorQuantizer.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+
+#include "kpLogCategories.h"
+
+#include "generic/kpParallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+//---------------------------------------------------------------------
+
+// The histogram and the nearest palette color lookup table bin colors by
+// the top <HistogramBits> bits of each channel.
+static const int HistogramBits = 5;
+static const int HistogramSize = 1 << (3 * HistogramBits);
+
+// When quantizing, pixels with an alpha below this become transparent and
+// the rest become opaque (like Qt::ThresholdAlphaDither).
+static const int AlphaThreshold = 128;
+
+// Rows per kpParallelFor() chunk for the simple per-pixel passes.
+static const int RowGrainSize = 32;
+
+static inline int HistogramIndex(int r, int g, int b)
+{
+    const int shift = 8 - HistogramBits;
+    return ((r >> shift) << (2 * HistogramBits)) | ((g >> shift) << HistogramBits) | (b >> shift);
+}
+
+//---------------------------------------------------------------------
+
+// Returns <image> in a 32-bit format that ReadPixel() understands.
+static QImage To32Bit(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_RGB32: // (alpha byte is always 0xFF)
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return image;
+
+    default:
+        return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Returns the non-premultiplied ARGB value of the raw pixel <raw> of an
+// image returned by To32Bit().
+static inline QRgb ReadPixel(QRgb raw, bool premultiplied)
+{
+    return premultiplied ? qUnpremultiply(raw) : raw;
+}
+
+//---------------------------------------------------------------------
+
+// Sets the pixel <x> of the palette-based scan line <line> to <index>.
+// For monochrome images, <line> must start out zeroed.
+static inline void SetIndex(uchar *line, int x, int index, bool mono)
+{
+    if (mono) {
+        if (index) {
+            line[x >> 3] |= uchar(1 << (x & 7));
+        }
+    } else {
+        line[x] = uchar(index);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Copies what QImage::convertToFormat() would have copied, other than the
+// pixels.
+static void CopyMetaData(const QImage &src, QImage *dest)
+{
+    dest->setDotsPerMeterX(src.dotsPerMeterX());
+    dest->setDotsPerMeterY(src.dotsPerMeterY());
+    dest->setOffset(src.offset());
+
+    const QStringList keys = src.textKeys();
+    for (const QString &key : keys) {
+        dest->setText(key, src.text(key));
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Collects the distinct (non-premultiplied) colors of the 32-bit <image>
+// into <*colors>, in ascending order.
+//
+// Returns false, as soon as it is known, if there are more than <maxColors>.
+static bool ExactColors(const QImage &image, int maxColors, QList<QRgb> *colors)
+{
+    const bool premultiplied = (image.format() == QImage::Format_ARGB32_Premultiplied);
+    const int width = image.width();
+    const uchar *const bits = image.constBits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+
+    QMutex mutex;
+    std::vector<QRgb> allColors;
+    std::atomic<bool> tooMany{false};
+
+    ::kpParallelFor(image.height(), RowGrainSize, [&](int beginRow, int endRow) {
+        // Sorted, so that lookups are a binary search.
+        std::vector<QRgb> found;
+        found.reserve(maxColors + 1);
+
+        QRgb lastRaw = 0;
+        bool haveLast = false;
+
+        for (int y = beginRow; y < endRow; y++) {
+            if (tooMany.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            const auto *line = reinterpret_cast<const QRgb *>(bits + y * bytesPerLine);
+            for (int x = 0; x < width; x++) {
+                // Most images have runs of the same color.
+                if (haveLast && line[x] == lastRaw) {
+                    continue;
+                }
+                lastRaw = line[x];
+                haveLast = true;
+
+                const QRgb pixel = ::ReadPixel(lastRaw, premultiplied);
+                const auto it = std::lower_bound(found.begin(), found.end(), pixel);
+                if (it == found.end() || *it != pixel) {
+                    if (static_cast<int>(found.size()) == maxColors) {
+                        tooMany.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+
+                    found.insert(it, pixel);
+                }
+            }
+        }
+
+        QMutexLocker locker(&mutex);
+
+        std::vector<QRgb> merged;
+        merged.reserve(allColors.size() + found.size());
+        std::set_union(allColors.begin(), allColors.end(), found.begin(), found.end(), std::back_inserter(merged));
+        allColors.swap(merged);
+
+        if (static_cast<int>(allColors.size()) > maxColors) {
+            tooMany.store(true, std::memory_order_relaxed);
+        }
+    });
+
+    if (tooMany.load()) {
+        return false;
+    }
+
+    *colors = QList<QRgb>(allColors.begin(), allColors.end());
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// Returns the number of pixels of the 32-bit <image> in each histogram bin,
+// not counting the pixels that are less than half opaque.  Those are
+// counted in <*transparentCount> instead.
+static std::vector<quint32> BuildHistogram(const QImage &image, qint64 *transparentCount)
+{
+    const bool premultiplied = (image.format() == QImage::Format_ARGB32_Premultiplied);
+    const int width = image.width();
+    const uchar *const bits = image.constBits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+
+    QMutex mutex;
+    std::vector<quint32> histogram(HistogramSize, 0);
+    *transparentCount = 0;
+
+    ::kpParallelFor(image.height(), RowGrainSize, [&](int beginRow, int endRow) {
+        std::vector<quint32> counts(HistogramSize, 0);
+        qint64 transparent = 0;
+
+        for (int y = beginRow; y < endRow; y++) {
+            const auto *line = reinterpret_cast<const QRgb *>(bits + y * bytesPerLine);
+            for (int x = 0; x < width; x++) {
+                const QRgb pixel = ::ReadPixel(line[x], premultiplied);
+                if (qAlpha(pixel) < AlphaThreshold) {
+                    transparent++;
+                } else {
+                    counts[::HistogramIndex(qRed(pixel), qGreen(pixel), qBlue(pixel))]++;
+                }
+            }
+        }
+
+        QMutexLocker locker(&mutex);
+
+        for (int i = 0; i < HistogramSize; i++) {
+            histogram[i] += counts[i];
+        }
+        *transparentCount += transparent;
+    });
+
+    return histogram;
+}
+
+//---------------------------------------------------------------------
+
+struct kpColorQuantizerBin {
+    // Coordinates of the histogram bin, for each of red, green and blue.
+    int channel[3];
+    quint32 count;
+};
+
+struct kpColorQuantizerBox {
+    // Range of bins in the vector of kpColorQuantizerBin.
+    int begin, end;
+
+    quint64 count;
+    // (max - min) of the bins' coordinates, for each channel
+    int extent[3];
+};
+
+static void ComputeBox(const std::vector<kpColorQuantizerBin> &bins, kpColorQuantizerBox *box)
+{
+    int minimum[3] = {INT_MAX, INT_MAX, INT_MAX};
+    int maximum[3] = {-1, -1, -1};
+
+    box->count = 0;
+    for (int i = box->begin; i < box->end; i++) {
+        for (int c = 0; c < 3; c++) {
+            minimum[c] = std::min(minimum[c], bins[i].channel[c]);
+            maximum[c] = std::max(maximum[c], bins[i].channel[c]);
+        }
+        box->count += bins[i].count;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        box->extent[c] = maximum[c] - minimum[c];
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Returns a palette of at most <maxColors> colors for <histogram>.
+static QList<QRgb> MedianCut(const std::vector<quint32> &histogram, int maxColors)
+{
+    std::vector<kpColorQuantizerBin> bins;
+    for (int i = 0; i < HistogramSize; i++) {
+        if (histogram[i]) {
+            bins.push_back({{i >> (2 * HistogramBits), (i >> HistogramBits) & ((1 << HistogramBits) - 1), i & ((1 << HistogramBits) - 1)}, histogram[i]});
+        }
+    }
+
+    if (bins.empty()) {
+        return {};
+    }
+
+    std::vector<kpColorQuantizerBox> boxes;
+    boxes.reserve(maxColors);
+
+    kpColorQuantizerBox wholeBox;
+    wholeBox.begin = 0;
+    wholeBox.end = static_cast<int>(bins.size());
+    ::ComputeBox(bins, &wholeBox);
+    boxes.push_back(wholeBox);
+
+    while (static_cast<int>(boxes.size()) < maxColors) {
+        // Split the most populous boxes first, so that large areas of
+        // similar color get enough shades.  Then take volume into account
+        // too, so that small areas of very different color are not lost.
+        const bool byVolume = (static_cast<int>(boxes.size()) >= maxColors / 2);
+
+        int best = -1;
+        double bestPriority = 0;
+        for (int i = 0; i < static_cast<int>(boxes.size()); i++) {
+            const kpColorQuantizerBox &box = boxes[i];
+            if (box.end - box.begin < 2) {
+                continue;
+            }
+
+            double priority = double(box.count);
+            if (byVolume) {
+                priority *= double(box.extent[0] + 1) * double(box.extent[1] + 1) * double(box.extent[2] + 1);
+            }
+
+            if (priority > bestPriority) {
+                best = i;
+                bestPriority = priority;
+            }
+        }
+
+        if (best < 0) {
+            // Every box is down to a single bin.
+            break;
+        }
+
+        kpColorQuantizerBox box = boxes[best];
+
+        const int channel = int(std::max_element(box.extent, box.extent + 3) - box.extent);
+        std::sort(bins.begin() + box.begin, bins.begin() + box.end, [channel](const kpColorQuantizerBin &a, const kpColorQuantizerBin &b) {
+            return a.channel[channel] < b.channel[channel];
+        });
+
+        // Split at the median pixel, leaving at least 1 bin on each side.
+        int middle = box.begin + 1;
+        quint64 count = 0;
+        for (int i = box.begin; i < box.end - 1; i++) {
+            count += bins[i].count;
+            middle = i + 1;
+            if (count * 2 >= box.count) {
+                break;
+            }
+        }
+
+        kpColorQuantizerBox lowerBox;
+        lowerBox.begin = box.begin;
+        lowerBox.end = middle;
+        ::ComputeBox(bins, &lowerBox);
+
+        kpColorQuantizerBox upperBox;
+        upperBox.begin = middle;
+        upperBox.end = box.end;
+        ::ComputeBox(bins, &upperBox);
+
+        boxes[best] = lowerBox;
+        boxes.push_back(upperBox);
+    }
+
+    // Each box contributes the average color of its pixels, using the
+    // centers of their bins.
+    const int shift = 8 - HistogramBits;
+    const int binCenter = 1 << (shift - 1);
+
+    QList<QRgb> palette;
+    palette.reserve(static_cast<int>(boxes.size()));
+    for (const kpColorQuantizerBox &box : boxes) {
+        quint64 sum[3] = {0, 0, 0};
+        for (int i = box.begin; i < box.end; i++) {
+            for (int c = 0; c < 3; c++) {
+                sum[c] += quint64((bins[i].channel[c] << shift) + binCenter) * bins[i].count;
+            }
+        }
+
+        palette.append(qRgb(int((sum[0] + box.count / 2) / box.count), int((sum[1] + box.count / 2) / box.count), int((sum[2] + box.count / 2) / box.count)));
+    }
+
+#if DEBUG_KP_COLOR_QUANTIZER
+    qCDebug(kpLogImagelib) << "MedianCut() bins=" << bins.size() << "maxColors=" << maxColors << "-> palette size=" << palette.size();
+#endif
+
+    return palette;
+}
+
+//---------------------------------------------------------------------
+
+// Returns, for each histogram bin, the index of the nearest color in
+// <palette> (which must not be empty).
+static std::vector<uchar> NearestColorTable(const QList<QRgb> &palette)
+{
+    Q_ASSERT(!palette.isEmpty() && palette.size() <= 256);
+
+    std::vector<uchar> table(HistogramSize);
+
+    const int shift = 8 - HistogramBits;
+    const int binCenter = 1 << (shift - 1);
+    const int channelMask = (1 << HistogramBits) - 1;
+
+    ::kpParallelFor(HistogramSize, 1024, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const int r = (((i >> (2 * HistogramBits)) & channelMask) << shift) + binCenter;
+            const int g = (((i >> HistogramBits) & channelMask) << shift) + binCenter;
+            const int b = ((i & channelMask) << shift) + binCenter;
+
+            int bestIndex = 0;
+            int bestDistance = INT_MAX;
+            for (int p = 0; p < palette.size(); p++) {
+                const int dr = r - qRed(palette[p]);
+                const int dg = g - qGreen(palette[p]);
+                const int db = b - qBlue(palette[p]);
+                const int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance) {
+                    bestIndex = p;
+                    bestDistance = distance;
+                }
+            }
+
+            table[i] = uchar(bestIndex);
+        }
+    });
+
+    return table;
+}
+
+//---------------------------------------------------------------------
+
+// Sets each pixel of the palette-based <*dest> to <indexOf>(the
+// non-premultiplied color of the same pixel in the 32-bit <src>).
+template<typename IndexFunction>
+static void MapPixels(const QImage &src, QImage *dest, IndexFunction indexOf)
+{
+    const bool premultiplied = (src.format() == QImage::Format_ARGB32_Premultiplied);
+    const bool mono = (dest->format() == QImage::Format_MonoLSB);
+    const int width = src.width();
+
+    const uchar *const srcBits = src.constBits();
+    const qsizetype srcBytesPerLine = src.bytesPerLine();
+    uchar *const destBits = dest->bits();
+    const qsizetype destBytesPerLine = dest->bytesPerLine();
+
+    ::kpParallelFor(src.height(), RowGrainSize, [&](int beginRow, int endRow) {
+        QRgb lastRaw = 0;
+        int lastIndex = -1;
+
+        for (int y = beginRow; y < endRow; y++) {
+            const auto *srcLine = reinterpret_cast<const QRgb *>(srcBits + y * srcBytesPerLine);
+            uchar *const destLine = destBits + y * destBytesPerLine;
+
+            for (int x = 0; x < width; x++) {
+                if (lastIndex < 0 || srcLine[x] != lastRaw) {
+                    lastRaw = srcLine[x];
+                    lastIndex = indexOf(::ReadPixel(lastRaw, premultiplied));
+                }
+
+                ::SetIndex(destLine, x, lastIndex, mono);
+            }
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
+// Sets each pixel of the palette-based <*dest> to the index, into
+// <palette>, of the same pixel in the 32-bit <src> with Floyd-Steinberg
+// error diffusion.  <nearest>(r, g, b) must return the index of the
+// nearest color in <palette>.
+//
+// If <transparentIndex> is not -1, pixels less than half opaque are set to
+// it and take no part in error diffusion.
+//
+// Error diffusion is sequential but only flows rightwards and downwards, so
+// the pixel (x, y) only depends on the pixels of the row above up to x + 1.
+// Rows are therefore handed out in order to all threads, and each row waits
+// only until the row above has got 2 pixels ahead of it.  The result is
+// identical to dithering one row at a time.
+template<typename NearestFunction>
+static void DitherFloydSteinberg(const QImage &src, QImage *dest, const QList<QRgb> &palette, int transparentIndex, NearestFunction nearest)
+{
+    const bool premultiplied = (src.format() == QImage::Format_ARGB32_Premultiplied);
+    const bool mono = (dest->format() == QImage::Format_MonoLSB);
+    const int width = src.width();
+    const int height = src.height();
+
+    const uchar *const srcBits = src.constBits();
+    const qsizetype srcBytesPerLine = src.bytesPerLine();
+    uchar *const destBits = dest->bits();
+    const qsizetype destBytesPerLine = dest->bytesPerLine();
+
+    // Short images are not worth the synchronization.
+    const int numWorkers = std::max(1, std::min(QThread::idealThreadCount(), height / RowGrainSize));
+
+    // Accumulated error (times 16) for each channel of each pixel of a row,
+    // with a spare pixel at either end.  As no more than <numWorkers> rows
+    // are in flight at once, the buffers are reused round-robin.
+    const int numErrorRows = numWorkers + 2;
+    const int errorRowSize = (width + 2) * 3;
+    std::vector<int> errorRows(size_t(numErrorRows) * errorRowSize, 0);
+
+    // Number of pixels of each row that have been dithered.
+    std::unique_ptr<std::atomic<int>[]> progress(new std::atomic<int>[height]);
+    for (int y = 0; y < height; y++) {
+        progress[y].store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<int> nextRow{0};
+
+    const auto waitForProgress = [&progress](int row, int pixels) {
+        int done;
+        while ((done = progress[row].load(std::memory_order_acquire)) < pixels) {
+            QThread::yieldCurrentThread();
+        }
+        return done;
+    };
+
+    ::kpParallelFor(numWorkers, 1 /*grain size*/, [&](int, int) {
+        // Rows are claimed in increasing order, so the row we wait on has
+        // always been claimed by a thread that is not waiting on us.
+        int y;
+        while ((y = nextRow.fetch_add(1)) < height) {
+            int *const thisRowErrors = errorRows.data() + size_t(y % numErrorRows) * errorRowSize + 3;
+            int *const nextRowErrors = errorRows.data() + size_t((y + 1) % numErrorRows) * errorRowSize + 3;
+            const bool haveNextRow = (y + 1 < height);
+
+            if (haveNextRow) {
+                // <nextRowErrors> was last read by this row.
+                const int lastUser = y + 1 - numErrorRows;
+                if (lastUser >= 0) {
+                    waitForProgress(lastUser, width);
+                }
+
+                std::fill(nextRowErrors - 3, nextRowErrors - 3 + errorRowSize, 0);
+            }
+
+            const auto *srcLine = reinterpret_cast<const QRgb *>(srcBits + y * srcBytesPerLine);
+            uchar *const destLine = destBits + y * destBytesPerLine;
+
+            // Error (times 16) pushed right from the previous pixel.
+            int carry[3] = {0, 0, 0};
+            int rowAboveDone = 0;
+
+            for (int x = 0; x < width; x++) {
+                if (y > 0) {
+                    const int needed = std::min(width, x + 2);
+                    if (rowAboveDone < needed) {
+                        rowAboveDone = waitForProgress(y - 1, needed);
+                    }
+                }
+
+                const QRgb pixel = ::ReadPixel(srcLine[x], premultiplied);
+
+                if (transparentIndex >= 0 && qAlpha(pixel) < AlphaThreshold) {
+                    ::SetIndex(destLine, x, transparentIndex, mono);
+                    carry[0] = carry[1] = carry[2] = 0;
+                } else {
+                    const int *const errors = thisRowErrors + x * 3;
+
+                    int value[3] = {qRed(pixel), qGreen(pixel), qBlue(pixel)};
+                    for (int c = 0; c < 3; c++) {
+                        value[c] = qBound(0, value[c] + (errors[c] + carry[c]) / 16, 255);
+                    }
+
+                    const int index = nearest(value[0], value[1], value[2]);
+                    ::SetIndex(destLine, x, index, mono);
+
+                    const QRgb chosen = palette[index];
+                    const int chosenValue[3] = {qRed(chosen), qGreen(chosen), qBlue(chosen)};
+
+                    for (int c = 0; c < 3; c++) {
+                        const int error = value[c] - chosenValue[c];
+
+                        carry[c] = error * 7;
+                        if (haveNextRow) {
+                            nextRowErrors[(x - 1) * 3 + c] += error * 3;
+                            nextRowErrors[x * 3 + c] += error * 5;
+                            nextRowErrors[(x + 1) * 3 + c] += error;
+                        }
+                    }
+                }
+
+                // (publishing every pixel would just bounce the cache line
+                //  between threads)
+                if ((x & 31) == 31) {
+                    progress[y].store(x + 1, std::memory_order_release);
+                }
+            }
+
+            progress[y].store(width, std::memory_order_release);
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QImage kpColorQuantizer::toIndexed8(const QImage &image, bool dither)
+{
+#if DEBUG_KP_COLOR_QUANTIZER
+    qCDebug(kpLogImagelib) << "kpColorQuantizer::toIndexed8(size=" << image.size() << ",dither=" << dither << ")";
+#endif
+
+    if (image.isNull()) {
+        return {};
+    }
+
+    const QImage src = ::To32Bit(image);
+
+    QImage dest(src.width(), src.height(), QImage::Format_Indexed8);
+    if (dest.isNull()) {
+        return {};
+    }
+    ::CopyMetaData(src, &dest);
+
+    QList<QRgb> colors;
+    if (::ExactColors(src, 256, &colors)) {
+#if DEBUG_KP_COLOR_QUANTIZER
+        qCDebug(kpLogImagelib) << "\tkeeping" << colors.size() << "exact colors";
+#endif
+        dest.setColorTable(colors);
+        ::MapPixels(src, &dest, [&colors](QRgb pixel) {
+            return int(std::lower_bound(colors.cbegin(), colors.cend(), pixel) - colors.cbegin());
+        });
+        return dest;
+    }
+
+    qint64 transparentCount = 0;
+    const std::vector<quint32> histogram = ::BuildHistogram(src, &transparentCount);
+
+    // Reserve the last entry for transparency, if needed.
+    QList<QRgb> palette = ::MedianCut(histogram, transparentCount ? 255 : 256);
+    if (palette.isEmpty()) {
+        // (every pixel is transparent)
+        palette.append(qRgb(0, 0, 0));
+    }
+
+    const std::vector<uchar> nearestTable = ::NearestColorTable(palette);
+    const int transparentIndex = transparentCount ? static_cast<int>(palette.size()) : -1;
+
+    QList<QRgb> colorTable = palette;
+    if (transparentIndex >= 0) {
+        colorTable.append(qRgba(0, 0, 0, 0));
+    }
+    dest.setColorTable(colorTable);
+
+    if (dither) {
+        ::DitherFloydSteinberg(src, &dest, palette, transparentIndex, [&nearestTable](int r, int g, int b) {
+            return int(nearestTable[::HistogramIndex(r, g, b)]);
+        });
+    } else {
+        ::MapPixels(src, &dest, [&nearestTable, transparentIndex](QRgb pixel) {
+            if (transparentIndex >= 0 && qAlpha(pixel) < AlphaThreshold) {
+                return transparentIndex;
+            }
+
+            return int(nearestTable[::HistogramIndex(qRed(pixel), qGreen(pixel), qBlue(pixel))]);
+        });
+    }
+
+    return dest;
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QImage kpColorQuantizer::toMonochrome(const QImage &image, bool dither, bool keepTwoColors)
+{
+#if DEBUG_KP_COLOR_QUANTIZER
+    qCDebug(kpLogImagelib) << "kpColorQuantizer::toMonochrome(size=" << image.size() << ",dither=" << dither << ",keepTwoColors=" << keepTwoColors << ")";
+#endif
+
+    if (image.isNull()) {
+        return {};
+    }
+
+    const QImage src = ::To32Bit(image);
+
+    QImage dest(src.width(), src.height(), QImage::Format_MonoLSB);
+    if (dest.isNull()) {
+        return {};
+    }
+    // (SetIndex() only sets bits)
+    dest.fill(0);
+    ::CopyMetaData(src, &dest);
+
+    QList<QRgb> colors;
+    if (keepTwoColors && ::ExactColors(src, 2, &colors)) {
+#if DEBUG_KP_COLOR_QUANTIZER
+        qCDebug(kpLogImagelib) << "\tkeeping" << colors.size() << "exact colors";
+#endif
+        QList<QRgb> colorTable = colors;
+        if (colorTable.size() < 2) {
+            colorTable.append(qRgb(0, 0, 0));
+        }
+        dest.setColorTable(colorTable);
+
+        ::MapPixels(src, &dest, [&colors](QRgb pixel) {
+            return int(std::lower_bound(colors.cbegin(), colors.cend(), pixel) - colors.cbegin());
+        });
+        return dest;
+    }
+
+    // (same palette as QImage::convertToFormat())
+    const QList<QRgb> blackAndWhite = {qRgb(255, 255, 255), qRgb(0, 0, 0)};
+    dest.setColorTable(blackAndWhite);
+
+    if (dither) {
+        ::DitherFloydSteinberg(src, &dest, blackAndWhite, -1 /*no transparency*/, [](int r, int g, int b) {
+            return qGray(r, g, b) < 128 ? 1 : 0;
+        });
+    } else {
+        ::MapPixels(src, &dest, [](QRgb pixel) {
+            return qGray(pixel) < 128 ? 1 : 0;
+        });
+    }
+
+    return dest;
+}
+
+//---------------------------------------------------------------------
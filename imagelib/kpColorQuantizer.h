@@ -0,0 +1,55 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpColorQuantizer_H
+#define kpColorQuantizer_H
+
+#include <QImage>
+#include <QRgb>
+
+//
+// Converts 32-bit images to palette-based (1-bit and 8-bit) images.
+//
+// This replaces QImage::convertToFormat() for these depths, which is
+// single-threaded and always uses a fixed 6x6x6 color cube when dithering.
+//
+// All passes over the pixels (color counting, the histogram, mapping and
+// dithering) are split across threads with kpParallelFor().  Floyd-Steinberg
+// dithering is row-pipelined: each row trails the row above it by a couple
+// of pixels, so that many rows are dithered at once while giving exactly the
+// same result as dithering one row at a time.
+//
+class kpColorQuantizer
+{
+public:
+    //
+    // Returns a QImage::Format_Indexed8 version of <image>.
+    //
+    // If <image> has no more than 256 distinct colors, they are all kept
+    // exactly (including any translucency) and <dither> has no effect.
+    //
+    // Otherwise, pixels that are less than half opaque become fully
+    // transparent, the rest become opaque and are mapped to a palette built
+    // by median cut.  If <dither> is set, Floyd-Steinberg error diffusion is
+    // used.
+    //
+    static QImage toIndexed8(const QImage &image, bool dither);
+
+    //
+    // Returns a QImage::Format_MonoLSB version of <image>.
+    //
+    // If <keepTwoColors> is set and <image> has no more than 2 distinct
+    // colors, they are kept exactly.  This lets "color monochrome" images
+    // (e.g. yellow and white) be resaved without change.
+    //
+    // Otherwise, the result is black and white, chosen by the brightness
+    // of each pixel.  If <dither> is set, Floyd-Steinberg error diffusion is
+    // used.
+    //
+    static QImage toMonochrome(const QImage &image, bool dither, bool keepTwoColors);
+};
+
+#endif // kpColorQuantizer_H
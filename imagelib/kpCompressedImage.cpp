@@ -0,0 +1,451 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_COMPRESSED_IMAGE 0
+
+#include "imagelib/kpCompressedImage.h"
+
+#include <cstring>
+#include <vector>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+
+#include "generic/kpParallel.h"
+#include "generic/kpSpillFile.h"
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+// Rows per independently compressed band.
+static const int BandHeight = 64;
+
+// Images smaller than this are not worth compressing.
+static const kpCommandSize::SizeType MinCompressBytes = 64 * 1024;
+
+//---------------------------------------------------------------------
+
+// Shared between copies of a kpCompressedImage and the worker compressing
+// it, so that the worker can finish even if every copy has been destroyed.
+struct kpCompressedImageState {
+    QMutex mutex;
+
+    // Set until compression has finished.
+    kpImage image;
+
+    // Set once compression has finished, until spilled.
+    std::vector<QByteArray> bands;
+
+    // Set once spilled: where <bands> are in <spillFile>, or if
+    // <spilledRaw>, where the bytes of <image> are (as a single record).
+    std::shared_ptr<kpSpillFile> spillFile;
+    std::vector<kpSpillFile::Record> spilledRecords;
+    bool spilledRaw = false;
+
+    // Set once <image> has been dropped.
+    QSize size;
+    QImage::Format format = QImage::Format_Invalid;
+    qsizetype bytesPerLine = 0;
+    int dotsPerMeterX = 0, dotsPerMeterY = 0;
+
+    // Set from compressLater() until the worker is done.
+    bool compressing = false;
+    // Set if compression did not save enough to be worth keeping.
+    bool incompressible = false;
+};
+
+//---------------------------------------------------------------------
+
+// Deflates rows [<y>, <y> + <height>) of 32-bit <image>, storing each pixel's
+// bytes as the difference from the pixel to its left.
+static QByteArray CompressBand(const kpImage &image, int y, int height)
+{
+    const int rowBytes = image.width() * 4;
+
+    QByteArray rows(qsizetype(rowBytes) * height, Qt::Uninitialized);
+    auto *out = reinterpret_cast<uchar *>(rows.data());
+
+    for (int row = 0; row < height; row++) {
+        const uchar *in = image.constScanLine(y + row);
+
+        std::memcpy(out, in, qMin(4, rowBytes));
+        for (int i = 4; i < rowBytes; i++) {
+            out[i] = uchar(in[i] - in[i - 4]);
+        }
+
+        out += rowBytes;
+    }
+
+    return qCompress(rows, 1);
+}
+
+//---------------------------------------------------------------------
+
+// Reverses ::CompressBand() into the rows of <width> 32-bit pixels starting
+// at <bits>.
+static void DecompressBand(const QByteArray &band, uchar *bits, qsizetype bytesPerLine, int width)
+{
+    const QByteArray rows = qUncompress(band);
+
+    const int rowBytes = width * 4;
+    const int height = rowBytes ? int(rows.size() / rowBytes) : 0;
+    const auto *in = reinterpret_cast<const uchar *>(rows.constData());
+
+    for (int row = 0; row < height; row++) {
+        uchar *out = bits + row * bytesPerLine;
+
+        std::memcpy(out, in, qMin(4, rowBytes));
+        for (int i = 4; i < rowBytes; i++) {
+            out[i] = uchar(in[i] + out[i - 4]);
+        }
+
+        in += rowBytes;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Decompresses all of <bands> into the 32-bit image <*image>.
+static void DecompressBands(const std::vector<QByteArray> &bands, kpImage *image)
+{
+    // (not scanLine(), which must not be called concurrently)
+    uchar *const bits = image->bits();
+    const qsizetype bytesPerLine = image->bytesPerLine();
+    const int width = image->width();
+
+    kpParallelFor(int(bands.size()), 1, [&bands, bits, bytesPerLine, width](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            ::DecompressBand(bands[b], bits + qsizetype(b) * BandHeight * bytesPerLine, bytesPerLine, width);
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
+// Remembers what is needed to recreate <state->image> and drops it.
+static void DropImage(kpCompressedImageState *state)
+{
+    state->size = state->image.size();
+    state->format = state->image.format();
+    state->bytesPerLine = state->image.bytesPerLine();
+    state->dotsPerMeterX = state->image.dotsPerMeterX();
+    state->dotsPerMeterY = state->image.dotsPerMeterY();
+
+    state->image = kpImage();
+}
+
+//---------------------------------------------------------------------
+
+kpCompressedImage::kpCompressedImage() = default;
+
+kpCompressedImage::kpCompressedImage(const kpImage &image)
+{
+    if (!image.isNull()) {
+        d = std::make_shared<kpCompressedImageState>();
+        d->image = image;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpCompressedImage::isNull() const
+{
+    return !d;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpImage kpCompressedImage::image() const
+{
+    if (!d) {
+        return {};
+    }
+
+    QMutexLocker locker(&d->mutex);
+
+    if (!d->image.isNull()) {
+        return d->image;
+    }
+
+#if DEBUG_KP_COMPRESSED_IMAGE
+    qCDebug(kpLogImagelib) << "kpCompressedImage::image() decompressing size=" << d->size << "spilled=" << bool(d->spillFile);
+#endif
+
+    kpImage ret(d->size, d->format);
+    ret.setDotsPerMeterX(d->dotsPerMeterX);
+    ret.setDotsPerMeterY(d->dotsPerMeterY);
+
+    if (!d->spillFile) {
+        ::DecompressBands(d->bands, &ret);
+        return ret;
+    }
+
+    // Page the image back in.
+    std::vector<QByteArray> records;
+    for (const kpSpillFile::Record &record : d->spilledRecords) {
+        records.push_back(d->spillFile->read(record));
+        if (records.back().isNull()) {
+            qCCritical(kpLogImagelib) << "kpCompressedImage::image() could not read spilled image";
+            ret.fill(0);
+            return ret;
+        }
+    }
+
+    if (d->spilledRaw) {
+        const QByteArray &bytes = records.front();
+        const qsizetype rowBytes = qMin(d->bytesPerLine, ret.bytesPerLine());
+        for (int y = 0; y < ret.height() && (y + 1) * d->bytesPerLine <= bytes.size(); y++) {
+            std::memcpy(ret.scanLine(y), bytes.constData() + y * d->bytesPerLine, rowBytes);
+        }
+    } else {
+        ::DecompressBands(records, &ret);
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCompressedImage::compressLater()
+{
+    if (!d) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&d->mutex);
+
+        if (d->image.isNull() || d->compressing || d->incompressible) {
+            return;
+        }
+
+        // Only 32-bit images are stored by the delta encoding above.
+        if (d->image.depth() != 32 || kpCommandSize::ImageSize(d->image) < MinCompressBytes) {
+            return;
+        }
+
+        d->compressing = true;
+    }
+
+    // (created here, on the GUI thread, if this is the first time)
+    kpCompressedImageNotifier *notifier = kpCompressedImage::Notifier();
+
+    std::shared_ptr<kpCompressedImageState> state = d;
+    QThreadPool::globalInstance()->start([state, notifier] {
+        kpCompressedImage::Compress(state);
+
+        // (delivered on the thread <notifier> lives in)
+        Q_EMIT notifier->compressionFinished();
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpCompressedImage::isCompressed() const
+{
+    if (!d) {
+        return false;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    return d->image.isNull() && !d->spilledRaw;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpCompressedImage::size() const
+{
+    if (!d) {
+        return 0;
+    }
+
+    QMutexLocker locker(&d->mutex);
+
+    if (!d->image.isNull()) {
+        return kpCommandSize::ImageSize(d->image);
+    }
+
+    kpCommandSize::SizeType ret = 0;
+    for (const QByteArray &band : d->bands) {
+        ret += band.size();
+    }
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpCompressedImage::spilledSize() const
+{
+    if (!d) {
+        return 0;
+    }
+
+    QMutexLocker locker(&d->mutex);
+
+    kpCommandSize::SizeType ret = 0;
+    for (const kpSpillFile::Record &record : d->spilledRecords) {
+        ret += record.size;
+    }
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpCompressedImage::spillTo(const std::shared_ptr<kpSpillFile> &file)
+{
+    if (!d) {
+        return true;
+    }
+
+    QMutexLocker locker(&d->mutex);
+
+    if (d->spillFile == file) {
+        return true;
+    }
+
+    std::vector<kpSpillFile::Record> records;
+
+    // Already spilled to another file (e.g. one being compacted)?  Move the
+    // records over.
+    const bool moving = bool(d->spillFile);
+    std::vector<QByteArray> moved;
+
+    // Not compressed (yet)?  Spill the image as is.  A compression still in
+    // progress is then discarded by Compress().
+    const bool raw = moving ? d->spilledRaw : !d->image.isNull();
+    if (moving) {
+        for (const kpSpillFile::Record &record : d->spilledRecords) {
+            moved.push_back(d->spillFile->read(record));
+            if (moved.back().isNull()) {
+                qCWarning(kpLogImagelib) << "kpCompressedImage::spillTo() could not read spilled image - leaving it where it is";
+                return false;
+            }
+
+            records.push_back(file->append(moved.back()));
+        }
+    } else if (raw) {
+        records.push_back(file->append(reinterpret_cast<const char *>(d->image.constBits()), d->image.sizeInBytes()));
+    } else {
+        for (const QByteArray &band : d->bands) {
+            records.push_back(file->append(band));
+        }
+    }
+
+    for (const kpSpillFile::Record &record : records) {
+        if (!record.isValid()) {
+            return false;
+        }
+    }
+
+    // Read it all back before dropping it from memory: image() has nothing
+    // to fall back on if the file does not give back what was written.
+    for (size_t i = 0; i < records.size(); i++) {
+        const QByteArray written = file->read(records[i]);
+
+        bool same;
+        if (moving) {
+            same = (written == moved[i]);
+        } else if (raw) {
+            same = (written.size() == d->image.sizeInBytes() && std::memcmp(written.constData(), d->image.constBits(), written.size()) == 0);
+        } else {
+            same = (written == d->bands[i]);
+        }
+        if (!same) {
+            qCWarning(kpLogImagelib) << "kpCompressedImage::spillTo() could not read back spilled image - keeping it in memory";
+            return false;
+        }
+    }
+
+#if DEBUG_KP_COMPRESSED_IMAGE
+    qCDebug(kpLogImagelib) << "kpCompressedImage::spillTo() raw=" << raw << "moving=" << moving << "records=" << records.size();
+#endif
+
+    d->spillFile = file;
+    d->spilledRecords = std::move(records);
+    d->spilledRaw = raw;
+
+    if (moving) {
+        // (nothing left in memory)
+    } else if (raw) {
+        ::DropImage(d.get());
+    } else {
+        d->bands.clear();
+        d->bands.shrink_to_fit();
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// private static
+void kpCompressedImage::Compress(const std::shared_ptr<kpCompressedImageState> &state)
+{
+    kpImage image;
+    {
+        QMutexLocker locker(&state->mutex);
+        image = state->image;
+    }
+
+    const int bandCount = (image.height() + BandHeight - 1) / BandHeight;
+    std::vector<QByteArray> bands(bandCount);
+
+    kpParallelFor(bandCount, 1, [&image, &bands](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            const int y = b * BandHeight;
+            bands[b] = ::CompressBand(image, y, qMin(BandHeight, image.height() - y));
+        }
+    });
+
+    kpCommandSize::SizeType compressedSize = 0;
+    for (const QByteArray &band : bands) {
+        compressedSize += band.size();
+    }
+
+#if DEBUG_KP_COMPRESSED_IMAGE
+    qCDebug(kpLogImagelib) << "kpCompressedImage::Compress() size=" << image.size() << "bytes=" << kpCommandSize::ImageSize(image) << "->" << compressedSize;
+#endif
+
+    QMutexLocker locker(&state->mutex);
+
+    state->compressing = false;
+
+    // Spilled meanwhile?
+    if (state->spillFile) {
+        return;
+    }
+
+    // Not worth it (e.g. noise)?  Keep the image as is.
+    if (compressedSize >= kpCommandSize::ImageSize(image) * 9 / 10) {
+        state->incompressible = true;
+        return;
+    }
+
+    state->bands = std::move(bands);
+    ::DropImage(state.get());
+}
+
+//---------------------------------------------------------------------
+
+// public static
+kpCompressedImageNotifier *kpCompressedImage::Notifier()
+{
+    static kpCompressedImageNotifier notifier;
+    return &notifier;
+}
+
+//---------------------------------------------------------------------
+
+#include "moc_kpCompressedImage.cpp"
@@ -0,0 +1,93 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpCompressedImage_H
+#define kpCompressedImage_H
+
+#include <memory>
+
+#include <QObject>
+
+#include "commands/kpCommandSize.h"
+#include "imagelib/kpImage.h"
+
+class kpSpillFile;
+
+struct kpCompressedImageState;
+
+//
+// Emits compressionFinished(), on the GUI thread, whenever a compression
+// started by kpCompressedImage::compressLater() has finished (whether or
+// not it made the image smaller), so that memory use can be measured again.
+//
+class kpCompressedImageNotifier : public QObject
+{
+    Q_OBJECT
+
+Q_SIGNALS:
+    void compressionFinished();
+};
+
+//
+// An image that can be compressed in memory, for keeping snapshots that are
+// rarely read back, such as the images commands save for unexecute().
+//
+// The image starts out uncompressed.  compressLater() compresses it on a
+// background thread; until that finishes, the uncompressed image is used.
+// image() decompresses on demand, leaving the compressed copy in place.
+//
+// Each band of rows is stored as the difference between each pixel and the
+// pixel to its left (which makes flat areas and gradients highly
+// repetitive), deflated with qCompress() at its fastest level.  Bands are
+// (de)compressed in parallel with kpParallelFor().
+//
+// spillTo() moves the image, compressed or not, out of memory into a
+// kpSpillFile, from which image() then reads it back.
+//
+// Copies share the same image, compressed or not: the pixels themselves
+// never change.
+//
+class kpCompressedImage
+{
+public:
+    kpCompressedImage();
+    kpCompressedImage(const kpImage &image);
+
+    bool isNull() const;
+
+    // (may decompress)
+    kpImage image() const;
+
+    // Starts compressing the image in the background, unless it is too small
+    // or has already been (or is being) compressed.
+    void compressLater();
+
+    bool isCompressed() const;
+
+    // Writes the image, as it is currently stored, to <file> and drops it
+    // from memory.  Returns false if it could not be written, or read back
+    // exactly as written, in which case nothing changes.
+    //
+    // If the image has already been spilled to another file, it is moved
+    // to <file> (so that the other file can be let go of).
+    bool spillTo(const std::shared_ptr<kpSpillFile> &file);
+
+    // Bytes of memory currently used: 0 once spilled, the compressed size
+    // once compressed, else the size of the image.
+    kpCommandSize::SizeType size() const;
+
+    // Bytes written to the kpSpillFile by spillTo().
+    kpCommandSize::SizeType spilledSize() const;
+
+    static kpCompressedImageNotifier *Notifier();
+
+private:
+    static void Compress(const std::shared_ptr<kpCompressedImageState> &state);
+
+    std::shared_ptr<kpCompressedImageState> d;
+};
+
+#endif // kpCompressedImage_H
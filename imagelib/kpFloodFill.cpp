@@ -9,6 +9,8 @@
 
 #include "kpFloodFill.h"
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QImage>
 #include <QList>
@@ -18,6 +20,7 @@
 
 #include "kpColor.h"
 #include "kpDefs.h"
+#include "kpFloodFillIndex.h"
 #include "pixmapfx/kpPixmapFX.h"
 #include "tools/kpTool.h"
 
@@ -50,6 +53,26 @@ static kpCommandSize::SizeType FillLinesListSize(const QList<kpFillLine> &fillLi
 
 //---------------------------------------------------------------------
 
+// A run of <length> identical pixels, as saved by kpFloodFill::saveOldPixels().
+//
+// <pixel> is the color index, rather than the color, for an indexed
+// image (see ::IsIndexed()).
+struct kpFillRun {
+    QRgb pixel;
+    int length;
+};
+
+//---------------------------------------------------------------------
+
+// Returns whether the pixels of <image> are indices into its color table,
+// in which case QImage::setPixel() takes an index, not a color.
+static bool IsIndexed(const kpImage &image)
+{
+    return (image.format() == QImage::Format_Indexed8 || image.format() == QImage::Format_Mono || image.format() == QImage::Format_MonoLSB);
+}
+
+//---------------------------------------------------------------------
+
 struct kpFloodFillPrivate {
     //
     // Copy of whatever was passed to the constructor.
@@ -60,6 +83,8 @@ struct kpFloodFillPrivate {
     kpColor color;
     int processedColorSimilarity = 0;
 
+    kpFloodFillIndex *index = nullptr;
+
     //
     // Set by Step 1.
     //
@@ -76,6 +101,14 @@ struct kpFloodFillPrivate {
     QRect boundingRect;
 
     bool prepared = false;
+
+    //
+    // Set by saveOldPixels().
+    //
+
+    // The pixels under <fillLines>, in the same order, run-length encoded.
+    // A run never continues onto the next line.
+    QList<kpFillRun> oldPixels;
 };
 
 //---------------------------------------------------------------------
@@ -117,6 +150,14 @@ int kpFloodFill::processedColorSimilarity() const
 
 //---------------------------------------------------------------------
 
+// public
+void kpFloodFill::setIndex(kpFloodFillIndex *index)
+{
+    d->index = index;
+}
+
+//---------------------------------------------------------------------
+
 // public
 kpCommandSize::SizeType kpFloodFill::size() const
 {
@@ -125,7 +166,7 @@ kpCommandSize::SizeType kpFloodFill::size() const
         fillLinesCacheSize += ::FillLinesListSize(linesList);
     }
 
-    return ::FillLinesListSize(d->fillLines) + kpCommandSize::QImageSize(d->imagePtr) + fillLinesCacheSize;
+    return ::FillLinesListSize(d->fillLines) + fillLinesCacheSize + d->oldPixels.size() * kpCommandSize::SizeType(sizeof(kpFillRun));
 }
 
 //---------------------------------------------------------------------
@@ -295,6 +336,20 @@ void kpFloodFill::prepare()
         return;
     }
 
+    // Look up the region, rather than finding it pixel by pixel.
+    if (d->index && d->processedColorSimilarity == 0) {
+        const auto addIndexedLine = [this](int y, int x1, int x2) {
+            d->fillLines.append(kpFillLine(y, x1, x2));
+        };
+        if (d->index->region(*d->imagePtr, d->x, d->y, addIndexedLine, &d->boundingRect)) {
+#if DEBUG_KP_FLOOD_FILL && 1
+            qCDebug(kpLogImagelib) << "\tlooked up in index: lines=" << d->fillLines.size();
+#endif
+            d->prepared = true; // sync with all "return true"'s
+            return;
+        }
+    }
+
 #if DEBUG_KP_FLOOD_FILL && 1
     qCDebug(kpLogImagelib) << "\tcreating fillLinesCache";
 #endif
@@ -376,3 +431,79 @@ void kpFloodFill::fill()
 }
 
 //---------------------------------------------------------------------
+
+// public
+void kpFloodFill::saveOldPixels()
+{
+    prepare();
+
+    d->oldPixels.clear();
+
+    const kpImage &image = *d->imagePtr;
+    const bool is32Bit = (image.depth() == 32);
+    const bool isIndexed = ::IsIndexed(image);
+
+    for (const auto &l : d->fillLines) {
+        const auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(l.m_y));
+        const auto pixelAt = [&](int x) {
+            if (is32Bit) {
+                return line[x];
+            }
+
+            return isIndexed ? QRgb(image.pixelIndex(x, l.m_y)) : image.pixel(x, l.m_y);
+        };
+
+        kpFillRun run{pixelAt(l.m_x1), 1};
+        for (int x = l.m_x1 + 1; x <= l.m_x2; x++) {
+            const QRgb pixel = pixelAt(x);
+            if (pixel == run.pixel) {
+                run.length++;
+            } else {
+                d->oldPixels.append(run);
+                run = kpFillRun{pixel, 1};
+            }
+        }
+        d->oldPixels.append(run);
+    }
+
+    d->oldPixels.squeeze();
+
+#if DEBUG_KP_FLOOD_FILL && 1
+    qCDebug(kpLogImagelib) << "kpFloodFill::saveOldPixels() lines=" << d->fillLines.size() << "runs=" << d->oldPixels.size();
+#endif
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpFloodFill::restoreOldPixels()
+{
+    Q_ASSERT(d->prepared);
+
+    kpImage &image = *d->imagePtr;
+    const bool is32Bit = (image.depth() == 32);
+
+    int runIndex = 0;
+    for (const auto &l : d->fillLines) {
+        auto *line = reinterpret_cast<QRgb *>(image.scanLine(l.m_y));
+
+        for (int x = l.m_x1; x <= l.m_x2;) {
+            Q_ASSERT(runIndex < d->oldPixels.size());
+            const kpFillRun &run = d->oldPixels[runIndex++];
+
+            if (is32Bit) {
+                std::fill_n(line + x, run.length, run.pixel);
+            } else {
+                // (an index for indexed images - sync: saveOldPixels())
+                for (int i = 0; i < run.length; i++) {
+                    image.setPixel(x + i, l.m_y, run.pixel);
+                }
+            }
+            x += run.length;
+        }
+    }
+
+    d->oldPixels.clear();
+}
+
+//---------------------------------------------------------------------
@@ -13,6 +13,7 @@
 
 class kpColor;
 class kpFillLine;
+class kpFloodFillIndex;
 
 struct kpFloodFillPrivate;
 
@@ -33,6 +34,13 @@ public:
     kpColor color() const;
     int processedColorSimilarity() const;
 
+public:
+    // If set, prepare() looks up exact-match (processedColorSimilarity() of
+    // 0) regions in <index>, instead of reading pixels, when it can.
+    // <index> must be kept up to date with the image passed to the
+    // constructor.
+    void setIndex(kpFloodFillIndex *index);
+
 public:
     // Used for calculating the size of a command in the command history.
     kpCommandSize::SizeType size() const;
@@ -91,6 +99,18 @@ public:
     // (may invoke Step 2's prepare())
     void fill();
 
+    //
+    // Undo support: saveOldPixels() remembers the pixels that fill() is
+    // about to change, as runs of identical pixels along the fill lines
+    // (so a fill over a flat area costs a few bytes per line, however
+    // large its boundingRect()).  restoreOldPixels() puts them back and
+    // forgets them.  Both are included in size().
+    //
+
+    // (may invoke Step 2's prepare())
+    void saveOldPixels();
+    void restoreOldPixels();
+
 private:
     kpFloodFillPrivate *const d;
 };
@@ -0,0 +1,437 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_FLOOD_FILL_INDEX 0
+
+#include "imagelib/kpFloodFillIndex.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+
+#include "kpLogCategories.h"
+
+#include "generic/kpParallel.h"
+
+//---------------------------------------------------------------------
+
+// Above this many runs (on average, more than 1 run for every 16 pixels or
+// so), an image is too noisy for an index to pay for its memory.
+static const qint64 MaxRuns = 2 * 1024 * 1024;
+static const int MaxPixelsPerRun = 16;
+
+// The rows handed to each thread when labeling.
+static const int LabelRowsPerChunk = 64;
+
+//---------------------------------------------------------------------
+
+static bool IsSupportedFormat(const kpImage &image)
+{
+    // (exact matches compare the raw 32-bit pixels - this is the same as
+    //  comparing kpColor's since unpremultiplying is one-to-one)
+    return (image.format() == QImage::Format_ARGB32_Premultiplied || image.format() == QImage::Format_ARGB32 || image.format() == QImage::Format_RGB32);
+}
+
+//---------------------------------------------------------------------
+
+// Returns the root of <run>'s tree in <parent>, shortening the path to it.
+static int Find(std::vector<int> &parent, int run)
+{
+    while (parent[run] != run) {
+        parent[run] = parent[parent[run]];
+        run = parent[run];
+    }
+
+    return run;
+}
+
+//---------------------------------------------------------------------
+
+// Joins the trees of <a> and <b> in <parent>.  The root with the lower
+// number becomes the root of both, so the result does not depend on the
+// order of the unions.
+static void Union(std::vector<int> &parent, int a, int b)
+{
+    a = ::Find(parent, a);
+    b = ::Find(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    } else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+//---------------------------------------------------------------------
+
+kpFloodFillIndex::kpFloodFillIndex()
+    : m_imageKey(0)
+    , m_wanted(false)
+    , m_tooManyRuns(false)
+    , m_numRuns(0)
+    , m_hasDirtyRows(false)
+{
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpFloodFillIndex::clear()
+{
+    m_imageKey = 0;
+    m_imageSize = QSize();
+
+    m_wanted = false;
+    m_tooManyRuns = false;
+
+    m_rowRuns = std::vector<std::vector<Run>>();
+    m_numRuns = 0;
+
+    m_dirtyRows = std::vector<bool>();
+    m_hasDirtyRows = false;
+
+    m_regions = std::vector<Region>();
+    m_freeRegions = std::vector<int>();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpFloodFillIndex::imageChanged(const kpImage &image, const QRect &rect)
+{
+    if (m_rowRuns.empty()) {
+        return;
+    }
+
+    if (image.size() != m_imageSize) {
+        const bool wanted = m_wanted;
+        clear();
+        m_wanted = wanted;
+        return;
+    }
+
+    const QRect changedRect = rect.intersected(image.rect());
+    for (int y = changedRect.top(); y <= changedRect.bottom(); y++) {
+        m_dirtyRows[y] = true;
+    }
+    m_hasDirtyRows = m_hasDirtyRows || !changedRect.isEmpty();
+
+    m_imageKey = image.cacheKey();
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpFloodFillIndex::region(const kpImage &image, int x, int y, const std::function<void(int y, int x1, int x2)> &addLine, QRect *boundingRect)
+{
+    Q_ASSERT(image.rect().contains(x, y));
+
+    if (!update(image)) {
+        return false;
+    }
+
+    // Find the run under (x, y).
+    const std::vector<Run> &row = m_rowRuns[y];
+    const auto it = std::upper_bound(row.begin(), row.end(), x, [](int px, const Run &run) {
+                        return px < run.x1;
+                    })
+        - 1;
+    Q_ASSERT(it >= row.begin() && it->x1 <= x && x <= it->x2);
+
+    const Region &region = m_regions[it->region];
+    for (const RunRef &ref : region.runs) {
+        const Run &run = m_rowRuns[ref.y][ref.index];
+        addLine(ref.y, run.x1, run.x2);
+    }
+
+#if DEBUG_KP_FLOOD_FILL_INDEX
+    qCDebug(kpLogImagelib) << "kpFloodFillIndex::region(" << x << "," << y << ") runs=" << region.runs.size() << " rect=" << region.boundingRect;
+#endif
+
+    *boundingRect = region.boundingRect;
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// private
+bool kpFloodFillIndex::update(const kpImage &image)
+{
+    if (!::IsSupportedFormat(image)) {
+        return false;
+    }
+
+    const bool isIndexed = (!m_rowRuns.empty() && image.size() == m_imageSize && image.cacheKey() == m_imageKey);
+    if (!isIndexed) {
+        // Only index the image the second time we are asked.
+        if (!m_wanted) {
+            m_wanted = true;
+            return false;
+        }
+
+        if (m_tooManyRuns) {
+            if (image.size() == m_imageSize) {
+                return false;
+            }
+
+            // (a different image, e.g. after a resize - try again)
+            m_tooManyRuns = false;
+        }
+
+        // (if the image has changed without imageChanged() being called,
+        //  nothing we know about it can be trusted)
+        m_imageSize = image.size();
+        m_rowRuns.assign(image.height(), std::vector<Run>());
+        m_numRuns = 0;
+        m_regions.clear();
+        m_freeRegions.clear();
+        m_dirtyRows.assign(image.height(), true);
+        m_hasDirtyRows = true;
+    }
+
+    if (m_hasDirtyRows) {
+        std::vector<int> dirtyRows, affectedRegions;
+        if (!findDirtyRuns(image, &dirtyRows, &affectedRegions)) {
+            const bool wanted = m_wanted;
+            clear();
+            m_wanted = wanted;
+            m_tooManyRuns = true;
+            m_imageSize = image.size();
+            return false;
+        }
+
+        relabel(dirtyRows, affectedRegions);
+
+        m_dirtyRows.assign(image.height(), false);
+        m_hasDirtyRows = false;
+    }
+
+    m_imageKey = image.cacheKey();
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// private
+bool kpFloodFillIndex::findDirtyRuns(const kpImage &image, std::vector<int> *dirtyRows, std::vector<int> *affectedRegions)
+{
+#if DEBUG_KP_FLOOD_FILL_INDEX
+    QElapsedTimer timer;
+    timer.start();
+#endif
+
+    const int width = image.width();
+    const int height = image.height();
+
+    dirtyRows->clear();
+    for (int y = 0; y < height; y++) {
+        if (m_dirtyRows[y]) {
+            dirtyRows->push_back(y);
+        }
+    }
+
+    // Find the runs of the dirty rows.
+    const uchar *const bits = image.constBits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+
+    std::vector<std::vector<Run>> newRowRuns(dirtyRows->size());
+    kpParallelFor(static_cast<int>(dirtyRows->size()), qMax(1, 65536 / qMax(1, width)), [&, bits, bytesPerLine, width](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const int y = (*dirtyRows)[i];
+            const auto *line = reinterpret_cast<const QRgb *>(bits + y * bytesPerLine);
+
+            std::vector<Run> &runs = newRowRuns[i];
+            int x1 = 0;
+            for (int x = 1; x <= width; x++) {
+                if (x == width || line[x] != line[x1]) {
+                    runs.push_back(Run{x1, x - 1, line[x1], -1});
+                    x1 = x;
+                }
+            }
+        }
+    });
+
+    qint64 numRuns = m_numRuns;
+    for (size_t i = 0; i < dirtyRows->size(); i++) {
+        numRuns += qint64(newRowRuns[i].size()) - qint64(m_rowRuns[(*dirtyRows)[i]].size());
+    }
+
+    if (numRuns > MaxRuns || numRuns > qint64(width) * height / MaxPixelsPerRun + height) {
+#if DEBUG_KP_FLOOD_FILL_INDEX
+        qCDebug(kpLogImagelib) << "kpFloodFillIndex::findDirtyRuns() too many runs:" << numRuns;
+#endif
+        return false;
+    }
+
+    // The regions that had runs on the dirty rows may have split, and
+    // those next to them may join the new runs, so they must be labeled
+    // again.
+    affectedRegions->clear();
+    const auto affectRow = [this, affectedRegions](int y) {
+        for (const Run &run : m_rowRuns[y]) {
+            affectedRegions->push_back(run.region);
+        }
+    };
+    for (const int y : *dirtyRows) {
+        affectRow(y);
+        if (y > 0 && !m_dirtyRows[y - 1]) {
+            affectRow(y - 1);
+        }
+        if (y + 1 < height && !m_dirtyRows[y + 1]) {
+            affectRow(y + 1);
+        }
+    }
+    std::sort(affectedRegions->begin(), affectedRegions->end());
+    affectedRegions->erase(std::unique(affectedRegions->begin(), affectedRegions->end()), affectedRegions->end());
+
+    for (size_t i = 0; i < dirtyRows->size(); i++) {
+        m_rowRuns[(*dirtyRows)[i]].swap(newRowRuns[i]);
+    }
+    m_numRuns = numRuns;
+
+#if DEBUG_KP_FLOOD_FILL_INDEX
+    qCDebug(kpLogImagelib) << "kpFloodFillIndex::findDirtyRuns() rows=" << dirtyRows->size() << " runs=" << numRuns
+                           << " affectedRegions=" << affectedRegions->size() << " msec=" << timer.elapsed();
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpFloodFillIndex::relabel(const std::vector<int> &dirtyRows, const std::vector<int> &affectedRegions)
+{
+#if DEBUG_KP_FLOOD_FILL_INDEX
+    QElapsedTimer timer;
+    timer.start();
+#endif
+
+    // Gather the runs to label: those of the affected regions on clean rows
+    // (which have not moved within their rows)...
+    std::vector<RunRef> refs;
+    for (const int region : affectedRegions) {
+        for (const RunRef &ref : m_regions[region].runs) {
+            if (!m_dirtyRows[ref.y]) {
+                refs.push_back(ref);
+            }
+        }
+
+        m_regions[region] = Region();
+        m_freeRegions.push_back(region);
+    }
+
+    // ... and all the runs of the dirty rows.
+    for (const int y : dirtyRows) {
+        for (int i = 0; i < static_cast<int>(m_rowRuns[y].size()); i++) {
+            refs.push_back(RunRef{y, i});
+        }
+    }
+
+    std::sort(refs.begin(), refs.end(), [](const RunRef &a, const RunRef &b) {
+        return a.y < b.y || (a.y == b.y && a.index < b.index);
+    });
+
+    const int numRefs = static_cast<int>(refs.size());
+
+    // The runs in <refs> of its <r>th row are [rowFirst[r], rowFirst[r + 1]).
+    //
+    // No region being labeled touches a run outside <refs> (it would have
+    // been in the same region as that run), so only these runs need to be
+    // compared.
+    std::vector<int> rowFirst;
+    for (int i = 0; i < numRefs; i++) {
+        if (i == 0 || refs[i].y != refs[i - 1].y) {
+            rowFirst.push_back(i);
+        }
+    }
+    const int numRows = static_cast<int>(rowFirst.size());
+    rowFirst.push_back(numRefs);
+
+    std::vector<int> parent(numRefs);
+    for (int i = 0; i < numRefs; i++) {
+        parent[i] = i;
+    }
+
+    // Joins the regions of the runs of the <r> - 1th and <r>th rows that
+    // touch.
+    const auto unionRows = [this, &refs, &rowFirst, &parent](int r) {
+        int a = rowFirst[r - 1];
+        const int aEnd = rowFirst[r];
+        int b = rowFirst[r];
+        const int bEnd = rowFirst[r + 1];
+
+        if (refs[b].y != refs[a].y + 1) {
+            return;
+        }
+
+        while (a < aEnd && b < bEnd) {
+            const Run &above = m_rowRuns[refs[a].y][refs[a].index];
+            const Run &below = m_rowRuns[refs[b].y][refs[b].index];
+
+            if (above.x1 <= below.x2 && below.x1 <= above.x2 && above.color == below.color) {
+                ::Union(parent, a, b);
+            }
+
+            if (above.x2 < below.x2) {
+                a++;
+            } else {
+                b++;
+            }
+        }
+    };
+
+    // Each chunk of rows is joined up on its own thread.  This only ever
+    // touches the runs of the chunk, so the chunks don't interfere...
+    const int numChunks = (numRows + LabelRowsPerChunk - 1) / LabelRowsPerChunk;
+    kpParallelFor(numChunks, 1, [numRows, &unionRows](int begin, int end) {
+        for (int chunk = begin; chunk < end; chunk++) {
+            const int lastRow = qMin(numRows, (chunk + 1) * LabelRowsPerChunk) - 1;
+            for (int r = chunk * LabelRowsPerChunk + 1; r <= lastRow; r++) {
+                unionRows(r);
+            }
+        }
+    });
+
+    // ... and then the chunks are joined to each other.
+    for (int chunk = 1; chunk < numChunks; chunk++) {
+        unionRows(chunk * LabelRowsPerChunk);
+    }
+
+    // Give each new region a number (reusing those of the old regions)...
+    std::vector<int> regionOf(numRefs);
+    for (int i = 0; i < numRefs; i++) {
+        const int root = ::Find(parent, i);
+        if (root != i) {
+            regionOf[i] = regionOf[root];
+            continue;
+        }
+
+        if (!m_freeRegions.empty()) {
+            regionOf[i] = m_freeRegions.back();
+            m_freeRegions.pop_back();
+        } else {
+            regionOf[i] = static_cast<int>(m_regions.size());
+            m_regions.push_back(Region());
+        }
+    }
+
+    // ... and label its runs (in row order, since <refs> is sorted).
+    for (int i = 0; i < numRefs; i++) {
+        const RunRef &ref = refs[i];
+        Run &run = m_rowRuns[ref.y][ref.index];
+        Region &region = m_regions[regionOf[i]];
+
+        run.region = regionOf[i];
+        region.runs.push_back(ref);
+        region.boundingRect = region.boundingRect.united(QRect(QPoint(run.x1, ref.y), QPoint(run.x2, ref.y)));
+    }
+
+#if DEBUG_KP_FLOOD_FILL_INDEX
+    qCDebug(kpLogImagelib) << "kpFloodFillIndex::relabel() runs=" << numRefs << " of" << m_numRuns << " msec=" << timer.elapsed();
+#endif
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,117 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpFloodFillIndex_H
+#define kpFloodFillIndex_H
+
+#include <functional>
+#include <vector>
+
+#include <QRect>
+#include <QRgb>
+
+#include "imagelib/kpImage.h"
+
+//
+// Index of the regions of an image that an exact-match (similarity 0)
+// flood fill would change.
+//
+// Each row of the image is split into runs of identical pixels.  Runs on
+// adjacent rows that overlap and have the same color are connected (i.e.
+// 4-connectivity, like kpFloodFill) and union-find labels each run with
+// its region.  A fill can then look up the runs of the region it starts in
+// directly, without reading any pixels.
+//
+// Finding the runs and labeling them are split across threads with
+// kpParallelFor().
+//
+// The index is kept in step with the image incrementally: imageChanged()
+// marks rows whose runs must be found again.  Only those rows' pixels are
+// read again, and only the regions that had runs on, or next to, those
+// rows are labeled again (which splits or merges them as needed).  The
+// labels of all other regions are kept.
+//
+// The index is only built once it has been asked for twice for the same
+// image, so that a single fill of a small area does not pay for indexing
+// the whole image.  It is never built for images with too many runs (e.g.
+// photos), where it would use too much memory and save nothing.
+//
+class kpFloodFillIndex
+{
+public:
+    kpFloodFillIndex();
+
+    kpFloodFillIndex(const kpFloodFillIndex &) = delete;
+    kpFloodFillIndex &operator=(const kpFloodFillIndex &) = delete;
+
+    // Forgets everything about the image.
+    void clear();
+
+    // Call this after changing the pixels of <image> at <rect>.
+    //
+    // If the image is changed without calling this, the next region()
+    // notices and reindexes the whole image.
+    void imageChanged(const kpImage &image, const QRect &rect);
+
+    //
+    // Calls <addLine>(y, x1, x2) for each run of the 4-connected region of
+    // <image> with exactly the color of the pixel at (<x>, <y>), and sets
+    // <*boundingRect> to the region's bounding rectangle.
+    //
+    // Returns false, without calling <addLine>, if the index cannot be
+    // used (yet), in which case the caller must find the region itself.
+    //
+    bool region(const kpImage &image, int x, int y, const std::function<void(int y, int x1, int x2)> &addLine, QRect *boundingRect);
+
+private:
+    struct Run {
+        int x1, x2;
+        QRgb color;
+        // The region the run is in (an index into <m_regions>).
+        int region;
+    };
+
+    // Identifies the run at <index> (in increasing x order) in row <y>.
+    struct RunRef {
+        int y;
+        int index;
+    };
+
+    struct Region {
+        // In row order.
+        std::vector<RunRef> runs;
+        QRect boundingRect;
+    };
+
+    bool update(const kpImage &image);
+    bool findDirtyRuns(const kpImage &image, std::vector<int> *dirtyRows, std::vector<int> *affectedRegions);
+    void relabel(const std::vector<int> &dirtyRows, const std::vector<int> &affectedRegions);
+
+    // Identifies the image, and the state of its pixels, that the index is
+    // for (see QImage::cacheKey()).
+    qint64 m_imageKey;
+    QSize m_imageSize;
+
+    // Set once region() has been asked for, while the index is not built.
+    bool m_wanted;
+    // Set if the image has too many runs for an index to be worthwhile.
+    bool m_tooManyRuns;
+
+    // The runs of each row.  Empty if the index has not been built.
+    std::vector<std::vector<Run>> m_rowRuns;
+    qint64 m_numRuns;
+
+    // Rows whose runs must be found again.
+    std::vector<bool> m_dirtyRows;
+    bool m_hasDirtyRows;
+
+    // The regions, and the indexes of those that are no longer used (and
+    // may be reused when relabeling).
+    std::vector<Region> m_regions;
+    std::vector<int> m_freeRegions;
+};
+
+#endif // kpFloodFillIndex_H
@@ -0,0 +1,340 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_RESAMPLER 0
+
+#include "imagelib/kpResampler.h"
+
+#include <QtMath>
+
+#include "kpLogCategories.h"
+
+#include "generic/kpParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//---------------------------------------------------------------------
+
+// Weights are fixed point, with this many fractional bits.
+static const int WeightBits = 14;
+static const int WeightOne = 1 << WeightBits;
+
+// Rows per kpParallelFor() chunk.
+static const int RowGrainSize = 16;
+
+//---------------------------------------------------------------------
+
+// Which source pixels contribute to each destination pixel along one axis,
+// and by how much.
+struct kpResamplerWeights {
+    // Source pixels read per destination pixel.  This is the same for
+    // every destination pixel (padded with zero weights), so that the
+    // inner loops have a fixed trip count.
+    int taps = 0;
+
+    // The first source pixel of each destination pixel.
+    std::vector<int> first;
+
+    // <taps> weights per destination pixel, adding up to WeightOne.
+    std::vector<int> weights;
+};
+
+//---------------------------------------------------------------------
+
+// Returns how far, in source pixels when not shrinking, <filter> reaches
+// either side of its center.
+static double Support(kpResampler::Filter filter)
+{
+    switch (filter) {
+    case kpResampler::Box:
+        return 0.5;
+
+    case kpResampler::Bicubic:
+        return 2.0;
+
+    case kpResampler::Lanczos3:
+    default:
+        return 3.0;
+    }
+}
+
+//---------------------------------------------------------------------
+
+static double FilterValue(kpResampler::Filter filter, double x)
+{
+    x = std::fabs(x);
+
+    switch (filter) {
+    case kpResampler::Box:
+        return (x < 0.5) ? 1.0 : 0.0;
+
+    case kpResampler::Bicubic:
+        // (Catmull-Rom i.e. a = -0.5)
+        if (x < 1.0) {
+            return (1.5 * x - 2.5) * x * x + 1.0;
+        }
+        if (x < 2.0) {
+            return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+        }
+        return 0.0;
+
+    case kpResampler::Lanczos3:
+    default: {
+        if (x < 1e-8) {
+            return 1.0;
+        }
+        if (x >= 3.0) {
+            return 0.0;
+        }
+
+        const double px = M_PI * x;
+        return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+    }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Returns the weights for resampling <srcSize> pixels to <dstSize> pixels
+// along one axis.
+static kpResamplerWeights Weights(int srcSize, int dstSize, kpResampler::Filter filter)
+{
+    kpResamplerWeights ret;
+
+    const double scale = double(srcSize) / dstSize;
+
+    // When shrinking, widen the filter so that it covers all the source
+    // pixels under each destination pixel, instead of aliasing.
+    const double filterScale = qMax(1.0, scale);
+    const double support = ::Support(filter) * filterScale;
+
+    ret.taps = qMin(srcSize, 2 * int(std::ceil(support)) + 2);
+    ret.first.resize(dstSize);
+    ret.weights.assign(size_t(dstSize) * ret.taps, 0);
+
+    std::vector<double> weights(ret.taps);
+    for (int i = 0; i < dstSize; i++) {
+        const double center = (i + 0.5) * scale;
+
+        const int lo = qMax(0, int(std::floor(center - support)));
+        const int hi = qMin(srcSize, int(std::ceil(center + support)));
+        // (slide the window back inside the source at the far edge)
+        const int start = qMin(lo, srcSize - ret.taps);
+        ret.first[i] = start;
+
+        std::fill(weights.begin(), weights.end(), 0.0);
+        double sum = 0;
+        for (int j = lo; j < hi; j++) {
+            weights[j - start] = ::FilterValue(filter, (j + 0.5 - center) / filterScale);
+            sum += weights[j - start];
+        }
+
+        int *const fixed = &ret.weights[size_t(i) * ret.taps];
+
+        // Nothing in reach (e.g. a box filter exactly between 2 pixels)?
+        if (std::fabs(sum) < 1e-12) {
+            fixed[qBound(0, int(center), srcSize - 1) - start] = WeightOne;
+            continue;
+        }
+
+        // Give the rounding error to the largest weight, so that the
+        // weights add up to exactly WeightOne and flat areas stay exactly
+        // flat.
+        int fixedSum = 0;
+        int largest = 0;
+        for (int k = 0; k < ret.taps; k++) {
+            fixed[k] = qRound(weights[k] / sum * WeightOne);
+            fixedSum += fixed[k];
+
+            if (fixed[k] > fixed[largest]) {
+                largest = k;
+            }
+        }
+        fixed[largest] += WeightOne - fixedSum;
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// Returns the channel value in the fixed point <sum>, which starts at
+// WeightOne / 2 to round to nearest.
+static inline uchar ClampChannel(int sum)
+{
+    return uchar(qBound(0, sum >> WeightBits, 255));
+}
+
+//---------------------------------------------------------------------
+
+// Lowers any color channel above alpha to alpha in the premultiplied
+// pixels of <row>: overshoot of the negative lobes of Bicubic and Lanczos3
+// can leave pixels that are not valid premultiplied ones.
+static void ClampPremultiplied(QRgb *row, int width)
+{
+    for (int x = 0; x < width; x++) {
+        const QRgb pixel = row[x];
+        const int a = qAlpha(pixel);
+
+        if (qRed(pixel) > a || qGreen(pixel) > a || qBlue(pixel) > a) {
+            row[x] = qRgba(qMin(qRed(pixel), a), qMin(qGreen(pixel), a), qMin(qBlue(pixel), a), a);
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Resamples each row of 32-bit <src> into the same row of <dst>.
+static void ResampleRows(const QImage &src, QImage *dst, const kpResamplerWeights &weights)
+{
+    // (not scanLine(), which must not be called concurrently)
+    const uchar *const srcBits = src.constBits();
+    const qsizetype srcBytesPerLine = src.bytesPerLine();
+    uchar *const dstBits = dst->bits();
+    const qsizetype dstBytesPerLine = dst->bytesPerLine();
+    const int dstWidth = dst->width();
+
+    kpParallelFor(src.height(), RowGrainSize, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            const uchar *const in = srcBits + y * srcBytesPerLine;
+            uchar *const out = dstBits + y * dstBytesPerLine;
+
+            for (int x = 0; x < dstWidth; x++) {
+                const int *const w = &weights.weights[size_t(x) * weights.taps];
+                const uchar *s = in + weights.first[x] * 4;
+
+                // (each byte of the pixel, whatever order the channels are in)
+                int c0 = WeightOne / 2, c1 = WeightOne / 2, c2 = WeightOne / 2, c3 = WeightOne / 2;
+                for (int k = 0; k < weights.taps; k++, s += 4) {
+                    c0 += w[k] * s[0];
+                    c1 += w[k] * s[1];
+                    c2 += w[k] * s[2];
+                    c3 += w[k] * s[3];
+                }
+
+                uchar *const o = out + x * 4;
+                o[0] = ::ClampChannel(c0);
+                o[1] = ::ClampChannel(c1);
+                o[2] = ::ClampChannel(c2);
+                o[3] = ::ClampChannel(c3);
+            }
+
+            ::ClampPremultiplied(reinterpret_cast<QRgb *>(out), dstWidth);
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
+// Resamples each column of 32-bit <src> into the same column of <dst>.
+//
+// Each destination row is a weighted sum of whole source rows, accumulated
+// a source row at a time, so that memory is read sequentially.
+static void ResampleColumns(const QImage &src, QImage *dst, const kpResamplerWeights &weights)
+{
+    const uchar *const srcBits = src.constBits();
+    const qsizetype srcBytesPerLine = src.bytesPerLine();
+    uchar *const dstBits = dst->bits();
+    const qsizetype dstBytesPerLine = dst->bytesPerLine();
+    const int dstWidth = dst->width();
+    const int rowBytes = dstWidth * 4;
+
+    kpParallelFor(dst->height(), RowGrainSize, [&](int begin, int end) {
+        std::vector<int> sums(rowBytes);
+
+        for (int y = begin; y < end; y++) {
+            std::fill(sums.begin(), sums.end(), WeightOne / 2);
+
+            const int *const w = &weights.weights[size_t(y) * weights.taps];
+            for (int k = 0; k < weights.taps; k++) {
+                const int weight = w[k];
+                if (weight == 0) {
+                    continue;
+                }
+
+                const uchar *const in = srcBits + qsizetype(weights.first[y] + k) * srcBytesPerLine;
+                for (int i = 0; i < rowBytes; i++) {
+                    sums[i] += weight * in[i];
+                }
+            }
+
+            uchar *const out = dstBits + y * dstBytesPerLine;
+            for (int i = 0; i < rowBytes; i++) {
+                out[i] = ::ClampChannel(sums[i]);
+            }
+
+            ::ClampPremultiplied(reinterpret_cast<QRgb *>(out), dstWidth);
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QImage kpResampler::scale(const QImage &image, int width, int height, Filter filter)
+{
+#if DEBUG_KP_RESAMPLER
+    qCDebug(kpLogImagelib) << "kpResampler::scale(" << image.size() << "->" << width << "x" << height << "filter=" << filter << ")";
+#endif
+
+    if (width <= 0 || height <= 0 || image.isNull()) {
+        return {};
+    }
+
+    QImage src = image;
+    if (src.format() != QImage::Format_RGB32 && src.format() != QImage::Format_ARGB32_Premultiplied) {
+        src = src.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    if (src.width() == width && src.height() == height) {
+        return src;
+    }
+
+    kpResamplerWeights xWeights, yWeights;
+    if (width != src.width()) {
+        xWeights = ::Weights(src.width(), width, filter);
+    }
+    if (height != src.height()) {
+        yWeights = ::Weights(src.height(), height, filter);
+    }
+
+    // Do the pass that shrinks the most first, so that the second pass has
+    // less to do.  (costs are in multiply-adds per channel)
+    const double rowsFirstCost = double(width) * src.height() * xWeights.taps + double(width) * height * yWeights.taps;
+    const double columnsFirstCost = double(src.width()) * height * yWeights.taps + double(width) * height * xWeights.taps;
+
+    QImage ret = src;
+    for (int pass = 0; pass < 2; pass++) {
+        const bool rows = ((pass == 0) == (rowsFirstCost <= columnsFirstCost));
+
+        if (rows && xWeights.taps) {
+            QImage resampled(width, ret.height(), src.format());
+            if (resampled.isNull()) {
+                return {};
+            }
+
+            ::ResampleRows(ret, &resampled, xWeights);
+            ret = resampled;
+        } else if (!rows && yWeights.taps) {
+            QImage resampled(ret.width(), height, src.format());
+            if (resampled.isNull()) {
+                return {};
+            }
+
+            ::ResampleColumns(ret, &resampled, yWeights);
+            ret = resampled;
+        }
+    }
+
+    ret.setDotsPerMeterX(image.dotsPerMeterX());
+    ret.setDotsPerMeterY(image.dotsPerMeterY());
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
@@ -497,16 +497,25 @@ void kpTransformAutoCropCommand::unexecute()
     deleteUndoImages();
 }
 
+static QRect ContentsRect(const QSize &imageSize,
+                          const kpTransformAutoCropBorder &leftBorder,
+                          const kpTransformAutoCropBorder &rightBorder,
+                          const kpTransformAutoCropBorder &topBorder,
+                          const kpTransformAutoCropBorder &botBorder)
+{
+    QPoint topLeft(leftBorder.exists() ? leftBorder.rect().right() + 1 : 0, topBorder.exists() ? topBorder.rect().bottom() + 1 : 0);
+    QPoint botRight(rightBorder.exists() ? rightBorder.rect().left() - 1 : imageSize.width() - 1,
+                    botBorder.exists() ? botBorder.rect().top() - 1 : imageSize.height() - 1);
+
+    return {topLeft, botRight};
+}
+
 // private
 QRect kpTransformAutoCropCommand::contentsRect() const
 {
     const kpImage image = document()->image(d->actOnSelection);
 
-    QPoint topLeft(d->leftBorder.exists() ? d->leftBorder.rect().right() + 1 : 0, d->topBorder.exists() ? d->topBorder.rect().bottom() + 1 : 0);
-    QPoint botRight(d->rightBorder.exists() ? d->rightBorder.rect().left() - 1 : image.width() - 1,
-                    d->botBorder.exists() ? d->botBorder.rect().top() - 1 : image.height() - 1);
-
-    return {topLeft, botRight};
+    return ::ContentsRect(image.size(), d->leftBorder, d->rightBorder, d->topBorder, d->botBorder);
 }
 
 static void ShowNothingToAutocropMessage(kpMainWindow *mainWindow, bool actOnSelection)
@@ -528,31 +537,17 @@ static void ShowNothingToAutocropMessage(kpMainWindow *mainWindow, bool actOnSel
     }
 }
 
-bool kpTransformAutoCrop(kpMainWindow *mainWindow)
+// Finds the borders of the image that <leftBorder>, <rightBorder>,
+// <topBorder> and <botBorder> were constructed with, using the autocrop
+// heuristics.
+//
+// (returns true if at least one border was found, else false)
+static bool CalculateBorders(int processedColorSimilarity,
+                             kpTransformAutoCropBorder &leftBorder,
+                             kpTransformAutoCropBorder &rightBorder,
+                             kpTransformAutoCropBorder &topBorder,
+                             kpTransformAutoCropBorder &botBorder)
 {
-#if DEBUG_KP_TOOL_AUTO_CROP
-    qCDebug(kpLogImagelib) << "kpTransformAutoCrop() CALLED!";
-#endif
-
-    Q_ASSERT(mainWindow);
-    kpDocument *doc = mainWindow->document();
-    Q_ASSERT(doc);
-
-    // OPT: if already pulled selection image, no need to do it again here
-    kpImage image = doc->selection() ? doc->getSelectedBaseImage() : doc->image();
-    Q_ASSERT(!image.isNull());
-
-    kpViewManager *vm = mainWindow->viewManager();
-    Q_ASSERT(vm);
-
-    int processedColorSimilarity = mainWindow->colorToolBar()->processedColorSimilarity();
-    kpTransformAutoCropBorder leftBorder(&image, processedColorSimilarity), rightBorder(&image, processedColorSimilarity),
-        topBorder(&image, processedColorSimilarity), botBorder(&image, processedColorSimilarity);
-
-    kpSetOverrideCursorSaver cursorSaver(Qt::WaitCursor);
-
-    mainWindow->colorToolBar()->flashColorSimilarityToolBarItem();
-
     // TODO: With Colour Similarity, a lot of weird (and wonderful) things can
     //       happen resulting in a huge number of code paths.  Needs refactoring
     //       and regression testing.
@@ -568,7 +563,6 @@ bool kpTransformAutoCrop(kpMainWindow *mainWindow)
         qCDebug(kpLogImagelib) << "\tcan't find border; leftBorder.rect=" << leftBorder.rect() << " rightBorder.rect=" << rightBorder.rect()
                                << " topBorder.rect=" << topBorder.rect() << " botBorder.rect=" << botBorder.rect();
 #endif
-        ::ShowNothingToAutocropMessage(mainWindow, static_cast<bool>(doc->selection()));
         return false;
     }
 
@@ -619,8 +613,60 @@ bool kpTransformAutoCrop(kpMainWindow *mainWindow)
         }
     }
 
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+bool kpTransformAutoCrop(kpMainWindow *mainWindow)
+{
+#if DEBUG_KP_TOOL_AUTO_CROP
+    qCDebug(kpLogImagelib) << "kpTransformAutoCrop() CALLED!";
+#endif
+
+    Q_ASSERT(mainWindow);
+    kpDocument *doc = mainWindow->document();
+    Q_ASSERT(doc);
+
+    // OPT: if already pulled selection image, no need to do it again here
+    kpImage image = doc->selection() ? doc->getSelectedBaseImage() : doc->image();
+    Q_ASSERT(!image.isNull());
+
+    kpViewManager *vm = mainWindow->viewManager();
+    Q_ASSERT(vm);
+
+    int processedColorSimilarity = mainWindow->colorToolBar()->processedColorSimilarity();
+    kpTransformAutoCropBorder leftBorder(&image, processedColorSimilarity), rightBorder(&image, processedColorSimilarity),
+        topBorder(&image, processedColorSimilarity), botBorder(&image, processedColorSimilarity);
+
+    kpSetOverrideCursorSaver cursorSaver(Qt::WaitCursor);
+
+    mainWindow->colorToolBar()->flashColorSimilarityToolBarItem();
+
+    if (!::CalculateBorders(processedColorSimilarity, leftBorder, rightBorder, topBorder, botBorder)) {
+        ::ShowNothingToAutocropMessage(mainWindow, static_cast<bool>(doc->selection()));
+        return false;
+    }
+
     mainWindow->addImageOrSelectionCommand(
         new kpTransformAutoCropCommand(static_cast<bool>(doc->selection()), leftBorder, rightBorder, topBorder, botBorder, mainWindow->commandEnvironment()));
 
     return true;
 }
+
+//---------------------------------------------------------------------
+
+bool kpTransformAutoCropImage(kpImage *image, int processedColorSimilarity)
+{
+    Q_ASSERT(image && !image->isNull());
+
+    kpTransformAutoCropBorder leftBorder(image, processedColorSimilarity), rightBorder(image, processedColorSimilarity),
+        topBorder(image, processedColorSimilarity), botBorder(image, processedColorSimilarity);
+
+    if (!::CalculateBorders(processedColorSimilarity, leftBorder, rightBorder, topBorder, botBorder)) {
+        return false;
+    }
+
+    *image = kpTool::neededPixmap(*image, ::ContentsRect(image->size(), leftBorder, rightBorder, topBorder, botBorder));
+    return true;
+}
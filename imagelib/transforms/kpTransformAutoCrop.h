@@ -55,4 +55,11 @@ private:
 // (returns true on success (even if it did nothing) or false on error)
 bool kpTransformAutoCrop(kpMainWindow *mainWindow);
 
+// Removes the border of <*image> in place, using the same heuristics as
+// kpTransformAutoCrop() but without needing a kpMainWindow (e.g. for batch
+// processing).
+//
+// (returns true if a border was found and removed, else false)
+bool kpTransformAutoCropImage(kpImage *image, int processedColorSimilarity);
+
 #endif // KP_TRANSFORM_AUTO_CROP_H
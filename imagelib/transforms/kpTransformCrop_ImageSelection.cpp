@@ -15,7 +15,7 @@
 #include "commands/tools/selection/kpToolSelectionCreateCommand.h"
 #include "document/kpDocument.h"
 #include "environments/commands/kpCommandEnvironment.h"
-#include "imagelib/kpImage.h"
+#include "imagelib/kpCompressedImage.h"
 #include "layers/selections/image/kpAbstractImageSelection.h"
 #include "mainWindow/kpMainWindow.h"
 #include "pixmapfx/kpPixmapFX.h"
@@ -46,9 +46,24 @@ public:
     void execute() override;
     void unexecute() override;
 
+    void compress() override
+    {
+        m_oldImage.compressLater();
+    }
+
+    void spill(const std::shared_ptr<kpSpillFile> &file) override
+    {
+        m_oldImage.spillTo(file);
+    }
+
+    kpCommandSize::SizeType spilledSize() const override
+    {
+        return m_oldImage.spilledSize();
+    }
+
 protected:
     kpColor m_backgroundColor;
-    kpImage m_oldImage;
+    kpCompressedImage m_oldImage;
     kpAbstractImageSelection *m_fromSelectionPtr;
     kpImage m_imageIfFromSelectionDoesntHaveOne;
 };
@@ -152,8 +167,8 @@ void SetDocumentToSelectionImageCommand::unexecute()
 
     viewManager()->setQueueUpdates();
     {
-        document()->setImageAt(m_oldImage, QPoint(0, 0));
-        m_oldImage = kpImage();
+        document()->setImageAt(m_oldImage.image(), QPoint(0, 0));
+        m_oldImage = kpCompressedImage();
 
 #if DEBUG_KP_TOOL_CROP
         qCDebug(kpLogImagelib) << "\tsel: rect=" << m_fromSelectionPtr->boundingRect() << " pm=" << m_fromSelectionPtr->hasContent();
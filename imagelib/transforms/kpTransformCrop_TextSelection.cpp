@@ -34,7 +34,6 @@ void kpTransformCrop_TextSelection(kpMainWindow *mainWindow, const QString &comm
 #endif
     kpToolSelectionMoveCommand *moveCmd = new kpToolSelectionMoveCommand(QString() /*uninteresting child of macro cmd*/, environ);
     moveCmd->moveTo(QPoint(0, 0), true /*move on exec, not now*/);
-    moveCmd->finalize();
     macroCmd->addCommand(moveCmd);
 
     mainWindow->addImageOrSelectionCommand(macroCmd, true /*add create cmd*/, true /*add create content cmd*/);
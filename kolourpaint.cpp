@@ -7,6 +7,9 @@
 
 #include <KAboutData>
 
+#include "batch/kpBatchProcessor.h"
+#include "generic/kpProfiler.h"
+#include "imagelib/kpColor.h"
 #include "kpVersion.h"
 #include "mainWindow/kpMainWindow.h"
 #include <document/kpDocument.h>
@@ -15,12 +18,94 @@
 #include <KCrash>
 #include <KLocalizedString>
 #include <QApplication>
+#include <QColor>
 #include <QCommandLineParser>
 #include <QDir>
 #include <QImageReader>
+#include <QTimer>
+
+#include <cstring>
+
+// Batch mode never shows a window so it must be able to run on machines
+// without a display.  This has to be decided before QApplication exists.
+static void UseOffscreenPlatformForBatchMode(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        return;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--batch") == 0 || std::strncmp(argv[i], "--batch=", 8) == 0) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+            return;
+        }
+    }
+}
+
+static int RunBatchMode(const QCommandLineParser &cmdLine)
+{
+    kpBatchProcessor processor;
+
+    QString errorMessage;
+    if (!processor.setPipeline(cmdLine.value(QStringLiteral("batch")), &errorMessage)) {
+        fprintf(stderr, "%s\n\n%s\n", qPrintable(errorMessage), qPrintable(kpBatchProcessor::pipelineHelp()));
+        return 1;
+    }
+
+    const QString outputDir = cmdLine.value(QStringLiteral("batch-output"));
+    if (outputDir.isEmpty() || !QDir(outputDir).exists()) {
+        fprintf(stderr, "%s\n", qPrintable(i18n("--batch-output must name an existing directory.")));
+        return 1;
+    }
+    processor.setOutputDirectory(outputDir);
+
+    if (!processor.setOutputFormat(cmdLine.value(QStringLiteral("batch-format")))) {
+        fprintf(stderr, "%s\n", qPrintable(i18n("Unknown output format \"%1\".", cmdLine.value(QStringLiteral("batch-format")))));
+        return 1;
+    }
+
+    if (cmdLine.isSet(QStringLiteral("batch-quality"))) {
+        bool ok = false;
+        const int quality = cmdLine.value(QStringLiteral("batch-quality")).toInt(&ok);
+        if (!ok || quality < 0 || quality > 100) {
+            fprintf(stderr, "%s\n", qPrintable(i18n("--batch-quality must be a number from 0 to 100.")));
+            return 1;
+        }
+        processor.setQuality(quality);
+    }
+
+    if (cmdLine.isSet(QStringLiteral("batch-background"))) {
+        const QColor color = QColor::fromString(cmdLine.value(QStringLiteral("batch-background")));
+        if (!color.isValid()) {
+            fprintf(stderr, "%s\n", qPrintable(i18n("Unknown color \"%1\".", cmdLine.value(QStringLiteral("batch-background")))));
+            return 1;
+        }
+        processor.setBackgroundColor(kpColor(color.rgba()));
+    }
+
+    if (cmdLine.isSet(QStringLiteral("batch-jobs"))) {
+        bool ok = false;
+        const int jobs = cmdLine.value(QStringLiteral("batch-jobs")).toInt(&ok);
+        if (!ok || jobs <= 0) {
+            fprintf(stderr, "%s\n", qPrintable(i18n("--batch-jobs must be a number greater than 0.")));
+            return 1;
+        }
+        processor.setMaxThreadCount(jobs);
+    }
+
+    const QStringList files = cmdLine.positionalArguments();
+    if (files.isEmpty()) {
+        fprintf(stderr, "%s\n", qPrintable(i18n("No image files given.")));
+        return 1;
+    }
+
+    return processor.process(files) == 0 ? 0 : 2;
+}
 
 int main(int argc, char *argv[])
 {
+    ::UseOffscreenPlatformForBatchMode(argc, argv);
+
     QApplication app(argc, argv);
     QImageReader::setAllocationLimit(0); // no explicit memory limit
 
@@ -70,6 +155,16 @@ int main(int argc, char *argv[])
     aboutData.setupCommandLine(&cmdLine);
     cmdLine.addOption(QCommandLineOption(QStringLiteral("mimetypes"), i18n("List all readable image MIME types")));
     cmdLine.addOption(QCommandLineOption(QStringLiteral("new"), i18n("Start with new image using given size"), i18n("[width]x[height]")));
+    cmdLine.addOption(QCommandLineOption(QStringLiteral("batch"),
+                                         i18n("Process the given files without a window, applying a comma-separated pipeline of operations"),
+                                         i18n("operations")));
+    cmdLine.addOption(QCommandLineOption(QStringLiteral("batch-output"), i18n("Directory to write batch results to"), i18n("directory")));
+    cmdLine.addOption(QCommandLineOption(QStringLiteral("batch-format"), i18n("Format of batch results (default: same as input)"), i18n("type")));
+    cmdLine.addOption(QCommandLineOption(QStringLiteral("batch-quality"), i18n("Quality of batch results, for lossy formats"), i18n("quality")));
+    cmdLine.addOption(QCommandLineOption(QStringLiteral("batch-background"),
+                                         i18n("Color to fill new areas with when rotating or skewing in batch mode"),
+                                         i18n("color")));
+    cmdLine.addOption(QCommandLineOption(QStringLiteral("batch-jobs"), i18n("Number of files to process at once (default: one per core)"), i18n("count")));
     cmdLine.process(app);
     aboutData.processCommandLine(&cmdLine);
 
@@ -86,6 +181,14 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (cmdLine.isSet(QStringLiteral("batch"))) {
+        return ::RunBatchMode(cmdLine);
+    }
+
+    // Allows recording performance data from startup, for slowness that
+    // is hard to reproduce after enabling Settings / Show Performance Overlay.
+    kpProfiler::initFromEnvironment();
+
     if (app.isSessionRestored()) {
         // Creates a kpMainWindow using the default constructor and then
         // calls kpMainWindow::readProperties().
@@ -123,5 +226,11 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Offer to recover the images that were being edited when KolourPaint
+    // last crashed, once the windows are up.
+    if (auto *mainWindow = qobject_cast<kpMainWindow *>(KMainWindow::memberList().value(0))) {
+        QTimer::singleShot(0, mainWindow, &kpMainWindow::recoverCrashedDocuments);
+    }
+
     return QApplication::exec();
 }
@@ -9,11 +9,17 @@
 
 #include "layers/selections/image/kpAbstractImageSelection.h"
 
+#include <atomic>
+#include <cstring>
+
 #include <QBitmap>
+#include <QColor>
 #include <QPainter>
 
 #include "kpLogCategories.h"
 
+#include "generic/kpParallel.h"
+
 //---------------------------------------------------------------------
 
 // Returns whether <sel> can be set to have <baseImage>.
@@ -298,7 +304,14 @@ void kpAbstractImageSelection::setBaseImage(const kpImage &baseImage)
 
     // qt doc: the image format must be set to Format_ARGB32Premultiplied or Format_ARGB32
     // for the composition modes to have any effect
-    d->baseImage = baseImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    //
+    // (an image pulled from the document is usually in this format already,
+    //  in which case this shares, rather than copies, its pixels)
+    if (baseImage.format() == QImage::Format_ARGB32_Premultiplied || baseImage.isNull()) {
+        d->baseImage = baseImage;
+    } else {
+        d->baseImage = baseImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
 
     recalculateTransparencyMaskCache();
 
@@ -392,26 +405,49 @@ void kpAbstractImageSelection::recalculateTransparencyMaskCache()
         return;
     }
 
-    d->transparencyMaskCache = QBitmap(d->baseImage.size());
-
-    QPainter transparencyMaskPainter(&d->transparencyMaskCache);
-
-    bool hasTransparent = false;
-    for (int y = 0; y < d->baseImage.height(); y++) {
-        for (int x = 0; x < d->baseImage.width(); x++) {
-            const kpColor pixelCol = kpPixmapFX::getColorAtPixel(d->baseImage, x, y);
-            if (pixelCol == kpColor::Transparent || pixelCol.isSimilarTo(d->transparency.transparentColor(), d->transparency.processedColorSimilarity())) {
-                transparencyMaskPainter.setPen(Qt::color1 /*transparent*/);
-                hasTransparent = true;
-            } else {
-                transparencyMaskPainter.setPen(Qt::color0 /*opaque*/);
+    // (readFromStream() does not convert the image)
+    const QImage image = (d->baseImage.format() == QImage::Format_ARGB32_Premultiplied) ? d->baseImage
+                                                                                        : d->baseImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    const int width = image.width();
+    const int height = image.height();
+    const int processedColorSimilarity = d->transparency.processedColorSimilarity();
+    const kpColor transparentColor = d->transparency.transparentColor();
+
+    // (color0 = opaque, color1 = transparent - see QBitmap::fromImage())
+    QImage maskImage(width, height, QImage::Format_MonoLSB);
+    maskImage.setColorCount(2);
+    maskImage.setColor(0, QColor(Qt::color0).rgb());
+    maskImage.setColor(1, QColor(Qt::color1).rgb());
+
+    const uchar *const srcBits = image.constBits();
+    const qsizetype srcBytesPerLine = image.bytesPerLine();
+    uchar *const maskBits = maskImage.bits();
+    const qsizetype maskBytesPerLine = maskImage.bytesPerLine();
+
+    std::atomic<bool> hasTransparent(false);
+    kpParallelFor(height, qMax(1, 65536 / qMax(1, width)), [=, &hasTransparent](int begin, int end) {
+        bool chunkHasTransparent = false;
+
+        for (int y = begin; y < end; y++) {
+            const auto *srcLine = reinterpret_cast<const QRgb *>(srcBits + y * srcBytesPerLine);
+            uchar *maskLine = maskBits + y * maskBytesPerLine;
+            std::memset(maskLine, 0, maskBytesPerLine);
+
+            for (int x = 0; x < width; x++) {
+                // (sync: kpPixmapFX::getColorAtPixel())
+                const kpColor pixelCol(qUnpremultiply(srcLine[x]));
+                if (pixelCol == kpColor::Transparent || pixelCol.isSimilarTo(transparentColor, processedColorSimilarity)) {
+                    maskLine[x >> 3] |= uchar(1 << (x & 7));
+                    chunkHasTransparent = true;
+                }
             }
-
-            transparencyMaskPainter.drawPoint(x, y);
         }
-    }
 
-    transparencyMaskPainter.end();
+        if (chunkHasTransparent) {
+            hasTransparent = true;
+        }
+    });
 
     if (!hasTransparent) {
 #if DEBUG_KP_SELECTION
@@ -420,6 +456,8 @@ void kpAbstractImageSelection::recalculateTransparencyMaskCache()
         d->transparencyMaskCache = QBitmap();
         return;
     }
+
+    d->transparencyMaskCache = QBitmap::fromImage(std::move(maskImage));
 }
 
 //---------------------------------------------------------------------
@@ -469,14 +507,15 @@ void kpAbstractImageSelection::flip(bool horiz, bool vert)
 #if DEBUG_KP_SELECTION && 1
         qCDebug(kpLogLayers) << "\thave pixmap - flipping that";
 #endif
-        d->baseImage = d->baseImage.mirrored(horiz, vert);
+        kpPixmapFX::flip(&d->baseImage, horiz, vert);
     }
 
     if (!d->transparencyMaskCache.isNull()) {
 #if DEBUG_KP_SELECTION && 1
         qCDebug(kpLogLayers) << "\thave transparency mask - flipping that";
 #endif
-        QImage image = d->transparencyMaskCache.toImage().mirrored(horiz, vert);
+        QImage image = d->transparencyMaskCache.toImage();
+        kpPixmapFX::flip(&image, horiz, vert);
         d->transparencyMaskCache = QBitmap::fromImage(std::move(image));
     }
 
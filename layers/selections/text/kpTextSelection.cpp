@@ -53,6 +53,8 @@ kpTextSelection &kpTextSelection::operator=(const kpTextSelection &rhs)
     d->textStyle = rhs.d->textStyle;
     d->preeditText = rhs.d->preeditText;
 
+    d->textLayer = kpImage();
+
     return *this;
 }
 
@@ -236,13 +238,118 @@ QList<QString> kpTextSelection::textLines() const
 // public
 void kpTextSelection::setTextLines(const QList<QString> &textLines_)
 {
+    // Work out which rows changed, so that only they are re-rendered.
+    const int oldCount = static_cast<int>(d->textLines.count());
+    const int newCount = static_cast<int>(textLines_.count());
+    const int commonCount = qMin(oldCount, newCount);
+
+    int firstDirtyRow = 0;
+    while (firstDirtyRow < commonCount && d->textLines[firstDirtyRow] == textLines_[firstDirtyRow]) {
+        firstDirtyRow++;
+    }
+
+    int lastDirtyRow = qMax(oldCount, newCount) - 1;
+    if (oldCount == newCount) {
+        while (lastDirtyRow >= firstDirtyRow && d->textLines[lastDirtyRow] == textLines_[lastDirtyRow]) {
+            lastDirtyRow--;
+        }
+    }
+
     d->textLines = textLines_;
 
+    if (firstDirtyRow <= lastDirtyRow) {
+        invalidateTextLayerRows(firstDirtyRow, lastDirtyRow);
+    }
+
     Q_EMIT changed(boundingRect());
 }
 
 //--------------------------------------------------------------------------------
 
+// public
+void kpTextSelection::insertText(int row, int col, const QString &text)
+{
+    Q_ASSERT(row >= 0 && row < d->textLines.count());
+    Q_ASSERT(col >= 0 && col <= d->textLines[row].length());
+
+    if (text.isEmpty()) {
+        return;
+    }
+
+    if (!text.contains(QLatin1Char('\n'))) {
+        d->textLines[row].insert(col, text);
+
+        invalidateTextLayerRows(row, row);
+        Q_EMIT changed(textEditDirtyRect(row, col, false /*just this row*/));
+        return;
+    }
+
+    const QList<QStringView> newLines = QStringView(text).split(QLatin1Char('\n'));
+    Q_ASSERT(newLines.count() >= 2);
+
+    const QString rightHalf = d->textLines[row].mid(col);
+    d->textLines[row].truncate(col);
+    d->textLines[row] += newLines.first();
+
+    // Make room for all the new lines at once, rather than shuffling the
+    // rows below down one line at a time.
+    d->textLines.insert(row + 1, newLines.count() - 1, QString());
+    for (int i = 1; i < newLines.count(); i++) {
+        d->textLines[row + i] = newLines[i].toString();
+    }
+    d->textLines[row + newLines.count() - 1] += rightHalf;
+
+    invalidateTextLayerRows(row, static_cast<int>(d->textLines.count()) - 1);
+    Q_EMIT changed(textEditDirtyRect(row, col, true /*and all rows below*/));
+}
+
+// public
+void kpTextSelection::deleteText(int row, int col, int length)
+{
+    Q_ASSERT(row >= 0 && row < d->textLines.count());
+    Q_ASSERT(col >= 0 && length >= 0 && col + length <= d->textLines[row].length());
+
+    if (length == 0) {
+        return;
+    }
+
+    d->textLines[row].remove(col, length);
+
+    invalidateTextLayerRows(row, row);
+    Q_EMIT changed(textEditDirtyRect(row, col, false /*just this row*/));
+}
+
+// public
+void kpTextSelection::splitTextLine(int row, int col)
+{
+    Q_ASSERT(row >= 0 && row < d->textLines.count());
+    Q_ASSERT(col >= 0 && col <= d->textLines[row].length());
+
+    const QString rightHalf = d->textLines[row].mid(col);
+    d->textLines[row].truncate(col);
+    d->textLines.insert(row + 1, rightHalf);
+
+    invalidateTextLayerRows(row, static_cast<int>(d->textLines.count()) - 1);
+    Q_EMIT changed(textEditDirtyRect(row, col, true /*and all rows below*/));
+}
+
+// public
+void kpTextSelection::joinTextLines(int row)
+{
+    Q_ASSERT(row >= 0 && row + 1 < d->textLines.count());
+
+    const int col = d->textLines[row].length();
+
+    d->textLines[row] += d->textLines[row + 1];
+    d->textLines.removeAt(row + 1);
+
+    // (the old last row is now empty)
+    invalidateTextLayerRows(row, static_cast<int>(d->textLines.count()));
+    Q_EMIT changed(textEditDirtyRect(row, col, true /*and all rows below*/));
+}
+
+//--------------------------------------------------------------------------------
+
 // public static
 QString kpTextSelection::textForTextLines(const QList<QString> &textLines)
 {
@@ -288,6 +395,15 @@ kpPreeditText kpTextSelection::preeditText() const
 
 void kpTextSelection::setPreeditText(const kpPreeditText &preeditText)
 {
+    // The preedit text is drawn on row 0 if there are no text lines.
+    // Otherwise, it is drawn in the middle of its row.
+    for (const kpPreeditText *p : {&d->preeditText, &preeditText}) {
+        if (!p->isEmpty()) {
+            const int row = d->textLines.isEmpty() ? 0 : p->position().y();
+            invalidateTextLayerRows(row, row);
+        }
+    }
+
     d->preeditText = preeditText;
     Q_EMIT changed(boundingRect());
 }
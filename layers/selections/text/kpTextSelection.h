@@ -180,6 +180,24 @@ public:
     QList<QString> textLines() const;
     void setTextLines(const QList<QString> &textLines);
 
+    // Incremental editing.
+    //
+    // Unlike setTextLines(), these edit textLines() in place and only
+    // report (via changed()) the part of the text box that needs to be
+    // repainted.  Each takes time proportional to the length of the edited
+    // line, not to the length of the whole text.
+    //
+    // <row> and <col> must be valid text cursor positions.
+
+    // Inserts <text> before <col>.  Newlines in <text> split the line.
+    void insertText(int row, int col, const QString &text);
+    // Removes <length> characters, starting from <col>, in a single line.
+    void deleteText(int row, int col, int length);
+    // Moves the text after <col> onto a new line after <row>.
+    void splitTextLine(int row, int col);
+    // Appends the line after <row> onto <row>.
+    void joinTextLines(int row);
+
     static QString textForTextLines(const QList<QString> &textLines);
     // Returns textLines() as one long newline-separated string.
     // If the last text line is not empty, there is no trailing newline.
@@ -233,6 +251,24 @@ public:
 private:
     void drawPreeditString(QPainter &painter, int &x, int y, const kpPreeditText &preeditText) const;
 
+    // Renders text rows <firstRow> to <lastRow> (inclusive), and the
+    // background, clipped to <bandRect>.  Coordinates are relative to the
+    // top-left of boundingRect().
+    void paintTextLayerBand(QPainter &painter, const QRect &bandRect, int firstRow, int lastRow) const;
+
+    // Brings kpTextSelectionPrivate::textLayer up to date, re-rendering
+    // only the text rows that have changed since it was last rendered.
+    void updateTextLayer() const;
+
+    // Marks text rows <firstRow> to <lastRow> (inclusive) as needing to be
+    // re-rendered by updateTextLayer().
+    void invalidateTextLayerRows(int firstRow, int lastRow);
+
+    // Returns the part of the text box that needs to be repainted after
+    // editing <row> at and after <col>.  If <toBottom>, all rows below
+    // <row> are included as well (since they have moved).
+    QRect textEditDirtyRect(int row, int col, bool toBottom) const;
+
 public:
     void paint(QImage *destPixmap, const QRect &docRect) const override;
 
@@ -8,16 +8,45 @@
 #ifndef kpTextSelectionPrivate_H
 #define kpTextSelectionPrivate_H
 
+#include <QGlyphRun>
+#include <QHash>
 #include <QList>
 
 #include "imagelib/kpImage.h"
 #include "layers/selections/text/kpPreeditText.h"
 #include "layers/selections/text/kpTextStyle.h"
 
+// A text line, laid out in a given font.
+struct kpTextSelectionGlyphs {
+    QList<QGlyphRun> glyphRuns;
+    // Distance from the top of <glyphRuns> to the baseline.
+    qreal ascent{0};
+};
+
 struct kpTextSelectionPrivate {
     QList<QString> textLines;
     kpTextStyle textStyle;
     kpPreeditText preeditText;
+
+    //
+    // Rendering caches (see kpTextSelection_Paint.cpp).
+    //
+    // These are not copied by kpTextSelection::operator=().
+    //
+
+    // Laid out text lines, keyed by line content, for <glyphCacheTextStyle>.
+    QHash<QString, kpTextSelectionGlyphs> glyphCache;
+    kpTextStyle glyphCacheTextStyle;
+
+    // The text box rendered with its top-left at (0,0) - what paint() would
+    // draw onto a fully transparent document.  Null if not rendered.
+    kpImage textLayer;
+    // The text style <textLayer> was rendered in.
+    kpTextStyle textLayerTextStyle;
+    // The range of text rows (inclusive) that have changed since <textLayer>
+    // was rendered, or -1 if none.  Only these rows are re-rendered.
+    int textLayerFirstDirtyRow{-1};
+    int textLayerLastDirtyRow{-1};
 };
 
 #endif // kpTextSelectionPrivate_H
@@ -17,12 +17,16 @@
 #include "kpTextStyle.h"
 #include "pixmapfx/kpPixmapFX.h"
 
+#include "kpDefs.h"
 #include "kpLogCategories.h"
 
 #include <QFont>
+#include <QFontMetrics>
+#include <QGlyphRun>
 #include <QList>
 #include <QPainter>
 #include <QTextCharFormat>
+#include <QTextLayout>
 
 //---------------------------------------------------------------------
 
@@ -83,56 +87,130 @@ void kpTextSelection::drawPreeditString(QPainter &painter, int &x, int y, const
 
 //---------------------------------------------------------------------
 
-// public virtual [kpAbstractSelection]
-void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
+// Anything bigger is rendered without caching, to avoid holding on to a
+// large image for a text box that is mostly off-screen.
+static const qint64 MaxTextLayerPixels = 16 * 1024 * 1024;
+
+// Upper bound on the number of distinct laid out text lines kept around.
+static const int MaxGlyphCacheLines = 1024;
+
+//---------------------------------------------------------------------
+
+static const kpTextSelectionGlyphs &GlyphsForTextLine(kpTextSelectionPrivate *d, const QString &textLine, const QFont &font)
 {
-#if DEBUG_KP_SELECTION
-    qCDebug(kpLogLayers) << "kpTextSelection::paint() textStyle: fcol=" << (int *)d->textStyle.foregroundColor().toQRgb()
-                         << " bcol=" << (int *)d->textStyle.backgroundColor().toQRgb();
-#endif
+    QHash<QString, kpTextSelectionGlyphs>::const_iterator it = d->glyphCache.constFind(textLine);
+    if (it != d->glyphCache.constEnd()) {
+        return it.value();
+    }
 
-    // Drawing text is slow so if the text box will be rendered completely
-    // outside of <destRect>, don't bother rendering it at all.
-    const QRect modifyingRect = docRect.intersected(boundingRect());
-    if (modifyingRect.isEmpty()) {
-        return;
+    if (d->glyphCache.size() >= MaxGlyphCacheLines) {
+        d->glyphCache.clear();
     }
 
-    // Is the text box completely invisible?
-    if (textStyle().foregroundColor().isTransparent() && textStyle().backgroundColor().isTransparent()) {
-        return;
+    QTextLayout layout(textLine, font);
+
+    QTextOption option;
+    option.setWrapMode(QTextOption::NoWrap);
+    option.setAlignment(Qt::AlignLeft | Qt::AlignAbsolute);
+    layout.setTextOption(option);
+
+    layout.beginLayout();
+    const QTextLine line = layout.createLine();
+    layout.endLayout();
+
+    kpTextSelectionGlyphs glyphs;
+    glyphs.glyphRuns = layout.glyphRuns();
+    glyphs.ascent = line.isValid() ? line.ascent() : 0;
+
+    return d->glyphCache.insert(textLine, glyphs).value();
+}
+
+//---------------------------------------------------------------------
+
+// Draws <glyphs> with their baseline at <baseLine>, like
+// QPainter::drawText(x, baseLine, <text line>).
+static void DrawTextLineGlyphs(QPainter &painter, const kpTextSelectionGlyphs &glyphs, int x, int baseLine)
+{
+    const QPointF origin(x, baseLine - glyphs.ascent);
+
+    for (const QGlyphRun &glyphRun : glyphs.glyphRuns) {
+        painter.drawGlyphRun(origin, glyphRun);
     }
+}
+
+//---------------------------------------------------------------------
+
+// Returns the index of the last text row whose top is inside <textAreaRect>.
+// Rows after that are never drawn.
+static int LastVisibleTextRow(const QRect &textAreaRect, const QFontMetrics &fontMetrics)
+{
+    return qMax(0, textAreaRect.height() / qMax(1, fontMetrics.lineSpacing()));
+}
 
-    kpImage floatImage(modifyingRect.size(), QImage::Format_ARGB32_Premultiplied);
-    floatImage.fill(0);
+//---------------------------------------------------------------------
 
-    QRect theWholeAreaRect, theTextAreaRect;
-    theWholeAreaRect = boundingRect().translated(-modifyingRect.topLeft());
-    theTextAreaRect = textAreaRect().translated(-modifyingRect.topLeft());
+// Returns the part of <layerRect> that text row <row> is responsible for.
+// The first and last rows also own the text border above and below them.
+static QRect TextRowBandRect(const QRect &layerRect, const QRect &textAreaRect, const QFontMetrics &fontMetrics, int row, int lastRow)
+{
+    const int top = (row == 0) ? layerRect.top() : textAreaRect.y() + row * fontMetrics.lineSpacing();
+    const int bottom = (row >= lastRow) ? layerRect.bottom() : textAreaRect.y() + (row + 1) * fontMetrics.lineSpacing() - 1;
 
-    QList<QString> theTextLines = textLines();
-    kpTextStyle theTextStyle = textStyle();
+    return QRect(QPoint(layerRect.left(), top), QPoint(layerRect.right(), bottom));
+}
 
-    const QFontMetrics fontMetrics(theTextStyle.font());
+//---------------------------------------------------------------------
+
+// Returns how many rows beyond its own the glyphs of a text row can reach
+// into (e.g. descenders and italics reach into the next row, and more so
+// if the font's line spacing is less than its height).
+static int OverhangRows(const QFontMetrics &fontMetrics)
+{
+    const int lineSpacing = qMax(1, fontMetrics.lineSpacing());
+    return 1 + (qMax(0, fontMetrics.height() - lineSpacing) + lineSpacing - 1) / lineSpacing;
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTextSelection::paintTextLayerBand(QPainter &painter, const QRect &bandRect, int firstRow, int lastRow) const
+{
+    const kpTextStyle theTextStyle = textStyle();
+    const QFont font = theTextStyle.font();
+    const QFontMetrics fontMetrics(font);
 
 #if DEBUG_KP_SELECTION
-    qCDebug(kpLogLayers) << "kpTextSelection_Paint.cpp:DrawTextHelper";
+    qCDebug(kpLogLayers) << "kpTextSelection::paintTextLayerBand(" << bandRect << ") rows" << firstRow << "-" << lastRow;
     qCDebug(kpLogLayers) << "\theight=" << fontMetrics.height() << " leading=" << fontMetrics.leading() << " ascent=" << fontMetrics.ascent()
                          << " descent=" << fontMetrics.descent() << " lineSpacing=" << fontMetrics.lineSpacing();
 #endif
 
-    QPainter painter(&floatImage);
+    if (d->glyphCacheTextStyle != theTextStyle) {
+        d->glyphCache.clear();
+        d->glyphCacheTextStyle = theTextStyle;
+    }
+
+    const QRect theTextAreaRect = textAreaRect().translated(-topLeft());
+    const QList<QString> &theTextLines = d->textLines;
+
+    painter.save();
 
-    // Fill in the background using the transparent/opaque tool setting
+    painter.setClipRect(bandRect);
+
+    // Fill in the background using the transparent/opaque tool setting.
+    // Use Source, not SourceOver, since we may be re-rendering on top of
+    // an older version of this band.
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
     if (theTextStyle.isBackgroundTransparent()) {
-        painter.fillRect(theWholeAreaRect, Qt::transparent);
+        painter.fillRect(bandRect, Qt::transparent);
     } else {
-        painter.fillRect(theWholeAreaRect, theTextStyle.backgroundColor().toQColor());
+        painter.fillRect(bandRect, theTextStyle.backgroundColor().toQColor());
     }
 
-    painter.setClipRect(theWholeAreaRect);
     painter.setPen(theTextStyle.foregroundColor().toQColor());
-    painter.setFont(theTextStyle.font());
+    painter.setFont(font);
+
+    const int lastTextRow = qMin(lastRow, static_cast<int>(theTextLines.count()) - 1);
 
     if (theTextStyle.foregroundColor().toQColor().alpha() < 255) {
         // if the foreground color has an alpha channel, we want to
@@ -140,41 +218,37 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
         // into the background where the text is
         painter.setCompositionMode(QPainter::CompositionMode_Clear);
 
-        int baseLine = theTextAreaRect.y() + fontMetrics.ascent();
-        for (const auto &str : theTextLines) {
-            painter.drawText(theTextAreaRect.x(), baseLine, str);
-            baseLine += fontMetrics.lineSpacing();
-
-            // if the next textline would already be below the visible text area, stop drawing
-            if ((baseLine - fontMetrics.ascent()) > (theTextAreaRect.y() + theTextAreaRect.height())) {
-                break;
-            }
+        for (int row = firstRow; row <= lastTextRow; row++) {
+            const int baseLine = theTextAreaRect.y() + fontMetrics.ascent() + row * fontMetrics.lineSpacing();
+            ::DrawTextLineGlyphs(painter, ::GlyphsForTextLine(d, theTextLines[row], font), theTextAreaRect.x(), baseLine);
         }
-        // the next text drawing will now blend the text foreground color with
-        // what is really below the text background
-        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
     }
 
+    // the text drawing will now blend the text foreground color with
+    // what is really below the text background
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
     // Draw a line at a time instead of using QPainter::drawText(QRect,...).
     // Else, the line heights become >QFontMetrics::height() if you type Chinese
     // characters (!) and then the cursor gets out of sync.
-    int baseLine = theTextAreaRect.y() + fontMetrics.ascent();
-
-    kpPreeditText thePreeditText = preeditText();
+    const kpPreeditText &thePreeditText = d->preeditText;
 
     if (theTextLines.isEmpty()) {
-        if (!thePreeditText.isEmpty()) {
+        if (firstRow == 0 && !thePreeditText.isEmpty()) {
             int x = theTextAreaRect.x();
-            drawPreeditString(painter, x, baseLine, thePreeditText);
+            drawPreeditString(painter, x, theTextAreaRect.y() + fontMetrics.ascent(), thePreeditText);
         }
     } else {
-        int i = 0;
-        int row = thePreeditText.position().y();
-        int col = thePreeditText.position().x();
-        for (const auto &str : theTextLines) {
-            if (row == i && !thePreeditText.isEmpty()) {
-                QString left = str.left(col);
-                QString right = str.mid(col);
+        const int preeditRow = thePreeditText.isEmpty() ? -1 : thePreeditText.position().y();
+        const int preeditCol = thePreeditText.position().x();
+
+        for (int row = firstRow; row <= lastTextRow; row++) {
+            const QString &str = theTextLines[row];
+            const int baseLine = theTextAreaRect.y() + fontMetrics.ascent() + row * fontMetrics.lineSpacing();
+
+            if (row == preeditRow) {
+                QString left = str.left(preeditCol);
+                QString right = str.mid(preeditCol);
                 int x = theTextAreaRect.x();
                 painter.drawText(x, baseLine, left);
                 x += fontMetrics.horizontalAdvance(left);
@@ -182,21 +256,152 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
 
                 painter.drawText(x, baseLine, right);
             } else {
-                painter.drawText(theTextAreaRect.x(), baseLine, str);
-            }
-            baseLine += fontMetrics.lineSpacing();
-            i++;
-
-            // if the next textline would already be below the visible text area, stop drawing
-            if ((baseLine - fontMetrics.ascent()) > (theTextAreaRect.y() + theTextAreaRect.height())) {
-                break;
+                ::DrawTextLineGlyphs(painter, ::GlyphsForTextLine(d, str, font), theTextAreaRect.x(), baseLine);
             }
         }
     }
 
-    // ... convert that into "painting" transparent pixels on top of
-    // the document.
-    kpPixmapFX::paintPixmapAt(destPixmap, modifyingRect.topLeft() - docRect.topLeft(), floatImage);
+    painter.restore();
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTextSelection::updateTextLayer() const
+{
+    const kpTextStyle theTextStyle = textStyle();
+    const QFontMetrics fontMetrics(theTextStyle.font());
+
+    const QRect layerRect(QPoint(0, 0), boundingRect().size());
+    const QRect theTextAreaRect = textAreaRect().translated(-topLeft());
+    const int lastRow = ::LastVisibleTextRow(theTextAreaRect, fontMetrics);
+
+    if (d->textLayer.isNull() || d->textLayer.size() != layerRect.size() || d->textLayerTextStyle != theTextStyle) {
+#if DEBUG_KP_SELECTION
+        qCDebug(kpLogLayers) << "kpTextSelection::updateTextLayer() full render";
+#endif
+
+        d->textLayer = kpImage(layerRect.size(), QImage::Format_ARGB32_Premultiplied);
+        d->textLayer.fill(0);
+
+        QPainter painter(&d->textLayer);
+        paintTextLayerBand(painter, layerRect, 0, lastRow);
+
+        d->textLayerTextStyle = theTextStyle;
+    } else if (d->textLayerFirstDirtyRow >= 0 && d->textLayerFirstDirtyRow <= lastRow) {
+        // Glyphs can extend beyond their row (e.g. descenders), so also
+        // redraw the bands of the rows they reach into, and draw the rows
+        // that reach into those bands (clipped to the bands).
+        const int overhangRows = ::OverhangRows(fontMetrics);
+        const int firstBandRow = qMax(0, d->textLayerFirstDirtyRow - overhangRows);
+        const int lastBandRow = qMin(lastRow, d->textLayerLastDirtyRow + overhangRows);
+
+#if DEBUG_KP_SELECTION
+        qCDebug(kpLogLayers) << "kpTextSelection::updateTextLayer() re-render rows" << firstBandRow << "-" << lastBandRow;
+#endif
+
+        const QRect bandRect = ::TextRowBandRect(layerRect, theTextAreaRect, fontMetrics, firstBandRow, lastRow)
+                                   .united(::TextRowBandRect(layerRect, theTextAreaRect, fontMetrics, lastBandRow, lastRow));
+
+        QPainter painter(&d->textLayer);
+        paintTextLayerBand(painter, bandRect, qMax(0, firstBandRow - overhangRows), qMin(lastRow, lastBandRow + overhangRows));
+    }
+
+    d->textLayerFirstDirtyRow = d->textLayerLastDirtyRow = -1;
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTextSelection::invalidateTextLayerRows(int firstRow, int lastRow)
+{
+    Q_ASSERT(firstRow >= 0 && firstRow <= lastRow);
+
+    if (d->textLayerFirstDirtyRow < 0) {
+        d->textLayerFirstDirtyRow = firstRow;
+        d->textLayerLastDirtyRow = lastRow;
+    } else {
+        d->textLayerFirstDirtyRow = qMin(d->textLayerFirstDirtyRow, firstRow);
+        d->textLayerLastDirtyRow = qMax(d->textLayerLastDirtyRow, lastRow);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+QRect kpTextSelection::textEditDirtyRect(int row, int col, bool toBottom) const
+{
+    // Start a character early since the previous glyph might overhang
+    // into the edited text (e.g. italics or kerning).
+    const QPoint rowColPoint = pointForTextRowCol(row, qMax(0, col - 1));
+    if (rowColPoint == KP_INVALID_POINT) {
+        return boundingRect();
+    }
+
+    const QFontMetrics fontMetrics(d->textStyle.fontMetrics());
+    const QRect theBoundingRect = boundingRect();
+
+    // As in updateTextLayer(), allow for glyphs overhanging their rows.
+    const int top = rowColPoint.y() - fontMetrics.descent();
+
+    QRect dirtyRect;
+    if (toBottom) {
+        // All rows below have moved.
+        dirtyRect = QRect(QPoint(theBoundingRect.left(), top), theBoundingRect.bottomRight());
+    } else {
+        const int bottom = rowColPoint.y() + fontMetrics.lineSpacing() - 1 + fontMetrics.descent();
+        dirtyRect = QRect(QPoint(rowColPoint.x(), top), QPoint(theBoundingRect.right(), bottom));
+    }
+
+    return dirtyRect.intersected(theBoundingRect);
+}
+
+//---------------------------------------------------------------------
+
+// public virtual [kpAbstractSelection]
+void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
+{
+#if DEBUG_KP_SELECTION
+    qCDebug(kpLogLayers) << "kpTextSelection::paint() textStyle: fcol=" << (int *)d->textStyle.foregroundColor().toQRgb()
+                         << " bcol=" << (int *)d->textStyle.backgroundColor().toQRgb();
+#endif
+
+    // Drawing text is slow so if the text box will be rendered completely
+    // outside of <destRect>, don't bother rendering it at all.
+    const QRect modifyingRect = docRect.intersected(boundingRect());
+    if (modifyingRect.isEmpty()) {
+        return;
+    }
+
+    // Is the text box completely invisible?
+    if (textStyle().foregroundColor().isTransparent() && textStyle().backgroundColor().isTransparent()) {
+        return;
+    }
+
+    if (qint64(width()) * height() > MaxTextLayerPixels) {
+        // Render only the visible part, without caching.
+        kpImage floatImage(modifyingRect.size(), QImage::Format_ARGB32_Premultiplied);
+        floatImage.fill(0);
+
+        const QFontMetrics fontMetrics(textStyle().font());
+        const QRect theTextAreaRect = textAreaRect().translated(-topLeft());
+
+        QPainter painter(&floatImage);
+        painter.translate(topLeft() - modifyingRect.topLeft());
+        paintTextLayerBand(painter, QRect(QPoint(0, 0), boundingRect().size()), 0, ::LastVisibleTextRow(theTextAreaRect, fontMetrics));
+        painter.end();
+
+        // ... convert that into "painting" transparent pixels on top of
+        // the document.
+        kpPixmapFX::paintPixmapAt(destPixmap, modifyingRect.topLeft() - docRect.topLeft(), floatImage);
+        return;
+    }
+
+    updateTextLayer();
+
+    // "Paint" the cached, transparent pixels on top of the document.
+    QPainter painter(destPixmap);
+    painter.drawImage(modifyingRect.topLeft() - docRect.topLeft(), d->textLayer, modifyingRect.translated(-topLeft()));
 }
 
 //---------------------------------------------------------------------
@@ -10,6 +10,7 @@
 
 #include "commands/kpCommandHistory.h"
 #include "document/kpDocument.h"
+#include "document/kpDocumentJournal.h"
 #include "environments/commands/kpCommandEnvironment.h"
 #include "environments/document/kpDocumentEnvironment.h"
 #include "environments/tools/kpToolEnvironment.h"
@@ -525,6 +526,13 @@ void kpMainWindow::setDocument(kpDocument *newDoc)
     qCDebug(kpLogMainWindow) << "\t\td->document=" << d->document;
 #endif
     // destroy current document
+    if (d->document) {
+        // (so that errors are still reported and the status bar updated)
+        d->document->waitForBackgroundSave();
+    }
+    // (deletes the journal, since the document is being closed on purpose)
+    delete d->documentJournal;
+    d->documentJournal = nullptr;
     delete d->document;
     d->document = newDoc;
 
@@ -604,14 +612,23 @@ void kpMainWindow::setDocument(kpDocument *newDoc)
 
         connect(d->document, &kpDocument::documentSaved, this, &kpMainWindow::slotEnableSettingsShowPath);
 
+        connect(d->document, &kpDocument::backgroundSaveStarted, this, &kpMainWindow::slotBackgroundSaveStarted);
+        connect(d->document, &kpDocument::backgroundSaveProgress, this, &kpMainWindow::slotBackgroundSaveProgress);
+        connect(d->document, &kpDocument::backgroundSaveFinished, this, &kpMainWindow::slotBackgroundSaveFinished);
+
         // Command history
         Q_ASSERT(d->commandHistory);
         connect(d->commandHistory, &kpCommandHistory::documentRestored, this, &kpMainWindow::slotDocumentRestored); // caption "!modified"
 
         connect(d->document, &kpDocument::documentSaved, d->commandHistory, &kpCommandHistory::documentSaved);
 
+        // Crash recovery
+        d->documentJournal = new kpDocumentJournal(d->document, this);
+        connect(d->commandHistory, &kpCommandHistory::commandsChanged, d->documentJournal, &kpDocumentJournal::flush);
+
         // Sync document -> views
         connect(d->document, &kpDocument::contentsChanged, d->viewManager, &kpViewManager::updateViews);
+        connect(d->document, &kpDocument::adjustmentsChanged, d->viewManager, &kpViewManager::updateViews);
 
         connect(d->document, static_cast<void (kpDocument::*)(int, int)>(&kpDocument::sizeChanged), d->viewManager, &kpViewManager::adjustViewsToEnvironment);
 
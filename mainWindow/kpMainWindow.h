@@ -22,6 +22,7 @@ class QDragEnterEvent;
 class QDropEvent;
 class QMenu;
 class QMoveEvent;
+class QPainter;
 class QPoint;
 class QRect;
 class QSize;
@@ -70,6 +71,11 @@ public:
 
     void finalizeGUI(KXMLGUIClient *client) override;
 
+    // Offers to recover the documents of KolourPaint processes that did not
+    // exit normally (see kpDocumentJournal), opening each one recovered in
+    // this window, if it is empty, or in a new one.
+    void recoverCrashedDocuments();
+
 private:
     void readGeneralSettings();
     void readThumbnailSettings();
@@ -311,9 +317,13 @@ private Q_SLOTS:
 
     void slotProperties();
 
-    bool save(bool localOnly = false);
+    bool save(bool localOnly = false, bool inBackground = false);
     bool slotSave();
 
+    void slotBackgroundSaveStarted(const QUrl &url);
+    void slotBackgroundSaveProgress(int percent);
+    void slotBackgroundSaveFinished(const QUrl &url, bool success);
+
 private:
     QUrl askForSaveURL(const QString &caption,
                        const QString &startURL,
@@ -327,7 +337,7 @@ private:
                        bool *allowLossyPrompt);
 
 private Q_SLOTS:
-    bool saveAs(bool localOnly = false);
+    bool saveAs(bool localOnly = false, bool inBackground = false);
     bool slotSaveAs();
 
     bool slotExport();
@@ -340,6 +350,10 @@ private:
     void sendDocumentNameToPrinter(QPrinter *printer);
     void setPrinterPageOrientation(QPrinter *printer);
     void sendImageToPrinter(QPrinter *printer, bool showPrinterSetupDialog);
+    // Draws the document, including any selection, stretched to
+    // <printedSize>, at <origin> on <painter> - one horizontal band at a
+    // time, to bound memory use.
+    void sendImageBandsToPrinter(QPainter *painter, const QPoint &origin, const QSize &printedSize);
 
 private Q_SLOTS:
     void slotPrint();
@@ -529,6 +543,7 @@ private Q_SLOTS:
     void slotClear();
     void slotMakeConfidential();
     void slotMoreEffects();
+    void slotAdjustments();
 
     //
     // Colors Menu
@@ -584,6 +599,9 @@ private Q_SLOTS:
     void slotShowPathToggled();
     void slotDrawAntiAliasedToggled(bool on);
 
+    void slotShowPerformanceOverlayToggled(bool on);
+    void slotExportPerformanceTrace();
+
     void slotKeyBindings();
 
     //
@@ -20,6 +20,7 @@
 class QAction;
 class QActionGroup;
 class QLabel;
+class QProgressBar;
 
 class KSelectAction;
 class KToggleAction;
@@ -37,7 +38,9 @@ class kpZoomedView;
 class kpThumbnail;
 class kpThumbnailView;
 class kpDocument;
+class kpDocumentJournal;
 class kpViewManager;
+class kpProfilerOverlay;
 class kpColorToolBar;
 class kpToolToolBar;
 class kpCommandHistory;
@@ -53,6 +56,7 @@ struct kpMainWindowPrivate {
         , thumbnail(nullptr)
         , thumbnailView(nullptr)
         , document(nullptr)
+        , documentJournal(nullptr)
         , viewManager(nullptr)
         , colorToolBar(nullptr)
         , toolToolBar(nullptr)
@@ -206,6 +210,7 @@ struct kpMainWindowPrivate {
         , actionConvertToGrayscale(nullptr)
         , actionBlur(nullptr)
         , actionMoreEffects(nullptr)
+        , actionAdjustments(nullptr)
         , actionInvertColors(nullptr)
         , actionClear(nullptr)
         ,
@@ -235,6 +240,9 @@ struct kpMainWindowPrivate {
         // Settings Menu
 
         actionShowPath(nullptr)
+        , actionShowPerformanceOverlay(nullptr)
+        , actionExportPerformanceTrace(nullptr)
+        , profilerOverlay(nullptr)
         , actionKeyBindings(nullptr)
         , actionConfigureToolbars(nullptr)
         , actionConfigure(nullptr)
@@ -245,6 +253,7 @@ struct kpMainWindowPrivate {
 
         statusBarCreated(false)
         , statusBarMessageLabel(nullptr)
+        , statusBarSaveProgress(nullptr)
         , statusBarShapeLastPointsInitialised(false)
         , statusBarShapeLastSizeInitialised(false)
         ,
@@ -269,6 +278,7 @@ struct kpMainWindowPrivate {
     kpThumbnail *thumbnail;
     kpThumbnailView *thumbnailView;
     kpDocument *document;
+    kpDocumentJournal *documentJournal;
     kpViewManager *viewManager;
     kpColorToolBar *colorToolBar;
     kpToolToolBar *toolToolBar;
@@ -363,7 +373,7 @@ struct kpMainWindowPrivate {
     bool imageMenuDocumentActionsEnabled;
 
     QAction *actionResizeScale, *actionCrop, *actionAutoCrop, *actionFlip, *actionMirror, *actionRotate, *actionRotateLeft, *actionRotateRight, *actionSkew,
-        *actionConvertToBlackAndWhite, *actionConvertToGrayscale, *actionBlur, *actionMoreEffects, *actionInvertColors, *actionClear;
+        *actionConvertToBlackAndWhite, *actionConvertToGrayscale, *actionBlur, *actionMoreEffects, *actionAdjustments, *actionInvertColors, *actionClear;
 
     // Implemented in kpMainWindow_Tools.cpp, not kpImageWindow_Image.cpp
     // since they're really setting tool options.
@@ -392,6 +402,9 @@ struct kpMainWindowPrivate {
     //
 
     KToggleAction *actionShowPath;
+    KToggleAction *actionShowPerformanceOverlay;
+    QAction *actionExportPerformanceTrace;
+    kpProfilerOverlay *profilerOverlay;
     QAction *actionKeyBindings, *actionConfigureToolbars, *actionConfigure;
     KToggleFullScreenAction *actionFullScreen;
 
@@ -401,6 +414,8 @@ struct kpMainWindowPrivate {
 
     bool statusBarCreated;
     KSqueezedTextLabel *statusBarMessageLabel;
+    // Shown while kpDocument::saveInBackground() is writing.
+    QProgressBar *statusBarSaveProgress;
     QList<QLabel *> statusBarLabels;
 
     bool statusBarShapeLastPointsInitialised;
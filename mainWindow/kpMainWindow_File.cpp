@@ -24,6 +24,7 @@
 #include <QPrintDialog>
 #include <QPrintPreviewDialog>
 #include <QPrinter>
+#include <QProgressBar>
 #include <QScreen>
 #include <QSize>
 #include <QSpinBox>
@@ -47,14 +48,18 @@
 #include "commands/kpCommandHistory.h"
 #include "dialogs/imagelib/kpDocumentMetaInfoDialog.h"
 #include "document/kpDocument.h"
+#include "document/kpDocumentJournal.h"
 #include "kpDefs.h"
 #include "kpLogCategories.h"
-#include "pixmapfx/kpPixmapFX.h"
+#include "lgpl/generic/kpUrlFormatter.h"
 #include "views/kpView.h"
 #include "views/manager/kpViewManager.h"
 #include "widgets/kpDocumentSaveOptionsWidget.h"
 #include "widgets/kpPrintDialogPage.h"
 
+#include <cstring>
+#include <vector>
+
 #if HAVE_KSANE
 #include "../scan/sanedialog.h"
 #endif // HAVE_KSANE
@@ -335,6 +340,53 @@ void kpMainWindow::setDocumentChoosingWindow(kpDocument *doc)
 
 //---------------------------------------------------------------------
 
+// public
+void kpMainWindow::recoverCrashedDocuments()
+{
+    const QStringList paths = kpDocumentJournal::OrphanedJournals();
+    for (const QString &path : paths) {
+        const int result = KMessageBox::questionTwoActionsCancel(this,
+                                                                 i18n("KolourPaint did not exit normally while the image \"%1\" was open.\n"
+                                                                      "Do you want to recover the changes made to it?",
+                                                                      kpDocumentJournal::Description(path)),
+                                                                 i18nc("@title:window", "Recover Image"),
+                                                                 KGuiItem(i18nc("@action:button", "Recover"), QStringLiteral("document-revert")),
+                                                                 KStandardGuiItem::discard());
+
+        switch (result) {
+        case KMessageBox::ButtonCode::PrimaryAction: {
+            kpDocument *doc = kpDocumentJournal::Recover(path, documentEnvironment(), this);
+            if (!doc) {
+                KMessageBox::error(this, i18n("Could not recover the image."), i18nc("@title:window", "Recovery Failed"));
+                // (keep the journal, in case it can be recovered later)
+                break;
+            }
+
+            // Never replace a document that was just recovered, even in
+            // OpenImagesInSameWindow mode.
+            if (d->document && !d->document->isEmpty()) {
+                auto *win = new kpMainWindow(doc);
+                win->show();
+            } else {
+                setDocument(doc);
+            }
+
+            // (the recovered document now has a journal of its own)
+            kpDocumentJournal::Remove(path);
+            break;
+        }
+        case KMessageBox::ButtonCode::SecondaryAction:
+            kpDocumentJournal::Remove(path);
+            break;
+        default:
+            // Ask again next time.
+            break;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
 // private
 kpDocument *kpMainWindow::openInternal(const QUrl &url, const QSize &fallbackDocSize, bool newDocSameNameIfNotExist)
 {
@@ -667,17 +719,27 @@ void kpMainWindow::slotProperties()
 //---------------------------------------------------------------------
 
 // private slot
-bool kpMainWindow::save(bool localOnly)
+bool kpMainWindow::save(bool localOnly, bool inBackground)
 {
+    // The URL and save options are only updated once it has finished.
+    d->document->waitForBackgroundSave();
+
     if (d->document->url().isEmpty() || !QImageWriter::supportedMimeTypes().contains(d->document->saveOptions()->mimeType().toLatin1()) ||
         // SYNC: kpDocument::getPixmapFromFile() can't determine quality
         //       from file so it has been set initially to an invalid value.
         (d->document->saveOptions()->mimeTypeHasConfigurableQuality() && d->document->saveOptions()->qualityIsInvalid())
         || (localOnly && !d->document->url().isLocalFile())) {
-        return saveAs(localOnly);
+        return saveAs(localOnly, inBackground);
+    }
+
+    const bool lossyPrompt = !d->document->savedAtLeastOnceBefore();
+
+    if (inBackground) {
+        // (slotBackgroundSaveFinished() will call addRecentURL())
+        return d->document->saveInBackground(lossyPrompt);
     }
 
-    if (d->document->save(!d->document->savedAtLeastOnceBefore() /*lossy prompt*/)) {
+    if (d->document->save(lossyPrompt)) {
         addRecentURL(d->document->url());
         return true;
     }
@@ -692,7 +754,64 @@ bool kpMainWindow::slotSave()
 {
     toolEndShape();
 
-    return save();
+    return save(false /*allow remote files*/, true /*in background*/);
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpMainWindow::slotBackgroundSaveStarted(const QUrl &url)
+{
+#if DEBUG_KP_MAIN_WINDOW
+    qCDebug(kpLogMainWindow) << "kpMainWindow::slotBackgroundSaveStarted(" << url << ")";
+#endif
+
+    if (!d->statusBarCreated) {
+        return;
+    }
+
+    d->statusBarSaveProgress->setFormat(i18n("Saving \"%1\"...", kpUrlFormatter::PrettyFilename(url)));
+    d->statusBarSaveProgress->setValue(0);
+    d->statusBarSaveProgress->show();
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpMainWindow::slotBackgroundSaveProgress(int percent)
+{
+    if (!d->statusBarCreated) {
+        return;
+    }
+
+    d->statusBarSaveProgress->setValue(percent);
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpMainWindow::slotBackgroundSaveFinished(const QUrl &url, bool success)
+{
+#if DEBUG_KP_MAIN_WINDOW
+    qCDebug(kpLogMainWindow) << "kpMainWindow::slotBackgroundSaveFinished(" << url << "," << success << ")";
+#endif
+
+    if (d->statusBarCreated) {
+        d->statusBarSaveProgress->hide();
+    }
+
+    if (!success) {
+        return;
+    }
+
+    addRecentURL(url);
+
+    // Needed even if the document was changed during the save and so
+    // kpDocument::documentSaved() was not emitted, since the URL may
+    // have changed.
+    slotUpdateCaption();
+    slotEnableReload();
+    slotEnableSettingsShowPath();
 }
 
 //---------------------------------------------------------------------
@@ -860,13 +979,16 @@ QUrl kpMainWindow::askForSaveURL(const QString &caption,
 //---------------------------------------------------------------------
 
 // private slot
-bool kpMainWindow::saveAs(bool localOnly)
+bool kpMainWindow::saveAs(bool localOnly, bool inBackground)
 {
+    // Don't offer the URL and save options of a save that might yet fail.
+    d->document->waitForBackgroundSave();
+
     kpDocumentSaveOptions chosenSaveOptions;
     bool allowLossyPrompt;
     QUrl chosenURL = askForSaveURL(i18nc("@title:window", "Save Image As"),
                                    d->document->url().url(),
-                                   d->document->imageWithSelection(),
+                                   d->document->flattenedImage(),
                                    *d->document->saveOptions(),
                                    *d->document->metaInfo(),
                                    QLatin1String(kpSettingsGroupFileSaveAs),
@@ -879,6 +1001,11 @@ bool kpMainWindow::saveAs(bool localOnly)
         return false;
     }
 
+    if (inBackground) {
+        // (slotBackgroundSaveFinished() will call addRecentURL())
+        return d->document->saveAsInBackground(chosenURL, chosenSaveOptions, allowLossyPrompt);
+    }
+
     if (!d->document->saveAs(chosenURL, chosenSaveOptions, allowLossyPrompt)) {
         return false;
     }
@@ -895,7 +1022,7 @@ bool kpMainWindow::slotSaveAs()
 {
     toolEndShape();
 
-    return saveAs();
+    return saveAs(false /*allow remote files*/, true /*in background*/);
 }
 
 //---------------------------------------------------------------------
@@ -909,7 +1036,7 @@ bool kpMainWindow::slotExport()
     bool allowLossyPrompt;
     QUrl chosenURL = askForSaveURL(i18nc("@title:window", "Export"),
                                    d->lastExportURL.url(),
-                                   d->document->imageWithSelection(),
+                                   d->document->flattenedImage(),
                                    d->lastExportSaveOptions,
                                    *d->document->metaInfo(),
                                    QLatin1String(kpSettingsGroupFileExport),
@@ -922,7 +1049,7 @@ bool kpMainWindow::slotExport()
         return false;
     }
 
-    if (!kpDocument::savePixmapToFile(d->document->imageWithSelection(), chosenURL, chosenSaveOptions, *d->document->metaInfo(), allowLossyPrompt, this)) {
+    if (!kpDocument::savePixmapToFile(d->document->flattenedImage(), chosenURL, chosenSaveOptions, *d->document->metaInfo(), allowLossyPrompt, this)) {
         return false;
     }
 
@@ -1052,15 +1179,18 @@ void kpMainWindow::sendPreviewToPrinter(QPrinter *printer)
 // private
 void kpMainWindow::sendImageToPrinter(QPrinter *printer, bool showPrinterSetupDialog)
 {
-    // Get image to be printed.
-    kpImage image = d->document->imageWithSelection();
+    // Don't get the image to be printed yet - that is done a band at a time
+    // by sendImageBandsToPrinter(), so that huge images don't need huge
+    // amounts of memory.
+    const int imageWidth = d->document->width();
+    const int imageHeight = d->document->height();
 
     // Get image DPI.
     auto imageDotsPerMeterX = double(d->document->metaInfo()->dotsPerMeterX());
     auto imageDotsPerMeterY = double(d->document->metaInfo()->dotsPerMeterY());
 #if DEBUG_KP_MAIN_WINDOW
     qCDebug(kpLogMainWindow) << "kpMainWindow::sendImageToPrinter() image:"
-                             << " width=" << image.width() << " height=" << image.height() << " dotsPerMeterX=" << imageDotsPerMeterX
+                             << " width=" << imageWidth << " height=" << imageHeight << " dotsPerMeterX=" << imageDotsPerMeterX
                              << " dotsPerMeterY=" << imageDotsPerMeterY;
 #endif
 
@@ -1123,8 +1253,8 @@ void kpMainWindow::sendImageToPrinter(QPrinter *printer, bool showPrinterSetupDi
     // If image doesn't fit on page at intended DPI, change the DPI.
     //
 
-    const auto scaleDpiX = (image.width() / (printerWidthMM / KP_MILLIMETERS_PER_INCH)) / dpiX;
-    const auto scaleDpiY = (image.height() / (printerHeightMM / KP_MILLIMETERS_PER_INCH)) / dpiY;
+    const auto scaleDpiX = (imageWidth / (printerWidthMM / KP_MILLIMETERS_PER_INCH)) / dpiX;
+    const auto scaleDpiY = (imageHeight / (printerHeightMM / KP_MILLIMETERS_PER_INCH)) / dpiY;
     const auto scaleDpi = qMax(scaleDpiX, scaleDpiY);
 
 #if DEBUG_KP_MAIN_WINDOW
@@ -1146,18 +1276,19 @@ void kpMainWindow::sendImageToPrinter(QPrinter *printer, bool showPrinterSetupDi
     // image, to avoid losing information.  Don't antialias as the printer
     // will do that to translate our DPI to its physical resolution and
     // double-antialiasing looks bad.
+    int printedWidth = imageWidth, printedHeight = imageHeight;
     if (dpiX > dpiY) {
 #if DEBUG_KP_MAIN_WINDOW
         qCDebug(kpLogMainWindow) << "\tdpiX > dpiY; stretching image height to equalise DPIs to dpiX=" << dpiX;
 #endif
-        kpPixmapFX::scale(&image, image.width(), qMax(1, qRound(image.height() * dpiX / dpiY)), false /*don't antialias*/);
+        printedHeight = qMax(1, qRound(imageHeight * dpiX / dpiY));
 
         dpiY = dpiX;
     } else if (dpiY > dpiX) {
 #if DEBUG_KP_MAIN_WINDOW
         qCDebug(kpLogMainWindow) << "\tdpiY > dpiX; stretching image width to equalise DPIs to dpiY=" << dpiY;
 #endif
-        kpPixmapFX::scale(&image, qMax(1, qRound(image.width() * dpiY / dpiX)), image.height(), false /*don't antialias*/);
+        printedWidth = qMax(1, qRound(imageWidth * dpiY / dpiX));
 
         dpiX = dpiY;
     }
@@ -1202,16 +1333,111 @@ void kpMainWindow::sendImageToPrinter(QPrinter *printer, bool showPrinterSetupDi
 
     // Center image on page?
     if (d->configPrintImageCenteredOnPage) {
-        originX = (printer->width() - image.width()) / 2;
-        originY = (printer->height() - image.height()) / 2;
+        originX = (printer->width() - printedWidth) / 2;
+        originY = (printer->height() - printedHeight) / 2;
     }
 
-    painter.drawImage(qRound(originX), qRound(originY), image);
+    sendImageBandsToPrinter(&painter, QPoint(qRound(originX), qRound(originY)), QSize(printedWidth, printedHeight));
     painter.end();
 }
 
 //---------------------------------------------------------------------
 
+// Upper limit on the size of each band of the image given to the printer
+// by sendImageBandsToPrinter().
+static const qint64 PrintBandMaxBytes = 16 * 1024 * 1024;
+
+// private
+void kpMainWindow::sendImageBandsToPrinter(QPainter *painter, const QPoint &origin, const QSize &printedSize)
+{
+    const int imageWidth = d->document->width();
+    const int imageHeight = d->document->height();
+
+    const int printedWidth = printedSize.width();
+    const int printedHeight = printedSize.height();
+
+    // (sendImageToPrinter() only ever stretches)
+    Q_ASSERT(printedWidth >= imageWidth && printedHeight >= imageHeight);
+    const bool stretch = (printedWidth != imageWidth || printedHeight != imageHeight);
+
+    // Each band is no taller than what fits in <PrintBandMaxBytes>, both
+    // before and after stretching.  Since we only ever stretch, the image
+    // rows of a band never outnumber its printed rows.
+    const qint64 printedBytesPerLine = qint64(printedWidth) * 4;
+    const int bandHeight = int(qBound(qint64(1), PrintBandMaxBytes / printedBytesPerLine, qint64(printedHeight)));
+
+#if DEBUG_KP_MAIN_WINDOW
+    qCDebug(kpLogMainWindow) << "kpMainWindow::sendImageBandsToPrinter() origin=" << origin << " printedSize=" << printedSize << " stretch=" << stretch
+                             << " bandHeight=" << bandHeight;
+#endif
+
+    // Image column of each printed column.  Like kpPixmapFX::scale() with
+    // antialiasing off, this is a nearest-neighbour stretch.
+    std::vector<int> imageXForPrintedX;
+    if (stretch) {
+        imageXForPrintedX.resize(printedWidth);
+        for (int x = 0; x < printedWidth; x++) {
+            imageXForPrintedX[x] = int(qint64(x) * imageWidth / printedWidth);
+        }
+    }
+
+    const auto imageYForPrintedY = [&](int printedY) {
+        return int(qint64(printedY) * imageHeight / printedHeight);
+    };
+
+    // Adjustments (e.g. a blur) cannot be applied to each band on its own,
+    // so if there are any, flatten the whole image once instead.
+    const kpImage flattenedImage = d->document->adjustments().isEmpty() ? kpImage() : d->document->flattenedImage();
+
+    for (int printedY = 0; printedY < printedHeight; printedY += bandHeight) {
+        const int printedBandHeight = qMin(bandHeight, printedHeight - printedY);
+
+        const int imageY = imageYForPrintedY(printedY);
+        const int imageBandHeight = imageYForPrintedY(printedY + printedBandHeight - 1) + 1 - imageY;
+
+        const QRect imageBandRect(0, imageY, imageWidth, imageBandHeight);
+        kpImage imageBand = flattenedImage.isNull() ? d->document->imageWithSelectionAt(imageBandRect) : flattenedImage.copy(imageBandRect);
+
+        if (!stretch) {
+            painter->drawImage(origin.x(), origin.y() + printedY, imageBand);
+            continue;
+        }
+
+        if (imageBand.depth() != 32) {
+            imageBand.convertTo(QImage::Format_ARGB32_Premultiplied);
+        }
+
+        QImage printedBand(printedWidth, printedBandHeight, imageBand.format());
+        if (printedBand.isNull()) {
+            // (out of memory - nothing sensible to print)
+            return;
+        }
+
+        const QRgb *lastImageLine = nullptr;
+        const QRgb *lastPrintedLine = nullptr;
+        for (int y = 0; y < printedBandHeight; y++) {
+            const auto *imageLine = reinterpret_cast<const QRgb *>(imageBand.constScanLine(imageYForPrintedY(printedY + y) - imageY));
+            auto *printedLine = reinterpret_cast<QRgb *>(printedBand.scanLine(y));
+
+            // Rows stretched from the same image row are identical.
+            if (imageLine == lastImageLine) {
+                std::memcpy(printedLine, lastPrintedLine, size_t(printedWidth) * sizeof(QRgb));
+            } else {
+                for (int x = 0; x < printedWidth; x++) {
+                    printedLine[x] = imageLine[imageXForPrintedX[x]];
+                }
+            }
+
+            lastImageLine = imageLine;
+            lastPrintedLine = printedLine;
+        }
+
+        painter->drawImage(origin.x(), origin.y() + printedY, printedBand);
+    }
+}
+
+//---------------------------------------------------------------------
+
 // private slot
 void kpMainWindow::slotPrint()
 {
@@ -1278,6 +1504,11 @@ bool kpMainWindow::queryCloseDocument()
 {
     toolEndShape();
 
+    if (d->document) {
+        // The document stays modified until the save has finished.
+        d->document->waitForBackgroundSave();
+    }
+
     if (!d->document || !d->document->isModified()) {
         return true; // ok to close current doc
     }
@@ -1292,7 +1523,7 @@ bool kpMainWindow::queryCloseDocument()
 
     switch (result) {
     case KMessageBox::ButtonCode::PrimaryAction:
-        return slotSave(); // close only if save succeeds
+        return save(); // close only if save succeeds
     case KMessageBox::ButtonCode::SecondaryAction:
         return true; // close without saving
     default:
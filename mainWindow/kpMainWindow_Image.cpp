@@ -13,6 +13,7 @@
 #include "commands/imagelib/effects/kpEffectGrayscaleCommand.h"
 #include "commands/imagelib/effects/kpEffectInvertCommand.h"
 #include "commands/imagelib/effects/kpEffectReduceColorsCommand.h"
+#include "commands/imagelib/kpAdjustmentsCommand.h"
 #include "commands/imagelib/transforms/kpTransformFlipCommand.h"
 #include "commands/imagelib/transforms/kpTransformResizeScaleCommand.h"
 #include "commands/imagelib/transforms/kpTransformRotateCommand.h"
@@ -23,6 +24,7 @@
 #include "commands/tools/selection/kpToolSelectionPullFromDocumentCommand.h"
 #include "commands/tools/selection/text/kpToolTextGiveContentCommand.h"
 #include "dialogs/imagelib/effects/kpEffectsDialog.h"
+#include "dialogs/imagelib/kpAdjustmentsDialog.h"
 #include "dialogs/imagelib/transforms/kpTransformResizeScaleDialog.h"
 #include "dialogs/imagelib/transforms/kpTransformRotateDialog.h"
 #include "dialogs/imagelib/transforms/kpTransformSkewDialog.h"
@@ -166,6 +168,10 @@ void kpMainWindow::setupImageMenuActions()
     connect(d->actionMoreEffects, &QAction::triggered, this, &kpMainWindow::slotMoreEffects);
     ac->setDefaultShortcut(d->actionMoreEffects, Qt::CTRL | Qt::Key_M);
 
+    d->actionAdjustments = ac->addAction(QStringLiteral("image_adjustments"));
+    d->actionAdjustments->setText(i18n("&Adjustments..."));
+    connect(d->actionAdjustments, &QAction::triggered, this, &kpMainWindow::slotAdjustments);
+
     enableImageMenuDocumentActions(false);
 }
 
@@ -189,6 +195,7 @@ void kpMainWindow::enableImageMenuDocumentActions(bool enable)
     d->actionClear->setEnabled(enable);
     d->actionBlur->setEnabled(enable);
     d->actionMoreEffects->setEnabled(enable);
+    d->actionAdjustments->setEnabled(enable);
 
     d->imageMenuDocumentActionsEnabled = enable;
 }
@@ -510,3 +517,20 @@ void kpMainWindow::slotMoreEffects()
 }
 
 //--------------------------------------------------------------------------------
+
+// private slot
+void kpMainWindow::slotAdjustments()
+{
+    toolEndShape();
+
+    // (the dialog previews its changes in the document as they are made,
+    //  without marking it as modified - executing the command does)
+    kpAdjustmentsDialog dialog(transformDialogEnvironment(), this);
+
+    if (dialog.exec() && !dialog.isNoOp()) {
+        d->commandHistory->addCommand(
+            new kpAdjustmentsCommand(i18n("Adjustments"), dialog.adjustments(), dialog.originalAdjustments(), commandEnvironment()));
+    }
+}
+
+//--------------------------------------------------------------------------------
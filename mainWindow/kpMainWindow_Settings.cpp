@@ -9,9 +9,12 @@
 #include "kpMainWindowPrivate.h"
 #include "mainWindow/kpMainWindow.h"
 
+#include <QFileDialog>
+
 #include <KActionCollection>
 #include <KConfigGroup>
 #include <KLocalizedString>
+#include <KMessageBox>
 #include <KSharedConfig>
 #include <KShortcutsDialog>
 #include <KStandardAction>
@@ -19,7 +22,10 @@
 
 #include "document/kpDocument.h"
 #include "environments/tools/kpToolEnvironment.h"
+#include "generic/kpProfiler.h"
 #include "kpDefs.h"
+#include "kpViewScrollableContainer.h"
+#include "widgets/kpProfilerOverlay.h"
 #include "widgets/toolbars/kpToolToolBar.h"
 
 //---------------------------------------------------------------------
@@ -47,6 +53,14 @@ void kpMainWindow::setupSettingsMenuActions()
     action->setChecked(kpToolEnvironment::drawAntiAliased);
     connect(action, &KToggleAction::triggered, this, &kpMainWindow::slotDrawAntiAliasedToggled);
 
+    d->actionShowPerformanceOverlay = ac->add<KToggleAction>(QStringLiteral("settings_show_performance_overlay"));
+    d->actionShowPerformanceOverlay->setText(i18n("Show Performance &Overlay"));
+    connect(d->actionShowPerformanceOverlay, &KToggleAction::triggered, this, &kpMainWindow::slotShowPerformanceOverlayToggled);
+
+    d->actionExportPerformanceTrace = ac->addAction(QStringLiteral("settings_export_performance_trace"));
+    d->actionExportPerformanceTrace->setText(i18n("Export Performance &Trace..."));
+    connect(d->actionExportPerformanceTrace, &QAction::triggered, this, &kpMainWindow::slotExportPerformanceTrace);
+
     d->actionKeyBindings = KStandardAction::keyBindings(this, SLOT(slotKeyBindings()), ac);
 
     KStandardAction::configureToolbars(this, SLOT(configureToolbars()), actionCollection());
@@ -117,6 +131,66 @@ void kpMainWindow::slotDrawAntiAliasedToggled(bool on)
 
 //---------------------------------------------------------------------
 
+// private slot
+void kpMainWindow::slotShowPerformanceOverlayToggled(bool on)
+{
+#if DEBUG_KP_MAIN_WINDOW
+    qCDebug(kpLogMainWindow) << "kpMainWindow::slotShowPerformanceOverlayToggled(" << on << ")";
+#endif
+
+    if (on) {
+        kpProfiler::setEnabled(true);
+
+        if (!d->profilerOverlay) {
+            Q_ASSERT(d->scrollView);
+            d->profilerOverlay = new kpProfilerOverlay(d->scrollView);
+        }
+        d->profilerOverlay->show();
+    } else {
+        if (d->profilerOverlay) {
+            d->profilerOverlay->hide();
+        }
+
+        // Keep recording if the user asked for it with the KOLOURPAINT_PROFILE
+        // environment variable.
+        kpProfiler::setEnabled(false);
+        kpProfiler::initFromEnvironment();
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpMainWindow::slotExportPerformanceTrace()
+{
+    toolEndShape();
+
+    if (kpProfiler::events().isEmpty()) {
+        KMessageBox::information(this,
+                                 i18n("No performance data has been recorded.\n\n"
+                                      "Enable Settings / Show Performance Overlay, or start KolourPaint "
+                                      "with the environment variable KOLOURPAINT_PROFILE=1, "
+                                      "then repeat the slow operation."),
+                                 i18nc("@title:window", "Export Performance Trace"));
+        return;
+    }
+
+    const QString fileName = QFileDialog::getSaveFileName(this,
+                                                          i18nc("@title:window", "Export Performance Trace"),
+                                                          QStringLiteral("kolourpaint-trace.json"),
+                                                          i18n("Chrome Trace (*.json)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QString errorMessage;
+    if (!kpProfiler::exportChromeTrace(fileName, &errorMessage)) {
+        KMessageBox::error(this, errorMessage);
+    }
+}
+
+//---------------------------------------------------------------------
+
 // private slot
 void kpMainWindow::slotKeyBindings()
 {
@@ -11,6 +11,7 @@
 #include "mainWindow/kpMainWindow.h"
 
 #include <QLabel>
+#include <QProgressBar>
 #include <QStatusBar>
 #include <QString>
 
@@ -73,6 +74,14 @@ void kpMainWindow::createStatusBar()
 
     addPermanentStatusBarItem(StatusBarItemZoom, 5 /*1600%*/);
 
+    d->statusBarSaveProgress = new QProgressBar(sb);
+    d->statusBarSaveProgress->setRange(0, 100);
+    d->statusBarSaveProgress->setTextVisible(true);
+    d->statusBarSaveProgress->setFixedHeight(d->statusBarMessageLabel->height());
+    d->statusBarSaveProgress->setMaximumWidth(d->statusBarSaveProgress->fontMetrics().horizontalAdvance(QLatin1Char('8')) * 30);
+    d->statusBarSaveProgress->hide();
+    sb->addPermanentWidget(d->statusBarSaveProgress);
+
     d->statusBarShapeLastPointsInitialised = false;
     d->statusBarShapeLastSizeInitialised = false;
     d->statusBarCreated = true;
@@ -43,6 +43,7 @@ class kpPixmapFX
 public:
     //
     // Returns the pixel and mask data found at the <rect> in <pm>.
+    // If <rect> is all of <pm>, this shares <pm>'s data (copy-on-write).
     //
     static QImage getPixmapAt(const QImage &pm, const QRect &rect);
 
@@ -98,6 +99,21 @@ public:
     static void scale(QImage *destPtr, int w, int h, bool pretty = false);
     static QImage scale(const QImage &pm, int w, int h, bool pretty = false);
 
+    //
+    // Scales an image up by the whole-number factors <hzoom> and <vzoom>
+    // (both >= 1) by expanding each pixel into an <hzoom> x <vzoom> block.
+    // This is exactly what scale() does for such factors, but is much
+    // faster since it only copies pixels and whole rows.
+    //
+    // If <gridColor> is valid, the top row and left column of every block
+    // are set to it (opaque), so that a pixel grid is drawn in the same
+    // pass.  Grid lines are only drawn in a direction whose factor is > 1.
+    //
+    // The result is 32-bit, in the format of <image> if it is already
+    // 32-bit and QImage::Format_ARGB32_Premultiplied otherwise.
+    //
+    static QImage scaleIntegerNearest(const QImage &image, int hzoom, int vzoom, const QColor &gridColor = QColor());
+
     // The minimum difference between 2 angles (in degrees) such that they are
     // considered different.  This gives you at least enough precision to
     // rotate an image whose width <= 10000 such that its height increases
@@ -114,6 +130,8 @@ public:
     // <backgroundColor>    color to fill new areas with
     // <targetWidth>        if > 0, the desired width of the resultant pixmap
     // <targetHeight>       if > 0, the desired height of the resultant pixmap
+    // <pretty>             if true, interpolate between source pixels
+    //                      instead of picking the nearest
     //
     // Using <targetWidth> & <targetHeight> to generate preview pixmaps is
     // significantly more efficient than skewing and then scaling yourself.
@@ -121,8 +139,20 @@ public:
     static QTransform skewMatrix(int width, int height, double hangle, double vangle);
     static QTransform skewMatrix(const QImage &pixmap, double hangle, double vangle);
 
-    static void skew(QImage *destPixmapPtr, double hangle, double vangle, const kpColor &backgroundColor, int targetWidth = -1, int targetHeight = -1);
-    static QImage skew(const QImage &pm, double hangle, double vangle, const kpColor &backgroundColor, int targetWidth = -1, int targetHeight = -1);
+    static void skew(QImage *destPixmapPtr,
+                     double hangle,
+                     double vangle,
+                     const kpColor &backgroundColor,
+                     int targetWidth = -1,
+                     int targetHeight = -1,
+                     bool pretty = false);
+    static QImage skew(const QImage &pm,
+                       double hangle,
+                       double vangle,
+                       const kpColor &backgroundColor,
+                       int targetWidth = -1,
+                       int targetHeight = -1,
+                       bool pretty = false);
 
     //
     // Rotates an image.
@@ -131,6 +161,9 @@ public:
     // <backgroundColor>    color to fill new areas with
     // <targetWidth>        if > 0, the desired width of the resultant pixmap
     // <targetHeight>       if > 0, the desired height of the resultant pixmap
+    // <pretty>             if true, interpolate between source pixels
+    //                      instead of picking the nearest (not for
+    //                      multiples of 90 degrees, which are exact)
     //
     // Using <targetWidth> & <targetHeight> to generate preview pixmaps is
     // significantly more efficient than rotating and then scaling yourself.
@@ -140,8 +173,25 @@ public:
 
     static bool isLosslessRotation(double angle);
 
-    static void rotate(QImage *destPixmapPtr, double angle, const kpColor &backgroundColor, int targetWidth = -1, int targetHeight = -1);
-    static QImage rotate(const QImage &pm, double angle, const kpColor &backgroundColor, int targetWidth = -1, int targetHeight = -1);
+    static void rotate(QImage *destPixmapPtr, double angle, const kpColor &backgroundColor, int targetWidth = -1, int targetHeight = -1, bool pretty = false);
+    static QImage rotate(const QImage &pm, double angle, const kpColor &backgroundColor, int targetWidth = -1, int targetHeight = -1, bool pretty = false);
+
+    //
+    // Rotates an image clockwise by <quarterTurns> * 90 degrees, exactly.
+    // <quarterTurns> may be negative or >= 4.
+    //
+    // rotate() calls this for lossless angles.
+    //
+    static QImage rotateQuarterTurns(const QImage &image, int quarterTurns);
+
+    //
+    // Flips an image horizontally and/or vertically.
+    //
+    // The pointer version works in place and does not allocate a new image,
+    // unless <*destPtr> shares its data with another QImage.
+    //
+    static void flip(QImage *destPtr, bool horiz, bool vert);
+    static QImage flip(const QImage &image, bool horiz, bool vert);
 
     //
     // Drawing Shapes
@@ -16,6 +16,7 @@
 
 #include "kpLogCategories.h"
 
+#include "generic/kpProfiler.h"
 #include "imagelib/kpColor.h"
 
 //---------------------------------------------------------------------
@@ -23,6 +24,14 @@
 // public static
 QImage kpPixmapFX::getPixmapAt(const QImage &image, const QRect &rect)
 {
+    // Share the data of the whole image instead of copying it.  The
+    // pixels will only be copied if and when either of them is modified.
+    if (rect == image.rect()) {
+        return image;
+    }
+
+    kpProfiler::addCopy();
+
     return image.copy(rect);
 }
 
@@ -18,10 +18,15 @@
 
 #include "kpLogCategories.h"
 
+#include "generic/kpParallel.h"
 #include "imagelib/kpColor.h"
+#include "imagelib/kpResampler.h"
 #include "kpDefs.h"
 #include "layers/selections/kpAbstractSelection.h"
 
+#include <algorithm>
+#include <cstring>
+
 //---------------------------------------------------------------------
 
 // public static
@@ -94,7 +99,94 @@ QImage kpPixmapFX::scale(const QImage &image, int w, int h, bool pretty)
         return image;
     }
 
-    return image.scaled(w, h, Qt::IgnoreAspectRatio, pretty ? Qt::SmoothTransformation : Qt::FastTransformation);
+    if (!pretty) {
+        return image.scaled(w, h, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    }
+
+    // Lanczos3 keeps the most detail when shrinking but rings around hard
+    // edges when enlarging, where Bicubic looks better.
+    const bool enlarging = (w > image.width() || h > image.height());
+    return kpResampler::scale(image, w, h, enlarging ? kpResampler::Bicubic : kpResampler::Lanczos3);
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QImage kpPixmapFX::scaleIntegerNearest(const QImage &image, int hzoom, int vzoom, const QColor &gridColor)
+{
+#if DEBUG_KP_PIXMAP_FX && 0
+    qCDebug(kpLogPixmapfx) << "kpPixmapFX::scaleIntegerNearest(rect=" << image.rect() << ",hzoom=" << hzoom << ",vzoom=" << vzoom
+                           << ",gridColor=" << gridColor << ")";
+#endif
+
+    Q_ASSERT(hzoom >= 1 && vzoom >= 1);
+
+    if (image.isNull()) {
+        return image;
+    }
+
+    QImage src = image;
+    if (src.depth() != 32) {
+        src = src.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    const int srcWidth = src.width();
+    const int srcHeight = src.height();
+
+    QImage dest(srcWidth * hzoom, srcHeight * vzoom, src.format());
+    if (dest.isNull()) {
+        return {};
+    }
+
+    // A grid line in a direction the image is not scaled in would hide
+    // every pixel.
+    const bool drawVertGridLines = gridColor.isValid() && hzoom > 1;
+    const bool drawHorizGridLines = gridColor.isValid() && vzoom > 1;
+    // Opaque, so this is the same in all 32-bit formats.
+    const QRgb gridPixel = gridColor.rgb();
+
+    // Fetch these outside the worker lambda: QImage::bits() and friends
+    // may detach and are not safe to call concurrently.
+    const uchar *const srcBits = src.constBits();
+    const qsizetype srcBytesPerLine = src.bytesPerLine();
+    uchar *const destBits = dest.bits();
+    const qsizetype destBytesPerLine = dest.bytesPerLine();
+    const size_t destRowBytes = size_t(dest.width()) * sizeof(QRgb);
+
+    // Aim for roughly 64K destination pixels per chunk.
+    const int grainSize = std::max(1, 65536 / std::max(1, dest.width() * vzoom));
+
+    ::kpParallelFor(srcHeight, grainSize, [&](int beginRow, int endRow) {
+        for (int y = beginRow; y < endRow; y++) {
+            const auto *srcLine = reinterpret_cast<const QRgb *>(srcBits + y * srcBytesPerLine);
+            uchar *const blockTop = destBits + qsizetype(y) * vzoom * destBytesPerLine;
+
+            // Expand the source row horizontally into the last row of the
+            // block, which is never a grid row.
+            uchar *const expandedRow = blockTop + (vzoom - 1) * destBytesPerLine;
+            auto *destPixel = reinterpret_cast<QRgb *>(expandedRow);
+            for (int x = 0; x < srcWidth; x++) {
+                std::fill_n(destPixel, hzoom, srcLine[x]);
+                if (drawVertGridLines) {
+                    destPixel[0] = gridPixel;
+                }
+                destPixel += hzoom;
+            }
+
+            // Replicate it into the remaining rows of the block with
+            // whole-row copies, which the C library vectorizes.
+            for (int r = 0; r < vzoom - 1; r++) {
+                uchar *const row = blockTop + r * destBytesPerLine;
+                if (drawHorizGridLines && r == 0) {
+                    std::fill_n(reinterpret_cast<QRgb *>(row), dest.width(), gridPixel);
+                } else {
+                    std::memcpy(row, expandedRow, destRowBytes);
+                }
+            }
+        }
+    });
+
+    return dest;
 }
 
 //---------------------------------------------------------------------
@@ -219,6 +311,141 @@ static QTransform TrueMatrix(const QTransform &matrix, int srcPixmapWidth, int s
 
 //---------------------------------------------------------------------
 
+// Rows per kpParallelFor() chunk in AffineTransform32().
+static const int AffineRowGrainSize = 16;
+
+// Narrows [*begin, *end) to the destination pixels x for which the source
+// coordinate <start> + <step> * x might lie in [0, <size>).  It errs on the
+// side of including a pixel too many, since the caller checks each pixel
+// anyway: this only has to skip the pixels that are clearly outside.
+static void ClipSpan(double start, double step, int size, int *begin, int *end)
+{
+    if (std::fabs(step) < 1e-12) {
+        if (start < 0 || start >= size) {
+            *end = *begin;
+        }
+        return;
+    }
+
+    double lo = -start / step;
+    double hi = (size - start) / step;
+    if (step < 0) {
+        std::swap(lo, hi);
+    }
+
+    const int newBegin = int(qBound(double(*begin), std::floor(lo) - 1, double(*end)));
+    const int newEnd = int(qBound(double(newBegin), std::ceil(hi) + 1, double(*end)));
+
+    *begin = newBegin;
+    *end = newEnd;
+}
+
+//---------------------------------------------------------------------
+
+// Returns <a> * (256 - <t>) / 256 + <b> * <t> / 256 per channel, for
+// 0 <= <t> <= 256.
+static inline QRgb LerpPixel(QRgb a, QRgb b, int t)
+{
+    // (2 channels at a time, with 8 bits between them to carry into)
+    const quint32 rb = (((a & 0xff00ff) * (256 - t) + (b & 0xff00ff) * t) >> 8) & 0xff00ff;
+    const quint32 ag = (((a >> 8) & 0xff00ff) * (256 - t) + ((b >> 8) & 0xff00ff) * t) & 0xff00ff00;
+    return rb | ag;
+}
+
+//---------------------------------------------------------------------
+
+// Returns the 32-bit <src> bilinearly interpolated at (<sx>, <sy>), which
+// must be inside it.
+static inline QRgb BilinearPixel(const uchar *srcBits, qsizetype srcBytesPerLine, int srcWidth, int srcHeight, double sx, double sy)
+{
+    // (between the centers of the 4 nearest pixels)
+    const double u = sx - 0.5;
+    const double v = sy - 0.5;
+    const int fx = int(std::floor(u));
+    const int fy = int(std::floor(v));
+
+    const int x0 = qMax(0, fx);
+    const int x1 = qMin(srcWidth - 1, fx + 1);
+    const int y0 = qMax(0, fy);
+    const int y1 = qMin(srcHeight - 1, fy + 1);
+
+    const auto *row0 = reinterpret_cast<const QRgb *>(srcBits + y0 * srcBytesPerLine);
+    const auto *row1 = reinterpret_cast<const QRgb *>(srcBits + y1 * srcBytesPerLine);
+
+    const int tx = int((u - fx) * 256);
+    const int ty = int((v - fy) * 256);
+
+    return ::LerpPixel(::LerpPixel(row0[x0], row0[x1], tx), ::LerpPixel(row1[x0], row1[x1], tx), ty);
+}
+
+//---------------------------------------------------------------------
+
+// Sets every pixel of <dest> to the pixel of the 32-bit <src> that <matrix>
+// maps onto its center, or to <background> if none does.  <dest> must be
+// QImage::Format_ARGB32_Premultiplied and <background> premultiplied.
+//
+// The source coordinates are stepped along each destination row, rather
+// than mapped for every pixel, and the span of the row that can map inside
+// <src> is worked out first so that the rest of the row (and rows wholly
+// outside) are just filled.  Rows are processed in parallel.
+//
+// If <smooth>, the 4 nearest source pixels are interpolated, instead of
+// taking the one the center falls in.
+static void AffineTransform32(const QImage &src, QImage *dest, const QTransform &matrix, QRgb background, bool smooth)
+{
+    bool invertible = false;
+    const QTransform inverse = matrix.inverted(&invertible);
+    if (!invertible) {
+        dest->fill(background);
+        return;
+    }
+
+    const int srcWidth = src.width();
+    const int srcHeight = src.height();
+    const int destWidth = dest->width();
+
+    // (not scanLine(), which must not be called concurrently)
+    const uchar *const srcBits = src.constBits();
+    const qsizetype srcBytesPerLine = src.bytesPerLine();
+    uchar *const destBits = dest->bits();
+    const qsizetype destBytesPerLine = dest->bytesPerLine();
+
+    // How far the source coordinates move per destination pixel across.
+    const double stepX = inverse.m11();
+    const double stepY = inverse.m12();
+
+    ::kpParallelFor(dest->height(), AffineRowGrainSize, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            auto *const destLine = reinterpret_cast<QRgb *>(destBits + y * destBytesPerLine);
+
+            // (of the center of the first pixel of the row)
+            const QPointF rowStart = inverse.map(QPointF(0.5, y + 0.5));
+
+            int spanBegin = 0;
+            int spanEnd = destWidth;
+            ::ClipSpan(rowStart.x(), stepX, srcWidth, &spanBegin, &spanEnd);
+            ::ClipSpan(rowStart.y(), stepY, srcHeight, &spanBegin, &spanEnd);
+
+            std::fill(destLine, destLine + spanBegin, background);
+            std::fill(destLine + spanEnd, destLine + destWidth, background);
+
+            double sx = rowStart.x() + spanBegin * stepX;
+            double sy = rowStart.y() + spanBegin * stepY;
+            for (int x = spanBegin; x < spanEnd; x++, sx += stepX, sy += stepY) {
+                if (sx < 0 || sx >= srcWidth || sy < 0 || sy >= srcHeight) {
+                    destLine[x] = background;
+                } else if (smooth) {
+                    destLine[x] = ::BilinearPixel(srcBits, srcBytesPerLine, srcWidth, srcHeight, sx, sy);
+                } else {
+                    destLine[x] = reinterpret_cast<const QRgb *>(srcBits + int(sy) * srcBytesPerLine)[int(sx)];
+                }
+            }
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
 // Like QPixmap::transformed() but fills new areas with <backgroundColor>
 // (unless <backgroundColor> is invalid) and works around internal QTransform
 // floating point -> integer oddities, that would otherwise give fatally
@@ -230,7 +457,14 @@ static QTransform TrueMatrix(const QTransform &matrix, int srcPixmapWidth, int s
 //
 // Use <targetWidth> and <targetHeight> to specify the intended output size
 // of the pixmap.  -1 if don't care.
-static QImage TransformPixmap(const QImage &pm, const QTransform &transformMatrix_, const kpColor &backgroundColor, int targetWidth, int targetHeight)
+//
+// If <smooth>, source pixels are interpolated (see AffineTransform32()).
+static QImage TransformPixmap(const QImage &pm,
+                              const QTransform &transformMatrix_,
+                              const kpColor &backgroundColor,
+                              int targetWidth,
+                              int targetHeight,
+                              bool smooth)
 {
     QTransform transformMatrix = transformMatrix_;
 
@@ -339,34 +573,25 @@ static QImage TransformPixmap(const QImage &pm, const QTransform &transformMatri
 #endif
     }
 
-#if DEBUG_KP_PIXMAP_FX && 0
-    qCDebug(kpLogPixmapfx) << "\ttranslate top=" << painter.xForm(QPoint(0, 0));
-    qCDebug(kpLogPixmapfx) << "\tmatrix: m11=" << painter.worldMatrix().m11() << " m12=" << painter.worldMatrix().m12()
-                           << " m21=" << painter.worldMatrix().m21() << " m22=" << painter.worldMatrix().m22() << " dx=" << painter.worldMatrix().dx()
-                           << " dy=" << painter.worldMatrix().dy() << endl;
-#endif
-
-    // Note: Do _not_ use "p.setRenderHints (QPainter::SmoothPixmapTransform);"
-    //       as the user does not want their image to get blurier every
-    //       time they e.g. rotate it (especially important for multiples
-    //       of 90 degrees but also true for every other angle).  Being a
-    //       pixel-based program, we generally like to preserve RGB values
-    //       and avoid unnecessary blurs -- in the worst case, we'd rather
-    //       drop pixels, than blur.
-    QPainter p(&newQImage);
-    {
-        // Make sure transparent pixels are drawn into the destination image.
-        p.setCompositionMode(QPainter::CompositionMode_Source);
-
-        // Fill the entire new image with the background color.
-        if (backgroundColor.isValid()) {
-            p.fillRect(newQImage.rect(), backgroundColor.toQColor());
-        }
+    // Note: Do _not_ interpolate by default, as the user does not want
+    //       their image to get blurier every time they e.g. rotate it
+    //       (especially important for multiples of 90 degrees but also
+    //       true for every other angle).  Being a pixel-based program, we
+    //       generally like to preserve RGB values and avoid unnecessary
+    //       blurs -- in the worst case, we'd rather drop pixels, than blur.
+    //
+    // Transparent pixels are copied into the destination image as they are.
+    if (newQImage.isNull()) {
+        qCCritical(kpLogPixmapfx) << "TransformPixmap() could not allocate" << newQImage.size();
+        return newQImage;
+    }
 
-        p.setWorldTransform(transformMatrix);
-        p.drawImage(QPoint(0, 0), pm);
+    QImage src = pm;
+    if (src.format() != QImage::Format_RGB32 && src.format() != QImage::Format_ARGB32_Premultiplied) {
+        src = src.convertToFormat(QImage::Format_ARGB32_Premultiplied);
     }
-    p.end();
+
+    ::AffineTransform32(src, &newQImage, transformMatrix, backgroundColor.isValid() ? qPremultiply(backgroundColor.toQRgb()) : 0, smooth);
 
 #if DEBUG_KP_PIXMAP_FX && 1
     qCDebug(kpLogPixmapfx) << "Done";
@@ -431,19 +656,19 @@ QTransform kpPixmapFX::skewMatrix(const QImage &pixmap, double hangle, double va
 //---------------------------------------------------------------------
 
 // public static
-void kpPixmapFX::skew(QImage *destPtr, double hangle, double vangle, const kpColor &backgroundColor, int targetWidth, int targetHeight)
+void kpPixmapFX::skew(QImage *destPtr, double hangle, double vangle, const kpColor &backgroundColor, int targetWidth, int targetHeight, bool pretty)
 {
     if (!destPtr) {
         return;
     }
 
-    *destPtr = kpPixmapFX::skew(*destPtr, hangle, vangle, backgroundColor, targetWidth, targetHeight);
+    *destPtr = kpPixmapFX::skew(*destPtr, hangle, vangle, backgroundColor, targetWidth, targetHeight, pretty);
 }
 
 //---------------------------------------------------------------------
 
 // public static
-QImage kpPixmapFX::skew(const QImage &pm, double hangle, double vangle, const kpColor &backgroundColor, int targetWidth, int targetHeight)
+QImage kpPixmapFX::skew(const QImage &pm, double hangle, double vangle, const kpColor &backgroundColor, int targetWidth, int targetHeight, bool pretty)
 {
 #if DEBUG_KP_PIXMAP_FX
     qCDebug(kpLogPixmapfx) << "kpPixmapFX::skew() pm.width=" << pm.width() << " pm.height=" << pm.height() << " hangle=" << hangle << " vangle=" << vangle
@@ -462,7 +687,7 @@ QImage kpPixmapFX::skew(const QImage &pm, double hangle, double vangle, const kp
 
     QTransform matrix = skewMatrix(pm, hangle, vangle);
 
-    return ::TransformPixmap(pm, matrix, backgroundColor, targetWidth, targetHeight);
+    return ::TransformPixmap(pm, matrix, backgroundColor, targetWidth, targetHeight, pretty);
 }
 
 //---------------------------------------------------------------------
@@ -521,27 +746,226 @@ bool kpPixmapFX::isLosslessRotation(double angle)
 //---------------------------------------------------------------------
 
 // public static
-void kpPixmapFX::rotate(QImage *destPtr, double angle, const kpColor &backgroundColor, int targetWidth, int targetHeight)
+void kpPixmapFX::rotate(QImage *destPtr, double angle, const kpColor &backgroundColor, int targetWidth, int targetHeight, bool pretty)
 {
     if (!destPtr) {
         return;
     }
 
-    *destPtr = kpPixmapFX::rotate(*destPtr, angle, backgroundColor, targetWidth, targetHeight);
+    *destPtr = kpPixmapFX::rotate(*destPtr, angle, backgroundColor, targetWidth, targetHeight, pretty);
 }
 
 //---------------------------------------------------------------------
 
 // public static
-QImage kpPixmapFX::rotate(const QImage &pm, double angle, const kpColor &backgroundColor, int targetWidth, int targetHeight)
+QImage kpPixmapFX::rotate(const QImage &pm, double angle, const kpColor &backgroundColor, int targetWidth, int targetHeight, bool pretty)
 {
     if (std::fabs(angle - 0) < kpPixmapFX::AngleInDegreesEpsilon && (targetWidth <= 0 && targetHeight <= 0) /*don't want to scale?*/) {
         return pm;
     }
 
+    // Multiples of 90 degrees don't need a QPainter - or the background
+    // color, since no new areas are exposed.
+    if (kpPixmapFX::isLosslessRotation(angle) && (targetWidth <= 0 && targetHeight <= 0)) {
+        return kpPixmapFX::rotateQuarterTurns(pm, qRound(angle / 90));
+    }
+
     QTransform matrix = rotateMatrix(pm, angle);
 
-    return ::TransformPixmap(pm, matrix, backgroundColor, targetWidth, targetHeight);
+    return ::TransformPixmap(pm, matrix, backgroundColor, targetWidth, targetHeight, pretty);
+}
+
+//---------------------------------------------------------------------
+
+// Rotation works on square tiles of this many pixels across, so that both
+// the source rows being read down and the destination rows being written
+// across stay in the CPU cache.  64 * 64 * 4 bytes = 16KB per tile.
+static const int RotateTileSize = 64;
+
+// Rotates the 32-bit <src> into <dest> (which must already have the rotated
+// dimensions and the same format), where <quarterTurns> is 1, 2 or 3.
+static void RotateQuarterTurns32(const QImage &src, QImage *dest, int quarterTurns)
+{
+    const int srcWidth = src.width();
+    const int srcHeight = src.height();
+    const int destWidth = dest->width();
+    const int destHeight = dest->height();
+
+    const uchar *const srcBits = src.constBits();
+    const qsizetype srcBytesPerLine = src.bytesPerLine();
+    uchar *const destBits = dest->bits();
+    const qsizetype destBytesPerLine = dest->bytesPerLine();
+
+    const int numTileRows = (destHeight + RotateTileSize - 1) / RotateTileSize;
+
+    ::kpParallelFor(numTileRows, 1 /*grain size*/, [&](int beginTileRow, int endTileRow) {
+        for (int tileRow = beginTileRow; tileRow < endTileRow; tileRow++) {
+            const int y0 = tileRow * RotateTileSize;
+            const int y1 = std::min(destHeight, y0 + RotateTileSize);
+
+            for (int x0 = 0; x0 < destWidth; x0 += RotateTileSize) {
+                const int x1 = std::min(destWidth, x0 + RotateTileSize);
+
+                for (int y = y0; y < y1; y++) {
+                    auto *destLine = reinterpret_cast<quint32 *>(destBits + y * destBytesPerLine);
+
+                    switch (quarterTurns) {
+                    case 1: {
+                        // dest(x, y) = src(y, srcHeight - 1 - x)
+                        const uchar *srcPixel = srcBits + (srcHeight - 1 - x0) * srcBytesPerLine + y * 4;
+                        for (int x = x0; x < x1; x++) {
+                            destLine[x] = *reinterpret_cast<const quint32 *>(srcPixel);
+                            srcPixel -= srcBytesPerLine;
+                        }
+                        break;
+                    }
+
+                    case 2: {
+                        // dest(x, y) = src(srcWidth - 1 - x, srcHeight - 1 - y)
+                        const auto *srcLine = reinterpret_cast<const quint32 *>(srcBits + (srcHeight - 1 - y) * srcBytesPerLine);
+                        for (int x = x0; x < x1; x++) {
+                            destLine[x] = srcLine[srcWidth - 1 - x];
+                        }
+                        break;
+                    }
+
+                    case 3: {
+                        // dest(x, y) = src(srcWidth - 1 - y, x)
+                        const uchar *srcPixel = srcBits + x0 * srcBytesPerLine + (srcWidth - 1 - y) * 4;
+                        for (int x = x0; x < x1; x++) {
+                            destLine[x] = *reinterpret_cast<const quint32 *>(srcPixel);
+                            srcPixel += srcBytesPerLine;
+                        }
+                        break;
+                    }
+
+                    default:
+                        Q_ASSERT(!"Unexpected number of quarter turns");
+                        break;
+                    }
+                }
+            }
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QImage kpPixmapFX::rotateQuarterTurns(const QImage &image, int quarterTurns)
+{
+    // Normalize into 0...3 (clockwise).
+    quarterTurns = ((quarterTurns % 4) + 4) % 4;
+
+#if DEBUG_KP_PIXMAP_FX
+    qCDebug(kpLogPixmapfx) << "kpPixmapFX::rotateQuarterTurns(" << image.size() << "," << quarterTurns << ")";
+#endif
+
+    if (quarterTurns == 0 || image.isNull()) {
+        return image;
+    }
+
+    if (image.depth() != 32) {
+        // Rare: kpDocument images are 32-bit.  QImage has its own fast
+        // path for exact multiples of 90 degrees.
+        return image.transformed(QTransform().rotate(quarterTurns * 90));
+    }
+
+    const bool swapsDimensions = (quarterTurns != 2);
+
+    QImage ret(swapsDimensions ? image.height() : image.width(), swapsDimensions ? image.width() : image.height(), image.format());
+    if (ret.isNull()) {
+        qCCritical(kpLogPixmapfx) << "kpPixmapFX::rotateQuarterTurns() could not allocate" << ret.size();
+        return ret;
+    }
+
+    ::RotateQuarterTurns32(image, &ret, quarterTurns);
+
+    ret.setDotsPerMeterX(swapsDimensions ? image.dotsPerMeterY() : image.dotsPerMeterX());
+    ret.setDotsPerMeterY(swapsDimensions ? image.dotsPerMeterX() : image.dotsPerMeterY());
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public static
+void kpPixmapFX::flip(QImage *destPtr, bool horiz, bool vert)
+{
+    if (!destPtr || destPtr->isNull() || (!horiz && !vert)) {
+        return;
+    }
+
+    const int depth = destPtr->depth();
+
+    // Reversing a row needs whole-byte pixels of a size we handle below.
+    // Anything else is rare (e.g. 1-bit selection transparency masks).
+    if (horiz && depth != 8 && depth != 32) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 9, 0)
+        Qt::Orientations orientation;
+        if (horiz)
+            orientation |= Qt::Horizontal;
+        if (vert)
+            orientation |= Qt::Vertical;
+        destPtr->flip(orientation);
+#else
+        destPtr->mirror(horiz, vert);
+#endif
+        return;
+    }
+
+    const int width = destPtr->width();
+    const int height = destPtr->height();
+    const qsizetype rowBytes = (qsizetype(width) * depth + 7) / 8;
+
+    // (detaches if shared)
+    uchar *const bits = destPtr->bits();
+    const qsizetype bytesPerLine = destPtr->bytesPerLine();
+
+    const auto reverseRow = [width, depth](uchar *row) {
+        if (depth == 32) {
+            auto *pixels = reinterpret_cast<quint32 *>(row);
+            std::reverse(pixels, pixels + width);
+        } else {
+            std::reverse(row, row + width);
+        }
+    };
+
+    // Each iteration handles row <y> and (if flipping vertically) its
+    // partner row, so there is no need for a second image.
+    const int numRows = vert ? (height + 1) / 2 : height;
+
+    ::kpParallelFor(numRows, 64 /*grain size*/, [&](int beginRow, int endRow) {
+        for (int y = beginRow; y < endRow; y++) {
+            uchar *const row = bits + y * bytesPerLine;
+
+            if (vert) {
+                const int otherY = height - 1 - y;
+                if (otherY != y) {
+                    uchar *const otherRow = bits + otherY * bytesPerLine;
+                    std::swap_ranges(row, row + rowBytes, otherRow);
+
+                    if (horiz) {
+                        reverseRow(otherRow);
+                    }
+                }
+            }
+
+            if (horiz) {
+                reverseRow(row);
+            }
+        }
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public static
+QImage kpPixmapFX::flip(const QImage &image, bool horiz, bool vert)
+{
+    QImage ret = image;
+    kpPixmapFX::flip(&ret, horiz, vert);
+    return ret;
 }
 
 //---------------------------------------------------------------------
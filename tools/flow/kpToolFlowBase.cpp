@@ -9,6 +9,8 @@
 
 #include "kpToolFlowBase.h"
 
+#include <QPolygon>
+
 #include <cstdlib>
 
 #include "kpLogCategories.h"
@@ -238,6 +240,68 @@ void kpToolFlowBase::draw(const QPoint &thisPoint, const QPoint &lastPoint, cons
 
 //---------------------------------------------------------------------
 
+// Returns whether only a point, rather than a line, needs to be drawn to
+// get from <lastPoint> to <thisPoint>.
+//
+// (sync: kpTool::currentPointNextToLast(),
+//        kpTool::currentPointCardinallyNextToLast())
+static bool PointIsNextToLast(const QPoint &thisPoint, const QPoint &lastPoint, bool cardinally)
+{
+    if (lastPoint == QPoint(-1, -1)) {
+        return true;
+    }
+
+    if (cardinally) {
+        return (thisPoint == lastPoint || kpPainter::pointsAreCardinallyAdjacent(thisPoint, lastPoint));
+    }
+
+    return (qAbs(thisPoint.x() - lastPoint.x()) <= 1 && qAbs(thisPoint.y() - lastPoint.y()) <= 1);
+}
+
+//---------------------------------------------------------------------
+
+// virtual
+QRect kpToolFlowBase::drawLines(const QPolygon &points)
+{
+    QRect dirtyRect;
+
+    // (sync: draw())
+    for (int i = 1; i < points.size(); i++) {
+        if (::PointIsNextToLast(points[i], points[i - 1], d->brushIsDiagonalLine)) {
+            dirtyRect |= drawPoint(points[i]);
+        } else {
+            dirtyRect |= drawLine(points[i], points[i - 1]);
+        }
+    }
+
+    return dirtyRect;
+}
+
+//---------------------------------------------------------------------
+
+// protected virtual [base kpTool]
+void kpToolFlowBase::drawPolyline(const QPolygon &points)
+{
+    // (sync: draw())
+
+    // (does not depend on the points)
+    if (!/*virtual*/ drawShouldProceed(points.last(), points.first(), normalizedRect())) {
+        return;
+    }
+
+    // sync: remember to restoreFastUpdates() in all exit paths
+    viewManager()->setFastUpdates();
+
+    const QRect dirtyRect = drawLines(points);
+
+    d->currentCommand->updateBoundingRect(dirtyRect);
+
+    viewManager()->restoreFastUpdates();
+    setUserShapePoints(points.last());
+}
+
+//---------------------------------------------------------------------
+
 // virtual
 void kpToolFlowBase::cancelShape()
 {
@@ -14,6 +14,7 @@
 #include "tools/kpTool.h"
 
 class QPoint;
+class QPolygon;
 class QString;
 
 class kpColor;
@@ -50,11 +51,25 @@ public:
         return true;
     }
     void draw(const QPoint &thisPoint, const QPoint &lastPoint, const QRect &normalizedRect) override;
+
+    // Draws the segments of <points> (see kpTool::drawPolyline()) and
+    // returns the dirty rectangle.  The default implementation calls
+    // drawPoint() or drawLine() for each segment, like draw().  Override
+    // this if you can be more efficient e.g. by only getting and setting
+    // the document image once.
+    virtual QRect drawLines(const QPolygon &points);
+
     void cancelShape() override;
     void releasedAllButtons() override;
     void endDraw(const QPoint &, const QRect &) override;
 
 protected:
+    bool coalescesMouseMoves() const override
+    {
+        return true;
+    }
+    void drawPolyline(const QPolygon &points) override;
+
     virtual QString haventBegunDrawUserMessage() const = 0;
 
     virtual bool haveSquareBrushes() const
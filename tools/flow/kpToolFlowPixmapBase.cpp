@@ -13,6 +13,8 @@
 #include "imagelib/kpPainter.h"
 #include "pixmapfx/kpPixmapFX.h"
 
+#include <QPolygon>
+
 //---------------------------------------------------------------------
 
 kpToolFlowPixmapBase::kpToolFlowPixmapBase(const QString &text,
@@ -55,4 +57,31 @@ QRect kpToolFlowPixmapBase::drawLine(const QPoint &thisPoint, const QPoint &last
 
 //---------------------------------------------------------------------
 
+// Same as calling drawLine() for each segment but only gets and sets the
+// document image once.
+QRect kpToolFlowPixmapBase::drawLines(const QPolygon &points)
+{
+    Q_ASSERT(points.first() != QPoint(-1, -1));
+
+    QRect docRect = points.boundingRect();
+    docRect = neededRect(docRect, qMax(brushWidth(), brushHeight()));
+    kpImage image = document()->getImageAt(docRect);
+
+    for (int i = 1; i < points.size(); i++) {
+        // (drawPoint() would only draw at <points>[i], which is also done
+        //  here - drawing the brush twice at the same point is harmless)
+        const QList<QPoint> linePoints = kpPainter::interpolatePoints(points[i - 1], points[i], brushIsDiagonalLine());
+
+        for (const QPoint &p : linePoints) {
+            const QPoint point = hotRectForMousePointAndBrushWidthHeight(p, brushWidth(), brushHeight()).topLeft() - docRect.topLeft();
+            brushDrawFunction()(&image, point, brushDrawFunctionData());
+        }
+    }
+
+    document()->setImageAt(image, docRect.topLeft());
+    return docRect;
+}
+
+//---------------------------------------------------------------------
+
 #include "moc_kpToolFlowPixmapBase.cpp"
@@ -27,6 +27,7 @@ public:
 
 protected:
     QRect drawLine(const QPoint &thisPoint, const QPoint &lastPoint) override;
+    QRect drawLines(const QPolygon &points) override;
 };
 
 #endif // KP_TOOL_FLOW_PIXMAP_BASE_H
@@ -17,6 +17,7 @@
 #include <KLocalizedString>
 
 #include <QPainter>
+#include <QPolygon>
 
 //---------------------------------------------------------------------
 
@@ -56,6 +57,33 @@ QRect kpToolPen::drawLine(const QPoint &thisPoint, const QPoint &lastPoint)
     return docRect;
 }
 
+//---------------------------------------------------------------------
+
+// protected virtual [base kpToolFlowBase]
+QRect kpToolPen::drawLines(const QPolygon &points)
+{
+    Q_ASSERT(points.first() != QPoint(-1, -1));
+
+    // (sync: drawLine())
+    QRect docRect = points.boundingRect();
+    docRect = neededRect(docRect, 1 /*pen width*/);
+    kpImage image = document()->getImageAt(docRect);
+
+    QPainter painter(&image);
+    painter.setPen(color(mouseButton()).toQColor());
+
+    // Not drawPolyline(), which would not draw the shared end points
+    // of the segments the same way as drawLine().
+    for (int i = 1; i < points.size(); i++) {
+        painter.drawLine(points[i - 1] - docRect.topLeft(), points[i] - docRect.topLeft());
+    }
+
+    painter.end();
+
+    document()->setImageAt(image, docRect.topLeft());
+    return docRect;
+}
+
 //--------------------------------------------------------------------------------
 
 #include "moc_kpToolPen.cpp"
@@ -21,6 +21,7 @@ public:
 protected:
     QString haventBegunDrawUserMessage() const override;
     QRect drawLine(const QPoint &thisPoint, const QPoint &lastPoint) override;
+    QRect drawLines(const QPolygon &points) override;
 };
 
 #endif // KP_TOOL_PEN_H
@@ -27,6 +27,14 @@ public:
 protected:
     QString haventBegunDrawUserMessage() const override;
 
+    // drawPoint() compares against lastPoint(), which is only up to date
+    // when points are drawn one at a time.  The timer limits how often we
+    // draw anyway.
+    bool coalescesMouseMoves() const override
+    {
+        return false;
+    }
+
 public:
     void begin() override;
     void end() override;
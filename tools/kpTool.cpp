@@ -13,6 +13,8 @@
 #include "kpTool.h"
 #include "kpToolPrivate.h"
 
+#include <QTimer>
+
 #include <climits>
 
 #include "kpLogCategories.h"
@@ -44,6 +46,10 @@ kpTool::kpTool(const QString &text, const QString &description, int key, kpToolE
     d->description = description;
     d->began = false;
     d->viewUnderStartPoint = nullptr;
+    d->queuedDrawTimer = new QTimer(this);
+    d->queuedDrawTimer->setSingleShot(true);
+    d->queuedDrawTimer->setTimerType(Qt::PreciseTimer);
+    connect(d->queuedDrawTimer, &QTimer::timeout, this, &kpTool::flushQueuedDrawsInternal);
     d->userShapeStartPoint = KP_INVALID_POINT;
     d->userShapeEndPoint = KP_INVALID_POINT;
     d->userShapeSize = KP_INVALID_SIZE;
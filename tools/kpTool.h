@@ -24,6 +24,7 @@ class QFocusEvent;
 class QInputMethodEvent;
 class QKeyEvent;
 class QMouseEvent;
+class QPolygon;
 class QImage;
 class QWheelEvent;
 
@@ -201,9 +202,39 @@ protected:
     // this is useful for "instant" tools like the Pen & Eraser
     virtual void draw(const QPoint &thisPoint, const QPoint &lastPoint, const QRect &normalizedRect);
 
+    // Return true to have the mouse moves, that arrive while drawing,
+    // batched up and passed to drawPolyline() at most about once per
+    // display frame, instead of calling draw() for every mouse move.
+    // High rate mice and tablets can otherwise generate many more draws
+    // than can be shown.
+    virtual bool coalescesMouseMoves() const
+    {
+        return false;
+    }
+
+    // Called, if coalescesMouseMoves(), with every document point that
+    // the mouse has moved through since the last draw.  <points>[0] is
+    // lastPoint(), which has already been drawn.  No points are dropped.
+    //
+    // View updates are queued for the duration of the call, so that the
+    // views get one combined update.
+    //
+    // The default implementation calls draw() for each segment, with
+    // currentPoint() and lastPoint() set accordingly.  Reimplement this
+    // if you can draw the whole polyline more cheaply at once.
+    virtual void drawPolyline(const QPolygon &points);
+
 private:
     void drawInternal();
 
+    // Called instead of drawInternal() for a mouse move, if
+    // coalescesMouseMoves().
+    void queueDrawInternal();
+    // Draws any points queued by queueDrawInternal().
+    void flushQueuedDrawsInternal();
+    // Discards any points queued by queueDrawInternal().
+    void discardQueuedDrawsInternal();
+
 protected:
     // (m_mouseButton will not change from beginDraw())
     virtual void cancelShape();
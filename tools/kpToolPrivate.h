@@ -8,7 +8,9 @@
 #ifndef kpToolPrivate_H
 #define kpToolPrivate_H
 
+#include <QElapsedTimer>
 #include <QPoint>
+#include <QPolygon>
 
 #include <QSize>
 #ifdef Q_OS_WIN
@@ -18,6 +20,8 @@
 
 #include "views/kpView.h"
 
+class QTimer;
+
 class kpToolEnvironment;
 class KToggleAction;
 
@@ -38,6 +42,16 @@ struct kpToolPrivate {
 
     kpView *viewUnderStartPoint;
 
+    // Mouse move coalescing (see kpTool::coalescesMouseMoves()).
+    //
+    // Document points the mouse has moved through, while drawing, that
+    // have not been passed to drawPolyline() yet.
+    QPolygon queuedDrawPoints;
+    // Fires at the next frame, to draw <queuedDrawPoints>.
+    QTimer *queuedDrawTimer;
+    // Time since <queuedDrawPoints> were last drawn.
+    QElapsedTimer lastQueuedDrawTimer;
+
     // Set to 2 when the user swaps the foreground and background color.
     //
     // When nonzero, it suppresses the foreground and background "color changed"
@@ -15,10 +15,14 @@
 #include "tools/kpTool.h"
 
 #include <QApplication>
+#include <QScreen>
+#include <QTimer>
+#include <QWidget>
 
 #include "kpLogCategories.h"
 
 #include "environments/tools/kpToolEnvironment.h"
+#include "generic/kpProfiler.h"
 #include "imagelib/kpPainter.h"
 #include "views/kpView.h"
 #include "views/manager/kpViewManager.h"
@@ -283,15 +287,127 @@ void kpTool::draw(const QPoint &, const QPoint &, const QRect &)
 // private
 void kpTool::drawInternal()
 {
+    kpProfilerScope profilerScope(kpProfiler::ToolDraw, metaObject()->className());
+
     draw(d->currentPoint, d->lastPoint, normalizedRect());
 }
 
 //---------------------------------------------------------------------
 
+// virtual
+void kpTool::drawPolyline(const QPolygon &points)
+{
+    Q_ASSERT(points.size() >= 2);
+    Q_ASSERT(points.first() == d->lastPoint);
+
+    for (int i = 1; i < points.size(); i++) {
+        d->currentPoint = points[i];
+        draw(d->currentPoint, d->lastPoint, normalizedRect());
+        d->lastPoint = d->currentPoint;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Returns the interval between display frames of <view>'s screen, in
+// milliseconds.
+static int FrameIntervalMsecs(const QWidget *view)
+{
+    const QScreen *screen = view ? view->screen() : nullptr;
+    const qreal refreshRate = screen ? screen->refreshRate() : 0;
+
+    if (refreshRate <= 0) {
+        return 16;
+    }
+
+    // Clamp against nonsensical values, which some platforms report.
+    return qBound(4, qRound(1000 / refreshRate), 33);
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTool::queueDrawInternal()
+{
+    d->queuedDrawPoints.append(d->currentPoint);
+
+    if (d->queuedDrawTimer->isActive()) {
+        return;
+    }
+
+    const int frameInterval = ::FrameIntervalMsecs(viewUnderStartPoint());
+    const qint64 sinceLastDraw = d->lastQueuedDrawTimer.isValid() ? d->lastQueuedDrawTimer.elapsed() : frameInterval;
+
+    // If the mouse is moving slowly, draw immediately so that there is no
+    // extra latency.  Else, wait for the next frame.
+    if (sinceLastDraw >= frameInterval) {
+        flushQueuedDrawsInternal();
+    } else {
+        d->queuedDrawTimer->start(frameInterval - static_cast<int>(sinceLastDraw));
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTool::flushQueuedDrawsInternal()
+{
+    d->queuedDrawTimer->stop();
+
+    if (d->queuedDrawPoints.isEmpty()) {
+        return;
+    }
+
+    if (!d->beganDraw) {
+        discardQueuedDrawsInternal();
+        return;
+    }
+
+    QPolygon points;
+    points.reserve(1 + d->queuedDrawPoints.size());
+    points.append(d->lastPoint);
+    points += d->queuedDrawPoints;
+    d->queuedDrawPoints.clear();
+
+    // (someone may have changed it since the last queueDrawInternal())
+    const QPoint oldCurrentPoint = d->currentPoint;
+
+    {
+        kpProfilerScope profilerScope(kpProfiler::ToolDraw, metaObject()->className());
+
+        // One combined update of the views for all the segments.
+        viewManager()->setQueueUpdates();
+        {
+            d->currentPoint = points.last();
+            drawPolyline(points);
+        }
+        viewManager()->restoreQueueUpdates();
+    }
+
+    d->lastPoint = points.last();
+    d->currentPoint = oldCurrentPoint;
+
+    d->lastQueuedDrawTimer.start();
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTool::discardQueuedDrawsInternal()
+{
+    d->queuedDrawTimer->stop();
+    d->queuedDrawPoints.clear();
+    d->lastQueuedDrawTimer.invalidate();
+}
+
+//---------------------------------------------------------------------
+
 // also called by kpView
 void kpTool::cancelShapeInternal()
 {
     if (hasBegunShape()) {
+        discardQueuedDrawsInternal();
+
         d->beganDraw = false;
         cancelShape();
         d->viewUnderStartPoint = nullptr;
@@ -342,6 +458,10 @@ void kpTool::endDrawInternal(const QPoint &thisPoint, const QRect &normalizedRec
         return;
     }
 
+    // (no-op if the mouse was released, as that has already flushed)
+    flushQueuedDrawsInternal();
+    d->lastQueuedDrawTimer.invalidate();
+
     d->beganDraw = false;
 
     if (wantEndShape) {
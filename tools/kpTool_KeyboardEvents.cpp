@@ -332,6 +332,7 @@ void kpTool::notifyModifierStateChanged()
 {
     if (careAboutModifierState()) {
         if (d->beganDraw) {
+            flushQueuedDrawsInternal();
             draw(d->currentPoint, d->lastPoint, normalizedRect());
         } else {
             d->currentPoint = calculateCurrentPoint();
@@ -17,6 +17,7 @@
 #include "kpLogCategories.h"
 
 #include "environments/tools/kpToolEnvironment.h"
+#include "generic/kpProfiler.h"
 #include "views/kpView.h"
 #include "views/manager/kpViewManager.h"
 
@@ -122,7 +123,10 @@ void kpTool::mousePressEvent(QMouseEvent *e)
 
     beginDrawInternal();
 
-    draw(d->currentPoint, d->lastPoint, QRect(d->currentPoint, d->currentPoint));
+    {
+        kpProfilerScope profilerScope(kpProfiler::ToolDraw, metaObject()->className());
+        draw(d->currentPoint, d->lastPoint, QRect(d->currentPoint, d->currentPoint));
+    }
     d->lastPoint = d->currentPoint;
 }
 
@@ -180,13 +184,22 @@ void kpTool::mouseMoveEvent(QMouseEvent *e)
             viewManager()->setFastUpdates();
         }
 
-        drawInternal();
+        if (coalescesMouseMoves() && !dragScrolled) {
+            // (draws now or at the next frame - either way, updates
+            //  lastPoint when it does)
+            queueDrawInternal();
+        } else {
+            // Keep the points in order.
+            flushQueuedDrawsInternal();
+
+            drawInternal();
+
+            d->lastPoint = d->currentPoint;
+        }
 
         if (dragScrolled) {
             viewManager()->restoreFastUpdates();
         }
-
-        d->lastPoint = d->currentPoint;
     } else {
         kpView *view = viewUnderCursor();
         if (!view) // possible if cancelShape()'ed but still holding down initial mousebtn
@@ -218,6 +231,9 @@ void kpTool::mouseReleaseEvent(QMouseEvent *e)
         kpView *view = viewUnderStartPoint();
         Q_ASSERT(view);
 
+        // Draw the moves leading up to the release first.
+        flushQueuedDrawsInternal();
+
         d->currentPoint = view->transformViewToDoc(e->pos());
         d->currentViewPoint = e->pos();
 
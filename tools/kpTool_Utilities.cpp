@@ -117,6 +117,9 @@ void kpTool::somethingBelowTheCursorChanged(const QPoint &currentPoint_, const Q
     qCDebug(kpLogTools) << "\tbegan draw=" << d->beganDraw;
 #endif
 
+    // Keep the points in order.
+    flushQueuedDrawsInternal();
+
     d->currentPoint = currentPoint_;
     d->currentViewPoint = currentViewPoint_;
 
@@ -265,7 +265,6 @@ void kpAbstractSelectionTool::cancelMove()
 #if DEBUG_KP_TOOL_SELECTION
     qCDebug(kpLogTools) << "\t\tundo currentMoveCommand";
 #endif
-    d->currentMoveCommand->finalize();
     d->currentMoveCommand->unexecute();
     delete d->currentMoveCommand;
     d->currentMoveCommand = nullptr;
@@ -291,8 +290,6 @@ void kpAbstractSelectionTool::endDrawMove()
         return;
     }
 
-    d->currentMoveCommand->finalize();
-
     kpMacroCommand *renamedCmd = nullptr;
 #if DEBUG_KP_TOOL_SELECTION
     qCDebug(kpLogTools) << "\thave moveCommand";
@@ -59,4 +59,10 @@ void kpThumbnailView::resizeEvent(QResizeEvent *e)
     setUpdatesEnabled(oldIsUpdatesEnabled);
 }
 
+// protected virtual [base kpView]
+bool kpThumbnailView::paintEventUsesSmoothDownscaler() const
+{
+    return zoomLevelX() < 100 && zoomLevelY() < 100;
+}
+
 #include "moc_kpThumbnailView.cpp"
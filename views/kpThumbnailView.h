@@ -58,6 +58,14 @@ protected:
      * Extends @ref kpView.
      */
     void resizeEvent(QResizeEvent *e) override;
+
+    /**
+     * @returns whether the document is shown smaller than its actual size,
+     *          so that it should be averaged down to avoid aliasing.
+     *
+     * Extends @ref kpView.
+     */
+    bool paintEventUsesSmoothDownscaler() const override;
 };
 
 #endif // KP_THUMBNAIL_VIEW_H
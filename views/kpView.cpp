@@ -59,6 +59,11 @@ kpView::kpView(kpDocument *document,
     d->showGrid = false;
     d->isBuddyViewScrollableContainerRectangleShown = false;
 
+    d->selectionBorderOverlayType = nullptr;
+    d->selectionBorderOverlayFinished = false;
+    d->selectionResizeHandlesOverlayZoomLevelX = 0;
+    d->selectionResizeHandlesOverlayOneTextLine = false;
+
     // Don't waste CPU drawing default background since it is overridden by
     // our fully opaque drawing. In reality, this seems to make no
     // difference in performance.
@@ -481,9 +486,9 @@ void kpView::setHasMouse(bool yes)
 void kpView::addToQueuedArea(const QRegion &region)
 {
 #if DEBUG_KP_VIEW && 0
-    qCDebug(kpLogViews) << "kpView(" << objectName() << ")::addToQueuedArea() already=" << d->queuedUpdateArea << " - plus - " << region << endl;
+    qCDebug(kpLogViews) << "kpView(" << objectName() << ")::addToQueuedArea() already=" << d->queuedUpdateArea.rects() << " - plus - " << region << endl;
 #endif
-    d->queuedUpdateArea += region;
+    d->queuedUpdateArea.add(region);
 }
 
 //---------------------------------------------------------------------
@@ -492,9 +497,9 @@ void kpView::addToQueuedArea(const QRegion &region)
 void kpView::addToQueuedArea(const QRect &rect)
 {
 #if DEBUG_KP_VIEW && 0
-    qCDebug(kpLogViews) << "kpView(" << objectName() << ")::addToQueuedArea() already=" << d->queuedUpdateArea << " - plus - " << rect << endl;
+    qCDebug(kpLogViews) << "kpView(" << objectName() << ")::addToQueuedArea() already=" << d->queuedUpdateArea.rects() << " - plus - " << rect << endl;
 #endif
-    d->queuedUpdateArea += rect;
+    d->queuedUpdateArea.add(rect);
 }
 
 //---------------------------------------------------------------------
@@ -506,7 +511,7 @@ void kpView::invalidateQueuedArea()
     qCDebug(kpLogViews) << "kpView::invalidateQueuedArea()";
 #endif
 
-    d->queuedUpdateArea = QRegion();
+    d->queuedUpdateArea.clear();
 }
 
 //---------------------------------------------------------------------
@@ -517,7 +522,7 @@ void kpView::updateQueuedArea()
     kpViewManager *vm = viewManager();
 #if DEBUG_KP_VIEW && 0
     qCDebug(kpLogViews) << "kpView(" << objectName() << ")::updateQueuedArea() vm=" << (bool)vm << " queueUpdates=" << (vm && vm->queueUpdates())
-                        << " fastUpdates=" << (vm && vm->fastUpdates()) << " area=" << d->queuedUpdateArea << endl;
+                        << " fastUpdates=" << (vm && vm->fastUpdates()) << " area=" << d->queuedUpdateArea.rects() << endl;
 #endif
 
     if (!vm) {
@@ -529,7 +534,7 @@ void kpView::updateQueuedArea()
     }
 
     if (!d->queuedUpdateArea.isEmpty()) {
-        vm->updateView(this, d->queuedUpdateArea);
+        vm->updateView(this, d->queuedUpdateArea.region());
     }
 
     invalidateQueuedArea();
@@ -537,6 +542,23 @@ void kpView::updateQueuedArea()
 
 //---------------------------------------------------------------------
 
+// public
+void kpView::invalidateTextCursorUnderlay(const QRegion &viewRegion)
+{
+    if (d->textCursorUnderlay.isNull() || !viewRegion.intersects(d->textCursorUnderlayViewRect)) {
+        return;
+    }
+
+#if DEBUG_KP_VIEW && 0
+    qCDebug(kpLogViews) << "kpView(" << objectName() << ")::invalidateTextCursorUnderlay(" << viewRegion << ")";
+#endif
+
+    d->textCursorUnderlay = QImage();
+    d->textCursorUnderlayViewRect = QRect();
+}
+
+//---------------------------------------------------------------------
+
 // public
 QPoint kpView::mouseViewPoint(const QPoint &returnViewPoint) const
 {
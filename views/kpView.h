@@ -357,6 +357,18 @@ public:
      */
     void updateQueuedArea();
 
+    /**
+     * Tells the view that what it draws for the document has changed at
+     * <viewRegion> (as opposed to just what is drawn on top of it,
+     * such as the text cursor), so that any of it that the view has
+     * cached must be thrown away.
+     *
+     * @ref kpViewManager calls this for every update it sends the view.
+     *
+     * @param viewRegion Region (in view coordinates) that has changed.
+     */
+    void invalidateTextCursorUnderlay(const QRegion &viewRegion);
+
     QVariant inputMethodQuery(Qt::InputMethodQuery query) const override;
 
 public Q_SLOTS:
@@ -523,20 +535,42 @@ protected:
     // Draws a checkerboard that looks static even if the view is scrollable.
     void paintEventDrawCheckerBoard(QPainter *painter, const QRect &viewRect);
 
-    // Draws the selection and its border onto <destPixmap>.
+    // Draws the selection onto <destPixmap>.
     // <destPixmap> is the part of the document given by <docRect>.
     void paintEventDrawSelection(QImage *destPixmap, const QRect &docRect);
 
+    // Draws the selection border and text cursor, inside <viewRegion>,
+    // on top of the document.  These are drawn in view space from caches
+    // so that they can change (e.g. the text cursor blinking) without
+    // the document being recomposed.
+    void paintEventDrawSelectionOverlays(QPainter *painter, const QRegion &viewRegion);
+
     // Draws the parts of the selection's resize handles that are inside
     // <clipRect> onto the view
-    void paintEventDrawSelectionResizeHandles(const QRect &clipRect);
+    void paintEventDrawSelectionResizeHandles(QPainter *painter, const QRegion &viewRegion);
     void paintEventDrawTempImage(QImage *destPixmap, const QRect &docRect);
 
     // Draws the parts of the grid lines that are inside <viewRect> on
     // <painter>.
     void paintEventDrawGridLines(QPainter *painter, const QRect &viewRect);
 
-    void paintEventDrawDoc_Unclipped(const QRect &viewRect);
+    // Whether paintEventDrawDoc_Unclipped() scales the document up with
+    // kpPixmapFX::scaleIntegerNearest() at the current zoom level.  If so,
+    // it also draws the grid lines, if shown.
+    bool paintEventUsesIntegerUpscaler() const;
+
+    // Whether paintEventDrawDoc_Unclipped() scales the document down with
+    // kpResampler::scale(), which averages the document pixels under each
+    // view pixel instead of picking one, at the current zoom level.
+    virtual bool paintEventUsesSmoothDownscaler() const;
+
+    void paintEventDrawDoc_Unclipped(QPainter *painter, const QRect &viewRect);
+
+    // Returns the document, as paintEvent() would draw it at <viewRect>
+    // before any overlays.  <viewRect> is cached, until
+    // invalidateTextCursorUnderlay() is called for it.
+    const QImage &paintEventTextCursorUnderlay(const QRect &viewRect);
+
     void paintEvent(QPaintEvent *e) override;
 
 private:
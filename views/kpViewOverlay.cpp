@@ -0,0 +1,178 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#define DEBUG_KP_VIEW_OVERLAY 0
+
+#include "views/kpViewOverlay.h"
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+
+#include "kpLogCategories.h"
+
+#include "views/kpView.h"
+
+//---------------------------------------------------------------------
+
+// The overlay is rendered and cached in tiles of this many of its pixels
+// square.
+static const int TileSize = 256;
+
+// More cached tiles than this and the cache is simply thrown away (this is
+// only reached by a huge overlay viewed at a low zoom level).
+static const int MaxTiles = 256;
+
+//---------------------------------------------------------------------
+
+// public
+void kpViewOverlay::clear()
+{
+    m_tiles.clear();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpViewOverlay::paint(QPainter *painter, const kpView *view, const QRect &overlayRect, const QRect &docRect, const Renderer &render)
+{
+    paint(painter, overlayRect, docRect, render, [view, &overlayRect](const QRect &rect) {
+        QRect viewRect = view->transformDocToView(rect.translated(overlayRect.topLeft()));
+        // (so that e.g. a 1 pixel wide border does not vanish at
+        //  low zoom levels)
+        viewRect.setWidth(qMax(1, viewRect.width()));
+        viewRect.setHeight(qMax(1, viewRect.height()));
+        return viewRect;
+    });
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpViewOverlay::paintViewPixels(QPainter *painter, const QRect &overlayRect, const QRect &viewRect, const Renderer &render)
+{
+    paint(painter, overlayRect, viewRect, render, [&overlayRect](const QRect &rect) {
+        return rect.translated(overlayRect.topLeft());
+    });
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpViewOverlay::paint(QPainter *painter,
+                          const QRect &overlayRect,
+                          const QRect &rect,
+                          const Renderer &render,
+                          const std::function<QRect(const QRect &)> &toView)
+{
+    const QRect localRect = overlayRect.intersected(rect).translated(-overlayRect.topLeft());
+    if (localRect.isEmpty()) {
+        return;
+    }
+
+#if DEBUG_KP_VIEW_OVERLAY
+    qCDebug(kpLogViews) << "kpViewOverlay::paint(overlayRect=" << overlayRect << ",rect=" << rect << ") cachedTiles=" << m_tiles.size();
+#endif
+
+    const QPoint firstTile(localRect.left() / TileSize, localRect.top() / TileSize);
+    const QPoint lastTile(localRect.right() / TileSize, localRect.bottom() / TileSize);
+
+    if (m_tiles.size() + (lastTile.x() - firstTile.x() + 1) * (lastTile.y() - firstTile.y() + 1) > MaxTiles) {
+        m_tiles.clear();
+    }
+
+    for (int ty = firstTile.y(); ty <= lastTile.y(); ty++) {
+        for (int tx = firstTile.x(); tx <= lastTile.x(); tx++) {
+            const QList<Span> &spans = tileSpans(QPoint(tx, ty), overlayRect.size(), render);
+
+            for (const Span &span : spans) {
+                if (!span.rect.intersects(localRect)) {
+                    continue;
+                }
+
+                painter->fillRect(toView(span.rect), QColor::fromRgba(span.color));
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+const QList<kpViewOverlay::Span> &kpViewOverlay::tileSpans(const QPoint &tile, const QSize &overlaySize, const Renderer &render)
+{
+    auto it = m_tiles.constFind(tile);
+    if (it != m_tiles.constEnd()) {
+        return *it;
+    }
+
+    const QRect tileRect = QRect(tile.x() * TileSize, tile.y() * TileSize, TileSize, TileSize).intersected(QRect(QPoint(0, 0), overlaySize));
+
+#if DEBUG_KP_VIEW_OVERLAY
+    qCDebug(kpLogViews) << "\trendering tile" << tile << "rect=" << tileRect;
+#endif
+
+    QImage image(tileRect.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    render(&image, tileRect);
+
+    // Collect runs of same-colored pixels in each row, growing the run
+    // directly above instead, if it is identical but for its height.
+    QList<Span> spans;
+    QList<int> prevRowSpans, rowSpans;
+    for (int y = 0; y < image.height(); y++) {
+        const auto *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+
+        rowSpans.clear();
+        int prevRowIndex = 0;
+
+        for (int x = 0; x < image.width();) {
+            const QRgb pixel = line[x];
+            if (qAlpha(pixel) == 0) {
+                x++;
+                continue;
+            }
+
+            int endX = x + 1;
+            while (endX < image.width() && line[endX] == pixel) {
+                endX++;
+            }
+
+            const QRect runRect(tileRect.x() + x, tileRect.y() + y, endX - x, 1);
+            const QRgb color = qUnpremultiply(pixel);
+
+            // (runs in <prevRowSpans> are in increasing x order too)
+            while (prevRowIndex < prevRowSpans.size() && spans[prevRowSpans[prevRowIndex]].rect.left() < runRect.left()) {
+                prevRowIndex++;
+            }
+
+            if (prevRowIndex < prevRowSpans.size()) {
+                Span &above = spans[prevRowSpans[prevRowIndex]];
+                if (above.rect.left() == runRect.left() && above.rect.width() == runRect.width() && above.color == color) {
+                    above.rect.setBottom(runRect.bottom());
+                    rowSpans.append(prevRowSpans[prevRowIndex]);
+                    x = endX;
+                    continue;
+                }
+            }
+
+            rowSpans.append(spans.size());
+            spans.append(Span{runRect, color});
+
+            x = endX;
+        }
+
+        prevRowSpans.swap(rowSpans);
+    }
+
+#if DEBUG_KP_VIEW_OVERLAY
+    qCDebug(kpLogViews) << "\t\t" << spans.size() << "spans";
+#endif
+
+    return *m_tiles.insert(tile, spans);
+}
+
+//---------------------------------------------------------------------
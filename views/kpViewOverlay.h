@@ -0,0 +1,84 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpViewOverlay_H
+#define kpViewOverlay_H
+
+#include <functional>
+
+#include <QHash>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QRgb>
+#include <QSize>
+
+class QImage;
+class QPainter;
+
+class kpView;
+
+//
+// Something drawn on top of the document in a view, that is not part of
+// the document (e.g. the selection border, the text cursor or the
+// selection resize handles).
+//
+// The overlay is described in document pixels (or, for things that are
+// the same size at any zoom level, view pixels), relative to its own
+// top-left, and is cached as runs of same-colored pixels.  Painting it at
+// any zoom level is then just a few fillRect()'s in view space: the
+// document under it does not have to be recomposed to draw it, nor to
+// draw it somewhere else (e.g. when a selection is moved).
+//
+// The cache is filled lazily, a tile at a time, so that only the parts
+// of a large overlay that are actually painted are ever rendered.
+//
+class kpViewOverlay
+{
+public:
+    // Draws the overlay's pixels that are in <docRect> onto <image>, which
+    // is transparent and the size of <docRect>.  <docRect> is relative to
+    // the top-left of the overlay.  Transparent pixels are not part of the
+    // overlay.
+    using Renderer = std::function<void(QImage *image, const QRect &docRect)>;
+
+    bool isEmpty() const
+    {
+        return m_tiles.isEmpty();
+    }
+
+    // Forgets all cached pixels.  Call this when the overlay changes.
+    void clear();
+
+    //
+    // Paints the parts of the overlay that are inside <docRect> onto
+    // <view>'s <painter>.  <overlayRect> is where the whole overlay is in
+    // the document.
+    //
+    // <render> is called for parts that are not cached yet.
+    //
+    void paint(QPainter *painter, const kpView *view, const QRect &overlayRect, const QRect &docRect, const Renderer &render);
+
+    // Same, but for an overlay described in view pixels: <overlayRect> and
+    // <viewRect> are in view coordinates.
+    void paintViewPixels(QPainter *painter, const QRect &overlayRect, const QRect &viewRect, const Renderer &render);
+
+private:
+    // <toView> maps a rectangle of the overlay's pixels, relative to the
+    // top-left of <overlayRect>, to <painter>.
+    void paint(QPainter *painter, const QRect &overlayRect, const QRect &rect, const Renderer &render, const std::function<QRect(const QRect &)> &toView);
+
+    struct Span {
+        QRect rect;
+        QRgb color;
+    };
+
+    const QList<Span> &tileSpans(const QPoint &tile, const QSize &overlaySize, const Renderer &render);
+
+    QHash<QPoint, QList<Span>> m_tiles;
+};
+
+#endif // kpViewOverlay_H
@@ -8,11 +8,18 @@
 #ifndef kpViewPrivate_H
 #define kpViewPrivate_H
 
+#include <QImage>
 #include <QPoint>
 #include <QPointer>
+#include <QPolygon>
 #include <QRect>
 #include <QRegion>
 
+#include "generic/kpDamageRegion.h"
+#include "views/kpViewOverlay.h"
+
+class QMetaObject;
+
 class kpDocument;
 class kpToolToolBar;
 class kpView;
@@ -46,7 +53,36 @@ struct kpViewPrivate {
     bool isBuddyViewScrollableContainerRectangleShown;
     QRect buddyViewScrollableContainerRectangle;
 
-    QRegion queuedUpdateArea;
+    // (bounded, so scattered updates e.g. from the spraycan stay cheap)
+    kpDamageRegion queuedUpdateArea;
+
+    // sync: kpView::paintEventDrawSelectionOverlays()
+    //
+    // The selection border, relative to the selection's top-left, and
+    // what it was rendered from.  This is independent of where the
+    // selection is, so moving a selection does not re-render its border.
+    kpViewOverlay selectionBorderOverlay;
+    const QMetaObject *selectionBorderOverlayType;
+    QPolygon selectionBorderOverlayPoints;
+    QSize selectionBorderOverlaySize;
+    bool selectionBorderOverlayFinished;
+
+    // The text cursor, for a cursor of this size (in document pixels).
+    kpViewOverlay textCursorOverlay;
+    QSize textCursorOverlaySize;
+
+    // The selection resize handles, in view pixels relative to the
+    // selection's view rectangle, and what they were rendered from.
+    kpViewOverlay selectionResizeHandlesOverlay;
+    QSize selectionResizeHandlesOverlaySize;
+    int selectionResizeHandlesOverlayZoomLevelX;
+    bool selectionResizeHandlesOverlayOneTextLine;
+
+    // The document, as painted at <textCursorUnderlayViewRect> without any
+    // overlays, so that a blink of the text cursor does not need the
+    // document to be recomposed.  Dropped by invalidateTextCursorUnderlay().
+    QImage textCursorUnderlay;
+    QRect textCursorUnderlayViewRect;
 };
 
 #endif // kpViewPrivate_H
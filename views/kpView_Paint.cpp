@@ -19,11 +19,14 @@
 #include "kpLogCategories.h"
 
 #include "document/kpDocument.h"
+#include "generic/kpProfiler.h"
 #include "imagelib/kpColor.h"
+#include "imagelib/kpResampler.h"
 #include "kpViewScrollableContainer.h"
 #include "layers/selections/kpAbstractSelection.h"
 #include "layers/selections/text/kpTextSelection.h"
 #include "layers/tempImage/kpTempImage.h"
+#include "pixmapfx/kpPixmapFX.h"
 #include "views/manager/kpViewManager.h"
 
 //---------------------------------------------------------------------
@@ -194,46 +197,97 @@ void kpView::paintEventDrawSelection(QImage *destPixmap, const QRect &docRect)
 #endif
     sel->paint(destPixmap, docRect);
 
+    // (the selection border and text cursor are drawn on top of the
+    //  view by paintEventDrawSelectionOverlays())
+}
+
+//---------------------------------------------------------------------
+
+// Returns the part of the text cursor that is drawn, regardless of whether
+// it is currently blinked off, or an empty rectangle if there is none.
+static QRect TextCursorDocRect(const kpViewManager *vm, const kpTextSelection *textSel)
+{
+    if (!textSel || !vm->textCursorEnabled()) {
+        return {};
+    }
+
+    // TODO: It would be nice to display the text cursor even if it's not
+    //       within the text box (this can happen if the text box is too
+    //       small for the text it contains).
+    //
+    //       However, too much selection repaint code assumes that it
+    //       only paints inside its kpAbstractSelection::boundingRect().
+    return vm->textCursorRect().intersected(textSel->textAreaRect());
+}
+
+//---------------------------------------------------------------------
+
+// protected
+void kpView::paintEventDrawSelectionOverlays(QPainter *painter, const QRegion &viewRegion)
+{
+    kpViewManager *vm = viewManager();
+    kpDocument *doc = document();
+    Q_ASSERT(vm && doc);
+
+    kpAbstractSelection *sel = doc->selection();
+    if (!sel) {
+        return;
+    }
+
     //
     // Draw selection border
     //
 
-    kpViewManager *vm = viewManager();
 #if DEBUG_KP_VIEW_RENDERER && 1 || 0
-    qCDebug(kpLogViews) << "\tsel border visible=" << vm->selectionBorderVisible();
+    qCDebug(kpLogViews) << "kpView::paintEventDrawSelectionOverlays() sel border visible=" << vm->selectionBorderVisible();
 #endif
     if (vm->selectionBorderVisible()) {
-        sel->paintBorder(destPixmap, docRect, vm->selectionBorderFinished());
+        const QRect selRect = sel->boundingRect();
+        const bool finished = vm->selectionBorderFinished();
+
+        // Only re-render the border if its shape has changed, not if the
+        // selection has merely moved.
+        const QPolygon points = sel->calculatePoints().translated(-selRect.topLeft());
+        if (sel->metaObject() != d->selectionBorderOverlayType || selRect.size() != d->selectionBorderOverlaySize
+            || finished != d->selectionBorderOverlayFinished || points != d->selectionBorderOverlayPoints) {
+            d->selectionBorderOverlay.clear();
+            d->selectionBorderOverlayType = sel->metaObject();
+            d->selectionBorderOverlaySize = selRect.size();
+            d->selectionBorderOverlayFinished = finished;
+            d->selectionBorderOverlayPoints = points;
+        }
+
+        const auto renderBorder = [sel, selRect, finished](QImage *image, const QRect &rect) {
+            sel->paintBorder(image, rect.translated(selRect.topLeft()), finished);
+        };
+        for (const QRect &r : viewRegion) {
+            d->selectionBorderOverlay.paint(painter, this, selRect, paintEventGetDocRect(r), renderBorder);
+        }
     }
 
     //
     // Draw text cursor
     //
 
-    // TODO: It would be nice to display the text cursor even if it's not
-    //       within the text box (this can happen if the text box is too
-    //       small for the text it contains).
-    //
-    //       However, too much selection repaint code assumes that it
-    //       only paints inside its kpAbstractSelection::boundingRect().
-    auto *textSel = dynamic_cast<kpTextSelection *>(sel);
-    if (textSel && vm->textCursorEnabled()
+    const QRect textCursorRect = ::TextCursorDocRect(vm, dynamic_cast<kpTextSelection *>(sel));
+    if (!textCursorRect.isEmpty()
         && (vm->textCursorBlinkState() ||
             // For the current main window:
             //     As long as _any_ view has focus, blink _all_ views not just the
             //     one with focus.
             !vm->hasAViewWithFocus())) // sync: call will break when vm is not held by 1 mainWindow
     {
-        QRect rect = vm->textCursorRect();
-        rect = rect.intersected(textSel->textAreaRect());
-        if (!rect.isEmpty()) {
-            kpPixmapFX::fillRect(destPixmap,
-                                 rect.x() - docRect.x(),
-                                 rect.y() - docRect.y(),
-                                 rect.width(),
-                                 rect.height(),
-                                 kpColor::LightGray,
-                                 kpColor::DarkGray);
+        if (textCursorRect.size() != d->textCursorOverlaySize) {
+            d->textCursorOverlay.clear();
+            d->textCursorOverlaySize = textCursorRect.size();
+        }
+
+        const QSize size = textCursorRect.size();
+        const auto renderTextCursor = [size](QImage *image, const QRect &rect) {
+            kpPixmapFX::fillRect(image, -rect.x(), -rect.y(), size.width(), size.height(), kpColor::LightGray, kpColor::DarkGray);
+        };
+        for (const QRect &r : viewRegion) {
+            d->textCursorOverlay.paint(painter, this, textCursorRect, paintEventGetDocRect(r), renderTextCursor);
         }
     }
 }
@@ -241,10 +295,10 @@ void kpView::paintEventDrawSelection(QImage *destPixmap, const QRect &docRect)
 //---------------------------------------------------------------------
 
 // protected
-void kpView::paintEventDrawSelectionResizeHandles(const QRect &clipRect)
+void kpView::paintEventDrawSelectionResizeHandles(QPainter *painter, const QRegion &viewRegion)
 {
 #if DEBUG_KP_VIEW_RENDERER && 1
-    qCDebug(kpLogViews) << "kpView::paintEventDrawSelectionResizeHandles(" << clipRect << ")";
+    qCDebug(kpLogViews) << "kpView::paintEventDrawSelectionResizeHandles(" << viewRegion.boundingRect() << ")";
 #endif
 
     if (!selectionLargeEnoughToHaveResizeHandles()) {
@@ -267,24 +321,42 @@ void kpView::paintEventDrawSelectionResizeHandles(const QRect &clipRect)
 #if DEBUG_KP_VIEW_RENDERER && 1
     qCDebug(kpLogViews) << "\tselViewRect=" << selViewRect;
 #endif
-    if (!selViewRect.intersects(clipRect)) {
+    if (!viewRegion.intersects(selViewRect)) {
 #if DEBUG_KP_VIEW_RENDERER && 1
-        qCDebug(kpLogViews) << "\tdoesn't intersect viewRect";
+        qCDebug(kpLogViews) << "\tdoesn't intersect viewRegion";
 #endif
         return;
     }
 
-    QRegion selResizeHandlesRegion = selectionResizeHandlesViewRegion(true /*for renderer*/);
+    // Only re-render the handles if something they are laid out from has
+    // changed (sync: selectionResizeHandlesViewRegion()), not if the
+    // selection has merely moved.
+    const bool oneTextLine = (textSelection() && textSelection()->textLines().size() == 1);
+    if (selViewRect.size() != d->selectionResizeHandlesOverlaySize || zoomLevelX() != d->selectionResizeHandlesOverlayZoomLevelX
+        || oneTextLine != d->selectionResizeHandlesOverlayOneTextLine) {
+        d->selectionResizeHandlesOverlay.clear();
+        d->selectionResizeHandlesOverlaySize = selViewRect.size();
+        d->selectionResizeHandlesOverlayZoomLevelX = zoomLevelX();
+        d->selectionResizeHandlesOverlayOneTextLine = oneTextLine;
+    }
+
+    const auto renderHandles = [this, selViewRect](QImage *image, const QRect &rect) {
+        const QRegion selResizeHandlesRegion = selectionResizeHandlesViewRegion(true /*for renderer*/).translated(-selViewRect.topLeft());
 #if DEBUG_KP_VIEW_RENDERER && 1
-    qCDebug(kpLogViews) << "\tsel resize handles view region=" << selResizeHandlesRegion << endl;
+        qCDebug(kpLogViews) << "\tsel resize handles view region=" << selResizeHandlesRegion;
 #endif
 
-    QPainter painter(this);
-    painter.setPen(Qt::black);
-    painter.setBrush(Qt::cyan);
+        QPainter painter(image);
+        painter.translate(-rect.topLeft());
+        painter.setPen(Qt::black);
+        painter.setBrush(Qt::cyan);
 
-    for (const QRect &r : selResizeHandlesRegion)
-        painter.drawRect(r);
+        for (const QRect &r : selResizeHandlesRegion)
+            painter.drawRect(r);
+    };
+    for (const QRect &r : viewRegion) {
+        d->selectionResizeHandlesOverlay.paintViewPixels(painter, selViewRect, r, renderHandles);
+    }
 }
 
 //---------------------------------------------------------------------
@@ -342,6 +414,47 @@ void kpView::paintEventDrawGridLines(QPainter *painter, const QRect &viewRect)
 
 //---------------------------------------------------------------------
 
+// protected
+bool kpView::paintEventUsesIntegerUpscaler() const
+{
+    // (at 100%, drawImage() is already a plain blit)
+    return (zoomLevelX() % 100 == 0 && zoomLevelY() % 100 == 0 && (zoomLevelX() > 100 || zoomLevelY() > 100));
+}
+
+//---------------------------------------------------------------------
+
+// protected virtual
+bool kpView::paintEventUsesSmoothDownscaler() const
+{
+    return false;
+}
+
+//---------------------------------------------------------------------
+
+// Returns <docRect> grown by however far the adjustments of <doc> read
+// around it, when they are applied to the document shrunk to <view>'s zoom
+// level (sync: kpView::paintEventDrawDoc_Unclipped()).
+static QRect ShrunkAdjustmentsDocRect(const kpView *view, const kpDocument *doc, const QRect &docRect)
+{
+    int margin = 0;
+    for (const kpAdjustment &adjustment : doc->adjustments()) {
+        // (can only be applied to the whole image)
+        if (adjustment.margin < 0) {
+            return doc->rect();
+        }
+
+        margin += adjustment.margin;
+    }
+
+    // (<margin> is in view pixels)
+    const int marginX = (margin * 100 + view->zoomLevelX() - 1) / view->zoomLevelX();
+    const int marginY = (margin * 100 + view->zoomLevelY() - 1) / view->zoomLevelY();
+
+    return docRect.adjusted(-marginX, -marginY, marginX, marginY).intersected(doc->rect());
+}
+
+//---------------------------------------------------------------------
+
 // This is called "_Unclipped" because it may draw outside of
 // <viewRect>.
 //
@@ -371,7 +484,7 @@ void kpView::paintEventDrawGridLines(QPainter *painter, const QRect &viewRect)
 // This over-drawing is only safe from Qt's perspective since Qt
 // automatically clips all drawing in paintEvent() (which calls us) to
 // QPaintEvent::region().
-void kpView::paintEventDrawDoc_Unclipped(const QRect &viewRect)
+void kpView::paintEventDrawDoc_Unclipped(QPainter *painter, const QRect &viewRect)
 {
 #if DEBUG_KP_VIEW_RENDERER
     QTime timer;
@@ -391,19 +504,29 @@ void kpView::paintEventDrawDoc_Unclipped(const QRect &viewRect)
 
     QRect docRect = paintEventGetDocRect(viewRect);
 
+    // A view that shrinks the document (i.e. the thumbnail) applies the
+    // adjustments to the shrunk document, instead of evaluating them over
+    // the whole document at full size.  This only approximates adjustments
+    // that read nearby pixels, and also adjusts the selection and the temp
+    // image, which is good enough for a thumbnail.
+    const bool adjustShrunk = (paintEventUsesSmoothDownscaler() && !doc->adjustments().isEmpty());
+    if (adjustShrunk) {
+        // (the extra pixels are clipped away by the painter)
+        docRect = ::ShrunkAdjustmentsDocRect(this, doc, docRect);
+    }
+
 #if DEBUG_KP_VIEW_RENDERER && 1
     qCDebug(kpLogViews) << "\tdocRect=" << docRect;
 #endif
 
-    QPainter painter(this);
-    // painter.setCompositionMode(QPainter::CompositionMode_Source);
-
     QImage docPixmap;
     bool tempImageWillBeRendered = false;
 
     // LOTODO: I think <docRect> being empty would be a bug.
     if (!docRect.isEmpty()) {
-        docPixmap = doc->getImageAt(docRect);
+        // (the selection and the temp image are drawn on top unadjusted, until
+        //  they are pushed onto the document)
+        docPixmap = adjustShrunk ? doc->getImageAt(docRect) : doc->getAdjustedImageAt(docRect);
 
 #if DEBUG_KP_VIEW_RENDERER && 1
         qCDebug(kpLogViews) << "\tdocPixmap.hasAlphaChannel()=" << docPixmap.hasAlphaChannel();
@@ -423,7 +546,7 @@ void kpView::paintEventDrawDoc_Unclipped(const QRect &viewRect)
     //
 
     if (docPixmap.hasAlphaChannel() || (tempImageWillBeRendered && vm->tempImage()->paintMayAddMask())) {
-        paintEventDrawCheckerBoard(&painter, viewRect);
+        paintEventDrawCheckerBoard(painter, viewRect);
     }
 
     if (!docRect.isEmpty()) {
@@ -445,11 +568,38 @@ void kpView::paintEventDrawDoc_Unclipped(const QRect &viewRect)
         QTime scaleTimer;
         scaleTimer.start();
 #endif
-        // This is the only troublesome part of the method that draws unclipped.
-        painter.translate(origin().x(), origin().y());
-        painter.scale(double(zoomLevelX()) / 100.0, double(zoomLevelY()) / 100.0);
-        painter.drawImage(docRect, docPixmap);
-        // painter.resetMatrix ();  // back to 1-1 scaling
+        if (paintEventUsesIntegerUpscaler()) {
+            // Expand each document pixel into a block ourselves, drawing the
+            // grid lines (if any) in the same pass, and then do a plain 1-1
+            // blit.  This is much cheaper than a transformed drawImage()
+            // followed by a drawLine() for every row and column of pixels.
+            //
+            // This draws unclipped too, but that is harmless for the grid
+            // since the grid lines are now part of the document pixels
+            // drawn.
+            const QImage zoomedPixmap = kpPixmapFX::scaleIntegerNearest(docPixmap,
+                                                                        zoomLevelX() / 100,
+                                                                        zoomLevelY() / 100,
+                                                                        isGridShown() ? QColor(Qt::gray) : QColor());
+            painter->drawImage(transformDocToView(docRect.topLeft()), zoomedPixmap);
+        } else if (paintEventUsesSmoothDownscaler() && !transformDocToView(docRect).isEmpty()) {
+            // Shrink with a box filter ourselves: the painter's smooth
+            // transform only blends the nearest few document pixels, so
+            // that detail flickers in and out of a small view.
+            const QRect viewDocRect = transformDocToView(docRect);
+            QImage shrunkPixmap = kpResampler::scale(docPixmap, viewDocRect.width(), viewDocRect.height(), kpResampler::Box);
+            if (adjustShrunk) {
+                shrunkPixmap = kpAdjustmentStack::Flatten(shrunkPixmap, doc->adjustments());
+            }
+            painter->drawImage(viewDocRect.topLeft(), shrunkPixmap);
+        } else {
+            // This is the only troublesome part of the method that draws unclipped.
+            painter->save();
+            painter->translate(origin().x(), origin().y());
+            painter->scale(double(zoomLevelX()) / 100.0, double(zoomLevelY()) / 100.0);
+            painter->drawImage(docRect, docPixmap);
+            painter->restore(); // back to 1-1 scaling
+        }
 #if DEBUG_KP_VIEW_RENDERER && 1
         qCDebug(kpLogViews) << "\tscale time=" << scaleTimer.elapsed();
 #endif
@@ -463,6 +613,40 @@ void kpView::paintEventDrawDoc_Unclipped(const QRect &viewRect)
 
 //---------------------------------------------------------------------
 
+// protected
+const QImage &kpView::paintEventTextCursorUnderlay(const QRect &viewRect)
+{
+    if (!d->textCursorUnderlay.isNull() && d->textCursorUnderlayViewRect == viewRect) {
+        return d->textCursorUnderlay;
+    }
+
+#if DEBUG_KP_VIEW_RENDERER && 1
+    qCDebug(kpLogViews) << "kpView::paintEventTextCursorUnderlay(" << viewRect << ") - rendering";
+#endif
+
+    QImage underlay(viewRect.size(), QImage::Format_ARGB32_Premultiplied);
+    underlay.fill(0);
+    {
+        QPainter painter(&underlay);
+        painter.translate(-viewRect.x(), -viewRect.y());
+
+        // (clipped to <underlay> so safe)
+        paintEventDrawDoc_Unclipped(&painter, viewRect);
+
+        // sync: paintEvent()
+        if (isGridShown() && !paintEventUsesIntegerUpscaler()) {
+            paintEventDrawGridLines(&painter, viewRect);
+        }
+    }
+
+    d->textCursorUnderlay = underlay;
+    d->textCursorUnderlayViewRect = viewRect;
+
+    return d->textCursorUnderlay;
+}
+
+//---------------------------------------------------------------------
+
 // protected virtual [base QWidget]
 void kpView::paintEvent(QPaintEvent *e)
 {
@@ -499,49 +683,94 @@ void kpView::paintEvent(QPaintEvent *e)
         return;
     }
 
+    kpProfilerScope profilerScope(kpProfiler::Paint, "kpView::paintEvent");
+
     // It seems that e->region() is already clipped by Qt to the visible
     // part of the view (which could be quite small inside a scrollview).
     const QRegion viewRegion = e->region();
 
-    // Draw all the requested regions of the document _before_ drawing
-    // the grid lines, buddy rectangle and selection resize handles.
-    // This ordering is important since paintEventDrawDoc_Unclipped()
-    // may draw outside of the view rectangle passed to it.
-    //
-    // To illustrate this, suppose we changed each iteration of the loop
-    // to call paintEventDrawDoc_Unclipped() _and_ then,
-    // paintEventDrawGridLines().  If there are 2 or more iterations of this
-    // loop, paintEventDrawDoc_Unclipped() in one iteration may draw over
-    // parts of nearby grid lines (which were drawn in a previous iteration)
-    // with document pixels.  Those grid line parts are probably not going to
-    // be redrawn, so will appear to be missing.
-    for (const QRect &r : viewRegion)
-        paintEventDrawDoc_Unclipped(r);
+    if (profilerScope.isActive()) {
+        for (const QRect &r : viewRegion) {
+            profilerScope.addPixels(qint64(r.width()) * r.height());
+        }
+    }
 
+    // A blink of the text cursor (see kpViewManager::updateTextCursor())
+    // repaints just the area around it.  Redraw that from the cached
+    // document pixels under it, rather than recomposing the document.
     //
-    // Draw Grid Lines
-    //
-
-    if (isGridShown()) {
-        QPainter painter(this);
-        for (const QRect &r : viewRegion)
-            paintEventDrawGridLines(&painter, r);
+    // (sync: kpViewManager::updateViews() pads the area like this)
+    QRect textCursorViewRect;
+    const QRect textCursorDocRect = ::TextCursorDocRect(vm, textSelection());
+    if (!textCursorDocRect.isEmpty()) {
+        textCursorViewRect = transformDocToView(textCursorDocRect);
+        if (zoomLevelX() % 100 || zoomLevelY() % 100) {
+            const int diffX = qRound(double(zoomLevelX()) / 100.0) + 1;
+            const int diffY = qRound(double(zoomLevelY()) / 100.0) + 1;
+            textCursorViewRect.adjust(-diffX, -diffY, diffX, diffY);
+        }
+        textCursorViewRect = textCursorViewRect.intersected(rect());
     }
+    const bool onlyTextCursor = (!textCursorViewRect.isEmpty() && buddyViewScrollableContainerRectangle().isEmpty()
+                                 && viewRegion.subtracted(QRegion(textCursorViewRect)).isEmpty());
 
-    const QRect r = buddyViewScrollableContainerRectangle();
-    if (!r.isEmpty()) {
+#if DEBUG_KP_VIEW_RENDERER && 1
+    qCDebug(kpLogViews) << "\ttextCursorViewRect=" << textCursorViewRect << " onlyTextCursor=" << onlyTextCursor;
+#endif
+
+    {
         QPainter painter(this);
 
-        painter.setPen(QPen(Qt::lightGray, 1 /*width*/, Qt::DotLine));
-        painter.setBackground(Qt::darkGray);
-        painter.setBackgroundMode(Qt::OpaqueMode);
+        if (onlyTextCursor) {
+            painter.drawImage(textCursorViewRect.topLeft(), paintEventTextCursorUnderlay(textCursorViewRect));
+        } else {
+            // Draw all the requested regions of the document _before_ drawing
+            // the grid lines, overlays, buddy rectangle and selection resize
+            // handles.  This ordering is important since
+            // paintEventDrawDoc_Unclipped() may draw outside of the view
+            // rectangle passed to it.
+            //
+            // To illustrate this, suppose we changed each iteration of the loop
+            // to call paintEventDrawDoc_Unclipped() _and_ then,
+            // paintEventDrawGridLines().  If there are 2 or more iterations of this
+            // loop, paintEventDrawDoc_Unclipped() in one iteration may draw over
+            // parts of nearby grid lines (which were drawn in a previous iteration)
+            // with document pixels.  Those grid line parts are probably not going to
+            // be redrawn, so will appear to be missing.
+            for (const QRect &r : viewRegion)
+                paintEventDrawDoc_Unclipped(&painter, r);
+
+            //
+            // Draw Grid Lines
+            //
+
+            // (already drawn by paintEventDrawDoc_Unclipped() if it used the integer
+            //  upscaler)
+            if (isGridShown() && !paintEventUsesIntegerUpscaler()) {
+                for (const QRect &r : viewRegion)
+                    paintEventDrawGridLines(&painter, r);
+            }
+        }
 
-        painter.drawRect(r.x(), r.y(), r.width() - 1, r.height() - 1);
-    }
+        paintEventDrawSelectionOverlays(&painter, viewRegion);
+
+        const QRect r = buddyViewScrollableContainerRectangle();
+        if (!r.isEmpty()) {
+            painter.save();
 
-    if (doc->selection()) {
-        // Draw resize handles on top of possible grid lines
-        paintEventDrawSelectionResizeHandles(e->rect());
+            painter.setPen(QPen(Qt::lightGray, 1 /*width*/, Qt::DotLine));
+            painter.setBackground(Qt::darkGray);
+            painter.setBackgroundMode(Qt::OpaqueMode);
+
+            painter.drawRect(r.x(), r.y(), r.width() - 1, r.height() - 1);
+
+            painter.restore();
+        }
+
+        if (doc->selection()) {
+            // Draw resize handles on top of possible grid lines
+            paintEventDrawSelectionResizeHandles(&painter, viewRegion);
+        }
     }
 
 #if DEBUG_KP_VIEW_RENDERER && 1
@@ -179,6 +179,26 @@ bool kpViewManager::hasAViewWithFocus() const
 
 //---------------------------------------------------------------------
 
+// public
+QRect kpViewManager::visibleDocumentRect() const
+{
+    QRect docRect;
+
+    for (kpView *view : std::as_const(d->views)) {
+        // Skip the thumbnail, which shows the whole document.
+        if (view->buddyView() || !view->isVisible()) {
+            continue;
+        }
+
+        // (a pixel extra on each side, in case of rounding when zoomed)
+        docRect |= view->transformViewToDoc(view->visibleRegion().boundingRect()).adjusted(-1, -1, 1, 1);
+    }
+
+    return document() ? docRect & document()->rect() : docRect;
+}
+
+//---------------------------------------------------------------------
+
 // public
 void kpViewManager::setCursor(const QCursor &cursor)
 {
@@ -273,8 +293,9 @@ void kpViewManager::setSelectionBorderVisible(bool yes)
 
     d->selectionBorderVisible = yes;
 
+    // (the border and resize handles are drawn on top of the document)
     if (document()->selection()) {
-        updateViews(document()->selection()->boundingRect());
+        updateViewsOverlay(document()->selection()->boundingRect());
     }
 }
 
@@ -297,8 +318,9 @@ void kpViewManager::setSelectionBorderFinished(bool yes)
 
     d->selectionBorderFinished = yes;
 
+    // (the border and resize handles are drawn on top of the document)
     if (document()->selection()) {
-        updateViews(document()->selection()->boundingRect());
+        updateViewsOverlay(document()->selection()->boundingRect());
     }
 }
 
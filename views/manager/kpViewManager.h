@@ -71,6 +71,10 @@ public:
     // have focus at the same time (see QWidget::isActiveWindow()).
     bool hasAViewWithFocus() const;
 
+    // Returns the part of the document that can currently be seen in the
+    // views (not counting the thumbnail), or an empty rectangle if none.
+    QRect visibleDocumentRect() const;
+
     //
     // Mouse Cursors
     //
@@ -206,6 +210,19 @@ public Q_SLOTS:
 
     void updateViews(const QRect &docRect);
 
+public:
+    // Repaints <docRect> in all views immediately, even inside a
+    // setQueueUpdates() block (whose queued areas are left alone, to be
+    // repainted again by restoreQueueUpdates()).  Use this to show
+    // progress during a long, non-interactive change to the document.
+    void repaintViewsNow(const QRect &docRect);
+
+protected:
+    // Like updateViews() but for when only what is drawn on top of the
+    // document has changed (e.g. the text cursor has blinked), so that
+    // views can repaint <docRect> without recomposing the document.
+    void updateViewsOverlay(const QRect &docRect);
+
 public Q_SLOTS:
     void adjustViewsToEnvironment();
 
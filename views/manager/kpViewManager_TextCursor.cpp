@@ -176,7 +176,7 @@ void kpViewManager::updateTextCursor()
     setFastUpdates();
     {
         // If !textCursorEnabled(), this will clear.
-        updateViews(r);
+        updateViewsOverlay(r);
     }
     restoreFastUpdates();
 }
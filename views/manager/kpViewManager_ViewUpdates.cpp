@@ -13,6 +13,7 @@
 #include "kpLogCategories.h"
 
 #include "document/kpDocument.h"
+#include "generic/kpDamageRegion.h"
 #include "kpDefs.h"
 #include "layers/selections/text/kpTextSelection.h"
 #include "layers/tempImage/kpTempImage.h"
@@ -88,6 +89,8 @@ void kpViewManager::updateView(kpView *v)
 // public slot
 void kpViewManager::updateView(kpView *v, const QRect &viewRect)
 {
+    v->invalidateTextCursorUnderlay(viewRect);
+
     if (!queueUpdates()) {
         if (fastUpdates()) {
             v->repaint(viewRect);
@@ -108,11 +111,19 @@ void kpViewManager::updateView(kpView *v, int x, int y, int w, int h)
 // public slot
 void kpViewManager::updateView(kpView *v, const QRegion &viewRegion)
 {
+    v->invalidateTextCursorUnderlay(viewRegion);
+
     if (!queueUpdates()) {
         if (fastUpdates()) {
             v->repaint(viewRegion);
         } else {
-            v->update(viewRegion.boundingRect());
+            // Pass on the actual rectangles, rather than their bounding
+            // rectangle, so that 2 small changes far apart don't repaint
+            // everything in between - but not so many that Qt gets bogged
+            // down.
+            kpDamageRegion damage;
+            damage.add(viewRegion);
+            v->update(damage.region());
         }
     } else {
         v->addToQueuedArea(viewRegion);
@@ -145,6 +156,32 @@ void kpViewManager::updateViewRectangleEdges(kpView *v, const QRect &viewRect)
     }
 }
 
+// Returns the area of <view> to repaint when <docRect> changes.
+static QRect UpdateViewRect(const kpView *view, const QRect &docRect)
+{
+    if (view->zoomLevelX() % 100 == 0 && view->zoomLevelY() % 100 == 0) {
+#if DEBUG_KP_VIEW_MANAGER && 0
+        qCDebug(kpLogViews) << "\t\tviewRect=" << view->transformDocToView(docRect);
+#endif
+        return view->transformDocToView(docRect);
+    }
+
+    QRect viewRect = view->transformDocToView(docRect);
+
+    // Compensate for rounding by a document pixel in each direction.
+    // (sync: kpView::paintEvent())
+    const int diffX = qRound(double(view->zoomLevelX()) / 100.0) + 1;
+    const int diffY = qRound(double(view->zoomLevelY()) / 100.0) + 1;
+
+    QRect newRect = QRect(viewRect.x() - diffX, viewRect.y() - diffY, viewRect.width() + 2 * diffX, viewRect.height() + 2 * diffY)
+                        .intersected(QRect(0, 0, view->width(), view->height()));
+
+#if DEBUG_KP_VIEW_MANAGER && 0
+    qCDebug(kpLogViews) << "\t\tviewRect (+compensate)=" << newRect;
+#endif
+    return newRect;
+}
+
 // public slot
 void kpViewManager::updateViews(const QRect &docRect)
 {
@@ -156,23 +193,53 @@ void kpViewManager::updateViews(const QRect &docRect)
 #if DEBUG_KP_VIEW_MANAGER && 0
         qCDebug(kpLogViews) << "\tupdating view " << view->name();
 #endif
-        if (view->zoomLevelX() % 100 == 0 && view->zoomLevelY() % 100 == 0) {
+        updateView(view, ::UpdateViewRect(view, docRect));
+    }
+}
+
+// public
+void kpViewManager::repaintViewsNow(const QRect &docRect)
+{
 #if DEBUG_KP_VIEW_MANAGER && 0
-            qCDebug(kpLogViews) << "\t\tviewRect=" << view->transformDocToView(docRect);
+    qCDebug(kpLogViews) << "kpViewManager::repaintViewsNow (" << docRect << ")";
 #endif
-            updateView(view, view->transformDocToView(docRect));
-        } else {
-            QRect viewRect = view->transformDocToView(docRect);
 
-            int diff = qRound(double(qMax(view->zoomLevelX(), view->zoomLevelY())) / 100.0) + 1;
+    // kpView::paintEvent() queues instead of painting while updates are
+    // queued.
+    const int queueUpdatesCounter = d->queueUpdatesCounter;
+    d->queueUpdatesCounter = 0;
+
+    for (kpView *view : std::as_const(d->views)) {
+        const QRect viewRect = ::UpdateViewRect(view, docRect);
+
+        view->invalidateTextCursorUnderlay(viewRect);
+        view->repaint(viewRect);
+    }
 
-            QRect newRect = QRect(viewRect.x() - diff, viewRect.y() - diff, viewRect.width() + 2 * diff, viewRect.height() + 2 * diff)
-                                .intersected(QRect(0, 0, view->width(), view->height()));
+    d->queueUpdatesCounter = queueUpdatesCounter;
+}
 
+// protected
+void kpViewManager::updateViewsOverlay(const QRect &docRect)
+{
 #if DEBUG_KP_VIEW_MANAGER && 0
-            qCDebug(kpLogViews) << "\t\tviewRect (+compensate)=" << newRect;
+    qCDebug(kpLogViews) << "kpViewManager::updateViewsOverlay (" << docRect << ")";
 #endif
-            updateView(view, newRect);
+
+    for (kpView *view : std::as_const(d->views)) {
+        const QRect viewRect = ::UpdateViewRect(view, docRect);
+
+        // Same as updateView() but without telling the view that the
+        // document has changed, so that it may repaint from its caches.
+        if (!queueUpdates()) {
+            if (fastUpdates()) {
+                view->repaint(viewRect);
+            } else {
+                view->update(viewRect);
+            }
+        } else {
+            // (the queued area is later updated with updateView())
+            view->addToQueuedArea(viewRect);
         }
     }
 }
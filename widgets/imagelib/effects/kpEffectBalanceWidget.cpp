@@ -138,6 +138,27 @@ kpEffectCommandBase *kpEffectBalanceWidget::createCommand(kpCommandEnvironment *
     return new kpEffectBalanceCommand(channels(), brightness(), contrast(), gamma(), m_actOnSelection, cmdEnviron);
 }
 
+// public virtual [base kpEffectWidgetBase]
+QVariantList kpEffectBalanceWidget::settings() const
+{
+    return {m_channelsComboBox->currentIndex(), brightness(), contrast(), gamma()};
+}
+
+// public virtual [base kpEffectWidgetBase]
+void kpEffectBalanceWidget::setSettings(const QVariantList &settings)
+{
+    if (settings.size() != 4) {
+        return;
+    }
+
+    m_channelsComboBox->setCurrentIndex(settings[0].toInt());
+    m_brightnessInput->setValue(settings[1].toInt());
+    m_contrastInput->setValue(settings[2].toInt());
+    m_gammaInput->setValue(settings[3].toInt());
+
+    recalculateGammaLabel();
+}
+
 // protected
 int kpEffectBalanceWidget::channels() const
 {
@@ -31,6 +31,9 @@ public:
 
     kpEffectCommandBase *createCommand(kpCommandEnvironment *cmdEnviron) const override;
 
+    QVariantList settings() const override;
+    void setSettings(const QVariantList &settings) override;
+
 protected:
     int channels() const;
 
@@ -100,6 +100,23 @@ kpEffectCommandBase *kpEffectBlurSharpenWidget::createCommand(kpCommandEnvironme
     return new kpEffectBlurSharpenCommand(type(), strength(), m_actOnSelection, cmdEnviron);
 }
 
+// public virtual [base kpEffectWidgetBase]
+QVariantList kpEffectBlurSharpenWidget::settings() const
+{
+    return {m_amountInput->value()};
+}
+
+// public virtual [base kpEffectWidgetBase]
+void kpEffectBlurSharpenWidget::setSettings(const QVariantList &settings)
+{
+    if (settings.size() != 1) {
+        return;
+    }
+
+    // (also updates <m_typeLabel>)
+    m_amountInput->setValue(settings[0].toInt());
+}
+
 // protected slot
 void kpEffectBlurSharpenWidget::slotUpdateTypeLabel()
 {
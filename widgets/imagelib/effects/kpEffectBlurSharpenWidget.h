@@ -32,6 +32,9 @@ public:
 
     kpEffectCommandBase *createCommand(kpCommandEnvironment *cmdEnviron) const override;
 
+    QVariantList settings() const override;
+    void setSettings(const QVariantList &settings) override;
+
 protected Q_SLOTS:
     void slotUpdateTypeLabel();
 
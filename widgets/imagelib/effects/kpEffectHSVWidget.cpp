@@ -84,4 +84,22 @@ kpEffectCommandBase *kpEffectHSVWidget::createCommand(kpCommandEnvironment *cmdE
     return new kpEffectHSVCommand(m_hueInput->value(), m_saturationInput->value(), m_valueInput->value(), m_actOnSelection, cmdEnviron);
 }
 
+// public virtual [base kpEffectWidgetBase]
+QVariantList kpEffectHSVWidget::settings() const
+{
+    return {m_hueInput->value(), m_saturationInput->value(), m_valueInput->value()};
+}
+
+// public virtual [base kpEffectWidgetBase]
+void kpEffectHSVWidget::setSettings(const QVariantList &settings)
+{
+    if (settings.size() != 3) {
+        return;
+    }
+
+    m_hueInput->setValue(settings[0].toDouble());
+    m_saturationInput->setValue(settings[1].toDouble());
+    m_valueInput->setValue(settings[2].toDouble());
+}
+
 #include "moc_kpEffectHSVWidget.cpp"
@@ -28,6 +28,9 @@ public:
 
     kpEffectCommandBase *createCommand(kpCommandEnvironment *cmdEnviron) const override;
 
+    QVariantList settings() const override;
+    void setSettings(const QVariantList &settings) override;
+
 protected:
     kpDoubleNumInput *m_hueInput;
     kpDoubleNumInput *m_saturationInput;
@@ -123,6 +123,27 @@ kpEffectCommandBase *kpEffectInvertWidget::createCommand(kpCommandEnvironment *c
     return new kpEffectInvertCommand(channels(), m_actOnSelection, cmdEnviron);
 }
 
+// public virtual [base kpEffectWidgetBase]
+QVariantList kpEffectInvertWidget::settings() const
+{
+    return {channels()};
+}
+
+// public virtual [base kpEffectWidgetBase]
+void kpEffectInvertWidget::setSettings(const QVariantList &settings)
+{
+    if (settings.size() != 1) {
+        return;
+    }
+
+    const int channels = settings[0].toInt();
+
+    // (slotRGBCheckBoxToggled() keeps <m_allCheckBox> in sync)
+    m_redCheckBox->setChecked(channels & kpEffectInvert::Red);
+    m_greenCheckBox->setChecked(channels & kpEffectInvert::Green);
+    m_blueCheckBox->setChecked(channels & kpEffectInvert::Blue);
+}
+
 // protected slots
 void kpEffectInvertWidget::slotRGBCheckBoxToggled()
 {
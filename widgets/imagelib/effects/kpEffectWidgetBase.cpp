@@ -21,4 +21,16 @@ QString kpEffectWidgetBase::caption() const
     return {};
 }
 
+// public virtual
+QVariantList kpEffectWidgetBase::settings() const
+{
+    return {};
+}
+
+// public virtual
+void kpEffectWidgetBase::setSettings(const QVariantList &settings)
+{
+    Q_UNUSED(settings)
+}
+
 #include "moc_kpEffectWidgetBase.cpp"
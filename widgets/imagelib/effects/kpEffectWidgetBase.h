@@ -8,6 +8,7 @@
 #ifndef kpEffectWidgetBase_H
 #define kpEffectWidgetBase_H
 
+#include <QVariantList>
 #include <QWidget>
 
 #include "imagelib/kpImage.h"
@@ -40,6 +41,12 @@ public:
 
     virtual kpEffectCommandBase *createCommand(kpCommandEnvironment *cmdEnviron) const = 0;
 
+    // The values of the controls, so that they can be restored later with
+    // setSettings() (e.g. to edit an adjustment).  Widgets that do not
+    // implement this return an empty list.
+    virtual QVariantList settings() const;
+    virtual void setSettings(const QVariantList &settings);
+
 protected:
     bool m_actOnSelection;
 };
@@ -0,0 +1,112 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "widgets/kpProfilerOverlay.h"
+
+#include <QFontDatabase>
+#include <QTimer>
+
+#include <KLocalizedString>
+
+#include "generic/kpProfiler.h"
+
+//---------------------------------------------------------------------
+
+namespace
+{
+const int UpdateIntervalMsecs = 250;
+
+QString FormatMsecs(qint64 nsecs)
+{
+    return QString::number(double(nsecs) / 1000000.0, 'f', 2);
+}
+
+QString EventText(kpProfiler::Category category, const QString &label)
+{
+    kpProfiler::Event event;
+    if (!kpProfiler::lastEvent(category, &event)) {
+        return i18nc("@info performance overlay, %1 = e.g. \"Frame\"", "%1: -", label);
+    }
+
+    const QString what = event.detail.isEmpty() ? QString::fromLatin1(event.name) : event.detail;
+
+    return i18nc("@info performance overlay",
+                 "%1: %2 ms, %3 px, %4 copies (%5)",
+                 label,
+                 FormatMsecs(event.durationNsecs),
+                 event.pixels,
+                 event.copies,
+                 what);
+}
+} // namespace
+
+//---------------------------------------------------------------------
+
+kpProfilerOverlay::kpProfilerOverlay(QWidget *parent)
+    : QLabel(parent)
+    , m_updateTimer(new QTimer(this))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setTextFormat(Qt::PlainText);
+    setMargin(4);
+
+    setAutoFillBackground(true);
+    setBackgroundRole(QPalette::ToolTipBase);
+    setForegroundRole(QPalette::ToolTipText);
+
+    m_updateTimer->setInterval(UpdateIntervalMsecs);
+    connect(m_updateTimer, &QTimer::timeout, this, &kpProfilerOverlay::updateText);
+
+    move(0, 0);
+    hide();
+}
+
+//---------------------------------------------------------------------
+
+// protected virtual [base QWidget]
+void kpProfilerOverlay::showEvent(QShowEvent *e)
+{
+    updateText();
+    m_updateTimer->start();
+
+    QLabel::showEvent(e);
+}
+
+//---------------------------------------------------------------------
+
+// protected virtual [base QWidget]
+void kpProfilerOverlay::hideEvent(QHideEvent *e)
+{
+    m_updateTimer->stop();
+
+    QLabel::hideEvent(e);
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpProfilerOverlay::updateText()
+{
+    const QStringList lines = {EventText(kpProfiler::Paint, i18nc("@info performance overlay", "Frame")),
+                               EventText(kpProfiler::ToolDraw, i18nc("@info performance overlay", "Tool")),
+                               EventText(kpProfiler::CommandExecute, i18nc("@info performance overlay", "Do")),
+                               EventText(kpProfiler::CommandUnexecute, i18nc("@info performance overlay", "Undo")),
+                               EventText(kpProfiler::Effect, i18nc("@info performance overlay", "Effect"))};
+
+    const QString newText = lines.join(QLatin1Char('\n'));
+    if (newText != text()) {
+        setText(newText);
+        adjustSize();
+        raise();
+    }
+}
+
+//---------------------------------------------------------------------
+
+#include "moc_kpProfilerOverlay.cpp"
@@ -0,0 +1,42 @@
+/*
+   SPDX-FileCopyrightText: 2026 The KolourPaint Developers
+
+   SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef kpProfilerOverlay_H
+#define kpProfilerOverlay_H
+
+#include <QLabel>
+
+class QTimer;
+
+//
+// Small, read-only panel that sits in the top-left corner of its parent
+// (normally the main window's scroll view) and shows the most recent
+// kpProfiler events: the last frame time, pixels touched and image copies
+// made, as well as the last tool draw, command and effect.
+//
+// The panel polls kpProfiler a few times a second while visible, rather
+// than being notified of every event, so that it does not itself cause
+// extra repaints of the canvas.
+//
+class kpProfilerOverlay : public QLabel
+{
+    Q_OBJECT
+
+public:
+    explicit kpProfilerOverlay(QWidget *parent);
+
+protected:
+    void showEvent(QShowEvent *e) override;
+    void hideEvent(QHideEvent *e) override;
+
+private Q_SLOTS:
+    void updateText();
+
+private:
+    QTimer *m_updateTimer;
+};
+
+#endif // kpProfilerOverlay_H